@@ -1,169 +1,75 @@
-// Build script to compile native C code with cross-platform support
+// Build script to compile native C code with cross-platform support.
+// When the static library builds and archives successfully the crate is
+// compiled with `cfg(native_disassembler)`, which switches the FFI bindings
+// in src/native_disassembler.rs on; otherwise the Rust fallbacks are used.
 use std::env;
-use std::path::PathBuf;
+use std::process::Command;
 
 fn main() {
     let out_dir = env::var("OUT_DIR").unwrap();
-    let _out_path = PathBuf::from(&out_dir);
-    
-    // Compile native module based on target platform
-    #[cfg(target_os = "windows")]
-    compile_c_for_windows(&out_dir);
-    
-    #[cfg(target_os = "linux")]
-    compile_c_for_linux(&out_dir);
-    
-    #[cfg(target_os = "macos")]
-    compile_c_for_macos(&out_dir);
-    
+
+    println!("cargo:rustc-check-cfg=cfg(native_disassembler)");
     println!("cargo:rerun-if-changed=native/disassembler.c");
+
+    // Compile native module based on the target (not host) platform
+    let built = match env::var("CARGO_CFG_TARGET_OS").as_deref() {
+        Ok("windows") => compile_c_for_windows(&out_dir),
+        Ok("linux") => compile_c_for_linux(&out_dir),
+        Ok("macos") => compile_c_for_macos(&out_dir),
+        // On unsupported platforms, skip C compilation
+        _ => false,
+    };
+
+    if built {
+        println!("cargo:rustc-cfg=native_disassembler");
+    }
+}
+
+/// Run a tool; true only if it started and exited successfully
+fn run(program: &str, args: &[&str]) -> bool {
+    Command::new(program)
+        .args(args)
+        .status()
+        .map_or(false, |status| status.success())
+}
+
+/// Compile with a gcc-compatible compiler and archive as libdisassembler.a
+fn compile_with_cc(compiler: &str, out_dir: &str, extra_flags: &[&str]) -> bool {
+    let object = format!("{}/disassembler.o", out_dir);
+    let library = format!("{}/libdisassembler.a", out_dir);
+
+    let mut args = vec!["-c", "native/disassembler.c", "-o", object.as_str(), "-O2", "-Wall"];
+    args.extend_from_slice(extra_flags);
+    if !run(compiler, &args) || !run("ar", &["rcs", &library, &object]) {
+        return false;
+    }
+
+    println!("cargo:rustc-link-lib=static=disassembler");
+    println!("cargo:rustc-link-search=native={}", out_dir);
+    true
 }
 
-#[cfg(target_os = "windows")]
-fn compile_c_for_windows(out_dir: &str) {
-    use std::process::Command;
-    
+fn compile_c_for_windows(out_dir: &str) -> bool {
     // Try with MSVC first (cl.exe)
-    let msvc_result = Command::new("cl.exe")
-        .args(&[
-            "/c",
-            "native/disassembler.c",
-            &format!("/Fo{}/disassembler.obj", out_dir),
-            "/O2",
-            "/W3",
-        ])
-        .status();
-    
-    if msvc_result.is_ok() {
-        // Link with MSVC linker
-        let _ = Command::new("lib.exe")
-            .args(&[
-                &format!("{}/disassembler.obj", out_dir),
-                &format!("/OUT:{}/disassembler.lib", out_dir),
-            ])
-            .status();
-        
+    let object = format!("{}/disassembler.obj", out_dir);
+    if run("cl.exe", &["/c", "native/disassembler.c", &format!("/Fo{}", object), "/O2", "/W3"])
+        && run("lib.exe", &[&object, &format!("/OUT:{}/disassembler.lib", out_dir)])
+    {
         println!("cargo:rustc-link-lib=disassembler");
         println!("cargo:rustc-link-search=native={}", out_dir);
-        return;
+        return true;
     }
-    
+
     // Fall back to gcc/clang
-    let gcc_result = Command::new("gcc")
-        .args(&[
-            "-c",
-            "native/disassembler.c",
-            "-o",
-            &format!("{}/disassembler.o", out_dir),
-            "-O2",
-            "-Wall",
-        ])
-        .status();
-    
-    if gcc_result.is_ok() {
-        let _ = Command::new("ar")
-            .args(&[
-                "rcs",
-                &format!("{}/libdisassembler.a", out_dir),
-                &format!("{}/disassembler.o", out_dir),
-            ])
-            .status();
-        
-        println!("cargo:rustc-link-lib=static=disassembler");
-        println!("cargo:rustc-link-search=native={}", out_dir);
-    }
+    compile_with_cc("gcc", out_dir, &[])
 }
 
-#[cfg(target_os = "linux")]
-fn compile_c_for_linux(out_dir: &str) {
-    use std::process::Command;
-    
-    // Try with gcc first
-    let gcc_result = Command::new("gcc")
-        .args(&[
-            "-c",
-            "native/disassembler.c",
-            "-o",
-            &format!("{}/disassembler.o", out_dir),
-            "-O2",
-            "-Wall",
-            "-fPIC",
-        ])
-        .status();
-    
-    if gcc_result.is_ok() {
-        let _ = Command::new("ar")
-            .args(&[
-                "rcs",
-                &format!("{}/libdisassembler.a", out_dir),
-                &format!("{}/disassembler.o", out_dir),
-            ])
-            .status();
-        
-        println!("cargo:rustc-link-lib=static=disassembler");
-        println!("cargo:rustc-link-search=native={}", out_dir);
-        return;
-    }
-    
-    // Try with clang as fallback
-    let clang_result = Command::new("clang")
-        .args(&[
-            "-c",
-            "native/disassembler.c",
-            "-o",
-            &format!("{}/disassembler.o", out_dir),
-            "-O2",
-            "-Wall",
-            "-fPIC",
-        ])
-        .status();
-    
-    if clang_result.is_ok() {
-        let _ = Command::new("ar")
-            .args(&[
-                "rcs",
-                &format!("{}/libdisassembler.a", out_dir),
-                &format!("{}/disassembler.o", out_dir),
-            ])
-            .status();
-        
-        println!("cargo:rustc-link-lib=static=disassembler");
-        println!("cargo:rustc-link-search=native={}", out_dir);
-    }
+fn compile_c_for_linux(out_dir: &str) -> bool {
+    // Try with gcc first, clang as fallback
+    compile_with_cc("gcc", out_dir, &["-fPIC"]) || compile_with_cc("clang", out_dir, &["-fPIC"])
 }
 
-#[cfg(target_os = "macos")]
-fn compile_c_for_macos(out_dir: &str) {
-    use std::process::Command;
-    
+fn compile_c_for_macos(out_dir: &str) -> bool {
     // Try with clang (usually available on macOS)
-    let clang_result = Command::new("clang")
-        .args(&[
-            "-c",
-            "native/disassembler.c",
-            "-o",
-            &format!("{}/disassembler.o", out_dir),
-            "-O2",
-            "-Wall",
-            "-fPIC",
-        ])
-        .status();
-    
-    if clang_result.is_ok() {
-        let _ = Command::new("ar")
-            .args(&[
-                "rcs",
-                &format!("{}/libdisassembler.a", out_dir),
-                &format!("{}/disassembler.o", out_dir),
-            ])
-            .status();
-        
-        println!("cargo:rustc-link-lib=static=disassembler");
-        println!("cargo:rustc-link-search=native={}", out_dir);
-    }
+    compile_with_cc("clang", out_dir, &["-fPIC"])
 }
-
-#[cfg(not(any(target_os = "windows", target_os = "linux", target_os = "macos")))]
-fn compile_c_for_windows(_out_dir: &str) {
-    // On unsupported platforms, skip C compilation
-}
\ No newline at end of file
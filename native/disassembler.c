@@ -55,12 +55,14 @@ typedef struct {
 
 // RIP-relative reference tracking
 typedef struct {
-    uint64_t address;
-    int64_t offset;
+    uint64_t address;   // VA of the instruction
+    int64_t offset;     // signed disp32
+    uint64_t target;    // next-instruction VA + disp32
     bool is_data;
 } RIP_REF;
 
 // Result buffer for safe communication with Rust
+// Grows on demand; `truncated` is only set when an allocation fails.
 typedef struct {
     char* data;
     size_t capacity;
@@ -68,35 +70,55 @@ typedef struct {
     bool truncated;
 } RESULT_BUFFER;
 
-// Initialize result buffer
+// Initialize result buffer (`capacity` is only the starting size)
 EXPORT void* rip_buffer_init(size_t capacity) {
     RESULT_BUFFER* buf = (RESULT_BUFFER*)malloc(sizeof(RESULT_BUFFER));
     if (!buf) return NULL;
     
-    buf->capacity = capacity;
+    buf->capacity = capacity ? capacity : 1;
     buf->used = 0;
     buf->truncated = false;
-    buf->data = (char*)malloc(capacity);
+    buf->data = (char*)malloc(buf->capacity);
     
     if (!buf->data) {
         free(buf);
         return NULL;
     }
+    buf->data[0] = '\0';
     
     return (void*)buf;
 }
 
-// Write formatted string to result buffer with overflow protection
-EXPORT bool rip_buffer_write(void* handle, const char* text) {
-    RESULT_BUFFER* buf = (RESULT_BUFFER*)handle;
-    if (!buf || buf->truncated || !text) return false;
+// Make room for `extra` more bytes plus the terminator, doubling the
+// capacity as needed
+static bool rip_buffer_reserve(RESULT_BUFFER* buf, size_t extra) {
+    if (buf->truncated) return false;
     
-    size_t text_len = strlen(text);
+    size_t needed = buf->used + extra + 1;
+    if (needed <= buf->capacity) return true;
+    
+    size_t capacity = buf->capacity;
+    while (capacity < needed) {
+        capacity = capacity > SIZE_MAX / 2 ? needed : capacity * 2;
+    }
     
-    if (buf->used + text_len >= buf->capacity) {
+    char* data = (char*)realloc(buf->data, capacity);
+    if (!data) {
         buf->truncated = true;
         return false;
     }
+    buf->data = data;
+    buf->capacity = capacity;
+    return true;
+}
+
+// Write formatted string to result buffer, growing it as needed
+EXPORT bool rip_buffer_write(void* handle, const char* text) {
+    RESULT_BUFFER* buf = (RESULT_BUFFER*)handle;
+    if (!buf || !text) return false;
+    
+    size_t text_len = strlen(text);
+    if (!rip_buffer_reserve(buf, text_len)) return false;
     
     memcpy(buf->data + buf->used, text, text_len);
     buf->used += text_len;
@@ -105,12 +127,28 @@ EXPORT bool rip_buffer_write(void* handle, const char* text) {
     return true;
 }
 
+// Empty the buffer but keep its allocation, so one buffer can serve many calls
+EXPORT void rip_buffer_reset(void* handle) {
+    RESULT_BUFFER* buf = (RESULT_BUFFER*)handle;
+    if (buf) {
+        buf->used = 0;
+        buf->truncated = false;
+        buf->data[0] = '\0';
+    }
+}
+
 // Get buffer contents
 EXPORT const char* rip_buffer_get(void* handle) {
     RESULT_BUFFER* buf = (RESULT_BUFFER*)handle;
     return buf ? buf->data : NULL;
 }
 
+// Bytes written so far, excluding the terminator
+EXPORT size_t rip_buffer_length(void* handle) {
+    RESULT_BUFFER* buf = (RESULT_BUFFER*)handle;
+    return buf ? buf->used : 0;
+}
+
 // Free buffer
 EXPORT void rip_buffer_free(void* handle) {
     RESULT_BUFFER* buf = (RESULT_BUFFER*)handle;
@@ -146,7 +184,8 @@ EXPORT bool rip_parse_pe_header(const uint8_t* buffer, size_t size,
     
     // Validate COFF header
     if (pe_offset + 24 > size) return false;
-    COFF_HEADER* coff = (COFF_HEADER*)(buffer + pe_offset + 4);
+    // COFF_HEADER starts with the signature, so it begins at pe_offset
+    COFF_HEADER* coff = (COFF_HEADER*)(buffer + pe_offset);
     
     // Check machine type
     if (coff->machine != 0x8664 && coff->machine != 0x014C) return false; // AMD64 or I386
@@ -184,168 +223,655 @@ EXPORT bool rip_parse_pe_header(const uint8_t* buffer, size_t size,
     return true;
 }
 
-// Extract RIP-relative references from raw code
-// This is the critical function for proper memory access
-// Enhanced to detect ALL x86-64 RIP-relative addressing modes
-EXPORT size_t rip_extract_references(const uint8_t* code, size_t code_size,
-                                     uint64_t base_va,
-                                     RIP_REF* refs, size_t max_refs) {
-    if (!code || !refs || max_refs == 0) return 0;
+// ============================================================================
+// x86-64 INSTRUCTION LENGTH DECODER
+// ============================================================================
+// Table-driven: legacy/REX/VEX/EVEX/XOP prefixes, the one-byte, 0F, 0F38 and
+// 0F3A opcode maps, ModR/M + SIB + displacement and every immediate form.
+// It only measures instructions (no mnemonics), which is all RIP indexing
+// needs, so whole sections can be walked without Capstone.
+
+// Opcode table flags
+#define OP_MODRM  0x0001  // ModR/M (+ SIB/displacement) follows
+#define OP_IMM8   0x0002  // imm8 / rel8
+#define OP_IMMZ   0x0004  // imm16 with 0x66, imm32 otherwise
+#define OP_IMM16  0x0008  // imm16 (RET n, ENTER)
+#define OP_IMMV   0x0010  // imm16/32/64 by operand size (MOV r, imm)
+#define OP_MOFFS  0x0020  // 64-bit moffs, 32-bit with 0x67
+#define OP_REL32  0x0040  // rel32 regardless of 0x66 (near CALL/JMP/Jcc)
+#define OP_GROUP3 0x0080  // F6/F7: immediate only for /0 and /1 (TEST)
+#define OP_BAD    0x0100  // invalid in 64-bit mode
+
+#define M   OP_MODRM
+#define I8  OP_IMM8
+#define IZ  OP_IMMZ
+#define R32 OP_REL32
+#define BAD OP_BAD
+
+static const uint16_t OPCODES_1BYTE[256] = {
+    /*        0       1       2       3       4       5       6       7       8       9       A       B       C       D       E       F */
+    /* 0 */   M,      M,      M,      M,      I8,     IZ,     BAD,    BAD,    M,      M,      M,      M,      I8,     IZ,     BAD,    0,
+    /* 1 */   M,      M,      M,      M,      I8,     IZ,     BAD,    BAD,    M,      M,      M,      M,      I8,     IZ,     BAD,    BAD,
+    /* 2 */   M,      M,      M,      M,      I8,     IZ,     0,      BAD,    M,      M,      M,      M,      I8,     IZ,     0,      BAD,
+    /* 3 */   M,      M,      M,      M,      I8,     IZ,     0,      BAD,    M,      M,      M,      M,      I8,     IZ,     0,      BAD,
+    /* 4 */   0,      0,      0,      0,      0,      0,      0,      0,      0,      0,      0,      0,      0,      0,      0,      0,
+    /* 5 */   0,      0,      0,      0,      0,      0,      0,      0,      0,      0,      0,      0,      0,      0,      0,      0,
+    /* 6 */   BAD,    BAD,    0,      M,      0,      0,      0,      0,      IZ,     M|IZ,   I8,     M|I8,   0,      0,      0,      0,
+    /* 7 */   I8,     I8,     I8,     I8,     I8,     I8,     I8,     I8,     I8,     I8,     I8,     I8,     I8,     I8,     I8,     I8,
+    /* 8 */   M|I8,   M|IZ,   BAD,    M|I8,   M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,
+    /* 9 */   0,      0,      0,      0,      0,      0,      0,      0,      0,      0,      BAD,    0,      0,      0,      0,      0,
+    /* A */   OP_MOFFS, OP_MOFFS, OP_MOFFS, OP_MOFFS, 0,  0,      0,      0,      I8,     IZ,     0,      0,      0,      0,      0,      0,
+    /* B */   I8,     I8,     I8,     I8,     I8,     I8,     I8,     I8,     OP_IMMV, OP_IMMV, OP_IMMV, OP_IMMV, OP_IMMV, OP_IMMV, OP_IMMV, OP_IMMV,
+    /* C */   M|I8,   M|I8,   OP_IMM16, 0,    0,      0,      M|I8,   M|IZ,   OP_IMM16|I8, 0, OP_IMM16, 0,    0,      I8,     BAD,    0,
+    /* D */   M,      M,      M,      M,      BAD,    BAD,    BAD,    0,      M,      M,      M,      M,      M,      M,      M,      M,
+    /* E */   I8,     I8,     I8,     I8,     I8,     I8,     I8,     I8,     R32,    R32,    BAD,    I8,     0,      0,      0,      0,
+    /* F */   0,      0,      0,      0,      0,      0,      M|OP_GROUP3, M|OP_GROUP3, 0, 0, 0,      0,      0,      0,      M,      M,
+};
+
+static const uint16_t OPCODES_0F[256] = {
+    /*        0       1       2       3       4       5       6       7       8       9       A       B       C       D       E       F */
+    /* 0 */   M,      M,      M,      M,      BAD,    0,      0,      0,      0,      0,      BAD,    0,      BAD,    M,      0,      M|I8,
+    /* 1 */   M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,
+    /* 2 */   M,      M,      M,      M,      BAD,    BAD,    BAD,    BAD,    M,      M,      M,      M,      M,      M,      M,      M,
+    /* 3 */   0,      0,      0,      0,      0,      0,      BAD,    0,      BAD,    BAD,    BAD,    BAD,    BAD,    BAD,    BAD,    BAD,
+    /* 4 */   M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,
+    /* 5 */   M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,
+    /* 6 */   M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,
+    /* 7 */   M|I8,   M|I8,   M|I8,   M|I8,   M,      M,      M,      0,      M,      M,      BAD,    BAD,    M,      M,      M,      M,
+    /* 8 */   R32,    R32,    R32,    R32,    R32,    R32,    R32,    R32,    R32,    R32,    R32,    R32,    R32,    R32,    R32,    R32,
+    /* 9 */   M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,
+    /* A */   0,      0,      0,      M,      M|I8,   M,      BAD,    BAD,    0,      0,      0,      M,      M|I8,   M,      M,      M,
+    /* B */   M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M|I8,   M,      M,      M,      M,      M,
+    /* C */   M,      M,      M|I8,   M,      M|I8,   M|I8,   M|I8,   M,      0,      0,      0,      0,      0,      0,      0,      0,
+    /* D */   M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,
+    /* E */   M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,
+    /* F */   M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,
+};
+
+#undef M
+#undef I8
+#undef IZ
+#undef R32
+#undef BAD
+
+// Opcode maps (VEX/EVEX `mmmmm`, XOP `mmmmm`)
+#define MAP_1BYTE 0
+#define MAP_0F    1
+#define MAP_0F38  2
+#define MAP_0F3A  3
+#define MAP_XOP8  8
+#define MAP_XOP9  9
+#define MAP_XOPA  10
+
+#define X86_MAX_LENGTH 15
+
+// Bitmap of legacy prefixes: 26 2E 36 3E 64 65 66 67 F0 F2 F3
+static const uint32_t LEGACY_PREFIX[8] = {
+    0x00000000, 0x40404040, 0x00000000, 0x000000F0,
+    0x00000000, 0x00000000, 0x00000000, 0x000D0000,
+};
+
+// What the sweep needs from one decoded instruction
+typedef struct {
+    uint8_t length;
+    uint8_t map;
+    uint8_t opcode;
+    uint8_t modrm_reg;
+    uint8_t disp_offset;  // offset of the RIP-relative disp32, 0 if none
+} X86_SHAPE;
+
+// Decode the instruction at `code`. Returns its length, or 0 when the bytes
+// are not a valid 64-bit instruction or run past `size`.
+static size_t x86_decode(const uint8_t* code, size_t size, X86_SHAPE* out) {
+    size_t limit = size < X86_MAX_LENGTH ? size : X86_MAX_LENGTH;
+    size_t pos = 0;
+    bool opsize16 = false, addr32 = false, rex_w = false;
     
-    size_t ref_count = 0;
+    // Legacy prefixes and REX. REX only counts right before the opcode, so a
+    // legacy prefix after it drops it again.
+    for (;;) {
+        if (pos >= limit) return 0;
+        uint8_t b = code[pos];
+        if ((b & 0xF0) == 0x40) {
+            rex_w = (b & 0x08) != 0;
+        } else if (LEGACY_PREFIX[b >> 5] & (1u << (b & 0x1F))) {
+            if (b == 0x66) opsize16 = true;
+            if (b == 0x67) addr32 = true;
+            rex_w = false;
+        } else {
+            break;
+        }
+        pos++;
+    }
+    
+    uint8_t map = MAP_1BYTE;
+    uint8_t opcode = code[pos++];
+    uint16_t flags;
     
-    // Enhanced pattern matching for ALL RIP-relative patterns
-    for (size_t i = 0; i < code_size - 2 && ref_count < max_refs; i++) {
-        uint8_t b1 = code[i];
-        uint8_t b2 = (i + 1 < code_size) ? code[i + 1] : 0;
-        uint8_t b3 = (i + 2 < code_size) ? code[i + 2] : 0;
+    if (opcode == 0xC4 || opcode == 0xC5 || opcode == 0x62 ||
+        (opcode == 0x8F && pos < limit && (code[pos] & 0x1F) >= MAP_XOP8)) {
+        // VEX (C4 3-byte, C5 2-byte), EVEX (62, 4-byte) or XOP (8F, 3-byte)
+        size_t payload = opcode == 0xC5 ? 1 : opcode == 0x62 ? 3 : 2;
+        if (pos + payload >= limit) return 0;
+        if (opcode == 0xC5) {
+            map = MAP_0F;
+        } else if (opcode == 0x62) {
+            map = code[pos] & 0x07;
+            rex_w = (code[pos + 1] & 0x80) != 0;
+        } else {
+            map = code[pos] & 0x1F;
+            rex_w = (code[pos + 1] & 0x80) != 0;
+        }
+        pos += payload;
+        opcode = code[pos++];
         
-        // Special cases first: CALL/JMP [rip + offset] (FF /2 or FF /4)
-        // These need exact ModR/M match: 0x15 = CALL, 0x25 = JMP
-        if (b1 == 0xFF && (b2 == 0x15 || b2 == 0x25)) {
-            if (i + 6 <= code_size) {
-                int32_t disp = *(int32_t*)(code + i + 2);
-                refs[ref_count].address = base_va + i;
-                refs[ref_count].offset = disp;
-                refs[ref_count].is_data = false;
-                ref_count++;
-                i += 5; // Skip processed instruction
-                continue;
+        switch (map) {
+            case MAP_0F:   flags = (OPCODES_0F[opcode] & OP_IMM8) | OP_MODRM; break;
+            case MAP_0F38: flags = OP_MODRM; break;
+            case MAP_0F3A: flags = OP_MODRM | OP_IMM8; break;
+            case 5: case 6: flags = OP_MODRM; break; // EVEX FP16 maps
+            case MAP_XOP8: flags = OP_MODRM | OP_IMM8; break;
+            case MAP_XOP9: flags = OP_MODRM; break;
+            case MAP_XOPA: flags = OP_MODRM | OP_IMMZ; opsize16 = false; break;
+            default: return 0;
+        }
+        // VZEROUPPER / VZEROALL have no ModR/M
+        if (map == MAP_0F && opcode == 0x77) flags = 0;
+    } else if (opcode == 0x0F) {
+        if (pos >= limit) return 0;
+        opcode = code[pos++];
+        if (opcode == 0x38 || opcode == 0x3A) {
+            if (pos >= limit) return 0;
+            map = opcode == 0x38 ? MAP_0F38 : MAP_0F3A;
+            opcode = code[pos++];
+            flags = map == MAP_0F38 ? OP_MODRM : OP_MODRM | OP_IMM8;
+        } else {
+            map = MAP_0F;
+            flags = OPCODES_0F[opcode];
+        }
+    } else {
+        flags = OPCODES_1BYTE[opcode];
+    }
+    
+    if (flags & OP_BAD) return 0;
+    
+    uint8_t modrm_reg = 0;
+    size_t disp_offset = 0;
+    if (flags & OP_MODRM) {
+        if (pos >= limit) return 0;
+        uint8_t modrm = code[pos++];
+        uint8_t mod = modrm >> 6;
+        uint8_t rm = modrm & 0x07;
+        modrm_reg = (modrm >> 3) & 0x07;
+        
+        if (mod != 3) {
+            size_t disp_size = mod == 1 ? 1 : mod == 2 ? 4 : 0;
+            if (rm == 4) {
+                if (pos >= limit) return 0;
+                uint8_t sib = code[pos++];
+                if (mod == 0 && (sib & 0x07) == 5) disp_size = 4;
+            } else if (mod == 0 && rm == 5) {
+                // RIP-relative (EIP-relative with 0x67): disp32 from next IP
+                disp_offset = pos;
+                disp_size = 4;
             }
+            pos += disp_size;
         }
         
-        // REX.W prefix (48-4F)
-        bool has_rex_w = (b1 >= 0x48 && b1 <= 0x4F);
-        size_t offset_base = has_rex_w ? i + 1 : i;
-        uint8_t opcode = has_rex_w ? b2 : b1;
-        uint8_t modrm = has_rex_w ? b3 : b2;
+        if ((flags & OP_GROUP3) && modrm_reg < 2) {
+            flags |= opcode == 0xF6 ? OP_IMM8 : OP_IMMZ;
+        }
+    }
+    
+    if (flags & OP_IMM8) pos += 1;
+    if (flags & OP_IMM16) pos += 2;
+    if (flags & OP_IMMZ) pos += opsize16 ? 2 : 4;
+    if (flags & OP_REL32) pos += 4;
+    if (flags & OP_IMMV) pos += rex_w ? 8 : opsize16 ? 2 : 4;
+    if (flags & OP_MOFFS) pos += addr32 ? 4 : 8;
+    
+    if (pos > limit) return 0;
+    
+    if (out) {
+        out->length = (uint8_t)pos;
+        out->map = map;
+        out->opcode = opcode;
+        out->modrm_reg = modrm_reg;
+        out->disp_offset = (uint8_t)disp_offset;
+    }
+    return pos;
+}
+
+// Length of the instruction at `code`, 0 if it is not valid x86-64
+EXPORT size_t rip_instruction_length(const uint8_t* code, size_t size) {
+    if (!code) return 0;
+    return x86_decode(code, size, NULL);
+}
+
+// Sweep instructions starting at `i` until one starts at or after `end`,
+// recording every RIP-relative operand. Bytes that do not decode (data,
+// padding) are skipped one at a time to resynchronise. Returns where the
+// sweep stopped.
+static size_t rip_sweep(const uint8_t* code, size_t code_size, uint64_t base_va,
+                        size_t i, size_t end,
+                        RIP_REF* refs, size_t max_refs, size_t* ref_count) {
+    while (i < end && i < code_size && *ref_count < max_refs) {
+        X86_SHAPE shape;
+        size_t length = x86_decode(code + i, code_size - i, &shape);
+        if (length == 0) {
+            i++;
+            continue;
+        }
         
-        // Check for RIP-relative addressing (ModR/M byte = 00 xxx 101)
-        // This is the ModR/M pattern for RIP-relative in 64-bit
-        if ((modrm & 0xC7) == 0x05) {
-            size_t inst_size = 0;
-            bool is_rip_relative = false;
-            bool is_data_access = false;
+        if (shape.disp_offset) {
+            int32_t disp;
+            memcpy(&disp, code + i + shape.disp_offset, sizeof(disp));
             
-            // MOV instructions (8B, 89, 88, 8A, A0-A3, C6, C7)
-            if (opcode == 0x8B || opcode == 0x8A) { // MOV reg, [mem]
-                inst_size = has_rex_w ? 7 : 6;
-                is_rip_relative = true;
-                is_data_access = true;
-            }
-            else if (opcode == 0x89 || opcode == 0x88) { // MOV [mem], reg
-                inst_size = has_rex_w ? 7 : 6;
-                is_rip_relative = true;
-                is_data_access = true;
-            }
-            // LEA instruction (8D)
-            else if (opcode == 0x8D) {
-                inst_size = has_rex_w ? 7 : 6;
-                is_rip_relative = true;
-                is_data_access = false;
-            }
-            // CMP instructions (3A, 3B, 80-83)
-            else if (opcode == 0x3B || opcode == 0x3A) {
-                inst_size = has_rex_w ? 7 : 6;
-                is_rip_relative = true;
-                is_data_access = true;
-            }
-            // TEST instruction (85)
-            else if (opcode == 0x85 || opcode == 0x84) {
-                inst_size = has_rex_w ? 7 : 6;
-                is_rip_relative = true;
-                is_data_access = true;
-            }
-            // ADD/SUB/AND/OR/XOR (00-05, 08-0D, 20-25, 28-2D, 30-35)
-            else if ((opcode >= 0x00 && opcode <= 0x05) ||
-                     (opcode >= 0x08 && opcode <= 0x0D) ||
-                     (opcode >= 0x20 && opcode <= 0x25) ||
-                     (opcode >= 0x28 && opcode <= 0x2D) ||
-                     (opcode >= 0x30 && opcode <= 0x35)) {
-                inst_size = has_rex_w ? 7 : 6;
-                is_rip_relative = true;
-                is_data_access = true;
-            }
+            // LEA and indirect CALL/JMP use the address, everything else
+            // reads or writes the data it points at
+            bool address_only = shape.map == MAP_1BYTE &&
+                (shape.opcode == 0x8D || (shape.opcode == 0xFF && shape.modrm_reg >= 2 && shape.modrm_reg <= 5));
             
-            if (is_rip_relative && offset_base + inst_size <= code_size) {
-                int32_t disp = *(int32_t*)(code + offset_base + 2);
-                refs[ref_count].address = base_va + i;
-                refs[ref_count].offset = disp;
-                refs[ref_count].is_data = is_data_access;
-                ref_count++;
-                i += inst_size - 1; // Skip processed instruction
-                continue;
-            }
+            RIP_REF* ref = &refs[(*ref_count)++];
+            ref->address = base_va + i;
+            ref->offset = disp;
+            ref->target = base_va + i + length + (int64_t)disp;
+            ref->is_data = !address_only;
         }
+        i += length;
     }
+    return i;
+}
+
+// Extract RIP-relative references from raw code, a chunk at a time
+// Walks real instruction boundaries with the length decoder, starting at
+// *cursor. Stops early once `refs` is full and leaves *cursor where the next
+// call continues; *cursor == code_size means the code is done.
+EXPORT size_t rip_extract_references_chunk(const uint8_t* code, size_t code_size,
+                                           uint64_t base_va, size_t* cursor,
+                                           RIP_REF* refs, size_t max_refs) {
+    if (!code || !cursor || !refs || max_refs == 0) return 0;
     
+    size_t ref_count = 0;
+    *cursor = rip_sweep(code, code_size, base_va, *cursor, code_size, refs, max_refs, &ref_count);
     return ref_count;
 }
 
-// Fix RIP-relative addresses to use proper labels
-EXPORT bool rip_fix_references(const char* asm_code,
-                              const RIP_REF* refs, size_t ref_count,
-                              void* output_buffer) {
-    // This function will process the assembly code and replace
-    // RIP-relative references with proper labels
-    
-    RESULT_BUFFER* buf = (RESULT_BUFFER*)output_buffer;
-    if (!buf || !asm_code) return false;
+// Extract RIP-relative references from raw code (at most `max_refs`)
+EXPORT size_t rip_extract_references(const uint8_t* code, size_t code_size,
+                                     uint64_t base_va,
+                                     RIP_REF* refs, size_t max_refs) {
+    size_t cursor = 0;
+    return rip_extract_references_chunk(code, code_size, base_va, &cursor, refs, max_refs);
+}
+
+// ============================================================================
+// RIP CANDIDATE PREFILTER
+// ============================================================================
+// Every RIP-relative operand has a ModR/M byte with mod=00, rm=101, i.e.
+// (b & 0xC7) == 0x05 - which also covers FF 15 (call [rip]) and FF 25
+// (jmp [rip]). Most of .text has no such byte for long stretches, so the
+// scan finds candidates 32 bytes at a time with SSE2/AVX2 and only runs the
+// decoder near them.
+// ============================================================================
+
+#define RIP_SCAN_BLOCK 32
+
+// Decoding restarts this far ahead of a candidate after a skip; a few
+// instructions are enough for a misaligned sweep to fall back into step.
+#define RIP_RESYNC_WINDOW 48
+
+// Bit n set when code[n] could be a RIP-relative ModR/M byte
+typedef uint32_t (*RIP_MASK_FN)(const uint8_t* code);
+
+static uint32_t rip_mask_scalar(const uint8_t* code) {
+    uint32_t mask = 0;
+    for (int n = 0; n < RIP_SCAN_BLOCK; n++) {
+        if ((code[n] & 0xC7) == 0x05) mask |= 1u << n;
+    }
+    return mask;
+}
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define RIP_TARGET_AVX2
+#else
+#define RIP_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+// SSE2 is part of x86-64, so this path needs no check
+static uint32_t rip_mask_sse2(const uint8_t* code) {
+    const __m128i mask = _mm_set1_epi8((char)0xC7);
+    const __m128i match = _mm_set1_epi8(0x05);
+    __m128i lo = _mm_loadu_si128((const __m128i*)code);
+    __m128i hi = _mm_loadu_si128((const __m128i*)(code + 16));
+    uint32_t lo_bits = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, mask), match));
+    uint32_t hi_bits = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(hi, mask), match));
+    return lo_bits | (hi_bits << 16);
+}
+
+RIP_TARGET_AVX2
+static uint32_t rip_mask_avx2(const uint8_t* code) {
+    __m256i bytes = _mm256_loadu_si256((const __m256i*)code);
+    __m256i masked = _mm256_and_si256(bytes, _mm256_set1_epi8((char)0xC7));
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(masked, _mm256_set1_epi8(0x05)));
+}
+
+static bool rip_cpu_has_avx2(void) {
+#ifdef _MSC_VER
+    // AVX2 itself, plus OSXSAVE and OS-enabled YMM state
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static RIP_MASK_FN rip_select_mask(void) {
+    return rip_cpu_has_avx2() ? rip_mask_avx2 : rip_mask_sse2;
+}
+#else
+static RIP_MASK_FN rip_select_mask(void) {
+    return rip_mask_scalar;
+}
+#endif
+
+static unsigned rip_lowest_bit(uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+// First candidate at or after `from`, `code_size` if there is none
+static size_t rip_next_candidate(const uint8_t* code, size_t code_size, size_t from,
+                                 RIP_MASK_FN mask_of) {
+    while (from < code_size) {
+        size_t block = from - from % RIP_SCAN_BLOCK;
+        uint32_t mask;
+        if (code_size - block >= RIP_SCAN_BLOCK) {
+            mask = mask_of(code + block);
+        } else {
+            // Short tail: pad a copy so the vector loads stay in bounds
+            uint8_t tail[RIP_SCAN_BLOCK] = {0};
+            memcpy(tail, code + block, code_size - block);
+            mask = rip_mask_scalar(tail);
+        }
+        mask &= ~0u << (from - block);
+        if (mask) return block + rip_lowest_bit(mask);
+        from = block + RIP_SCAN_BLOCK;
+    }
+    return code_size;
+}
+
+// Which candidate scan rip_scan_references uses on this CPU
+EXPORT const char* rip_scan_path(void) {
+    RIP_MASK_FN mask_of = rip_select_mask();
+#if defined(__x86_64__) || defined(_M_X64)
+    if (mask_of == rip_mask_avx2) return "avx2";
+    if (mask_of == rip_mask_sse2) return "sse2";
+#endif
+    return "scalar";
+}
+
+// Extract RIP-relative references, decoding only near candidates
+// Same output as rip_extract_references wherever the sweep is aligned; after
+// a skip it restarts RIP_RESYNC_WINDOW bytes ahead of the next candidate.
+// Resumable through *cursor exactly like rip_extract_references_chunk.
+EXPORT size_t rip_scan_references_chunk(const uint8_t* code, size_t code_size,
+                                        uint64_t base_va, size_t* cursor,
+                                        RIP_REF* refs, size_t max_refs) {
+    if (!code || !cursor || !refs || max_refs == 0) return 0;
     
-    size_t code_len = strlen(asm_code);
-    size_t read_pos = 0;
+    RIP_MASK_FN mask_of = rip_select_mask();
+    size_t ref_count = 0;
+    size_t i = *cursor;
     
-    while (read_pos < code_len && !buf->truncated) {
-        // Find [rip pattern
-        const char* rip_pattern = strstr(asm_code + read_pos, "[rip");
-        
-        if (!rip_pattern) {
-            // No more RIP references, copy rest of string
-            const char* remaining = asm_code + read_pos;
-            if (buf->used + strlen(remaining) >= buf->capacity) {
-                buf->truncated = true;
-                return false;
-            }
-            strcpy(buf->data + buf->used, remaining);
-            buf->used += strlen(remaining);
+    while (i < code_size && ref_count < max_refs) {
+        // The ModR/M byte always follows the opcode
+        size_t candidate = rip_next_candidate(code, code_size, i + 1, mask_of);
+        if (candidate >= code_size) {
+            i = code_size;
             break;
         }
         
-        // Copy up to the RIP pattern
-        size_t copy_len = rip_pattern - (asm_code + read_pos);
-        if (buf->used + copy_len + 10 >= buf->capacity) {
-            buf->truncated = true;
-            return false;
+        if (candidate - i > RIP_RESYNC_WINDOW) {
+            i = candidate - RIP_RESYNC_WINDOW;
+        }
+        // Decode up to and including the instruction covering the candidate
+        i = rip_sweep(code, code_size, base_va, i, candidate, refs, max_refs, &ref_count);
+    }
+    
+    *cursor = i;
+    return ref_count;
+}
+
+// Candidate-prefiltered extraction in one call (at most `max_refs`)
+EXPORT size_t rip_scan_references(const uint8_t* code, size_t code_size,
+                                  uint64_t base_va,
+                                  RIP_REF* refs, size_t max_refs) {
+    size_t cursor = 0;
+    return rip_scan_references_chunk(code, code_size, base_va, &cursor, refs, max_refs);
+}
+
+// ============================================================================
+// RIP REFERENCE RELABELLING
+// ============================================================================
+// One forward pass over a listing: lines are found with memchr, operands
+// with memchr for '[', and every "[rip +/- 0x..]" becomes "[data_0x<target>]".
+// The target comes from the RIP_REF whose address matches the line's leading
+// address; lines without an address (or without a matching ref) fall back to
+// "[data_0x<|disp|>]" as before.
+// ============================================================================
+
+typedef struct {
+    char* data;
+    size_t capacity;
+    size_t used;
+} RIP_OUTPUT;
+
+static bool rip_out_put(RIP_OUTPUT* out, const char* text, size_t len) {
+    if (out->capacity - out->used < len) return false;
+    memcpy(out->data + out->used, text, len);
+    out->used += len;
+    return true;
+}
+
+static bool rip_out_label(RIP_OUTPUT* out, uint64_t value) {
+    static const char HEX[] = "0123456789abcdef";
+    char label[32] = "[data_0x";
+    size_t len = 8;
+    int shift = 60;
+    while (shift > 0 && ((value >> shift) & 0xF) == 0) shift -= 4;
+    for (; shift >= 0; shift -= 4) label[len++] = HEX[(value >> shift) & 0xF];
+    label[len++] = ']';
+    return rip_out_put(out, label, len);
+}
+
+static int rip_hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static const char* rip_skip_blanks(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    return p;
+}
+
+// Leading address of a listing line: "0x1400010a0...", "1400010a0:" or the
+// relocator's "00001234  ". Bare hex needs a colon or 8+ digits so that
+// mnemonics like "add" are not taken for addresses.
+static bool rip_line_address(const char* line, const char* end, uint64_t* address) {
+    const char* p = rip_skip_blanks(line, end);
+    bool prefixed = end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X');
+    if (prefixed) p += 2;
+    
+    uint64_t value = 0;
+    size_t digits = 0;
+    int digit;
+    while (p < end && digits < 16 && (digit = rip_hex_digit(*p)) >= 0) {
+        value = (value << 4) | (uint64_t)digit;
+        digits++;
+        p++;
+    }
+    if (digits == 0 || p >= end) return false;
+    if (*p != ':' && !(*p == ' ' || *p == '\t')) return false;
+    if (!prefixed && *p != ':' && digits < 8) return false;
+    
+    *address = value;
+    return true;
+}
+
+// Parse "[rip +/- 0x..]" at `p`; on success sets the displacement and the
+// position just past the closing bracket
+static bool rip_parse_operand(const char* p, const char* end, int64_t* disp, const char** after) {
+    if (end - p < 5 || memcmp(p, "[rip", 4) != 0) return false;
+    p = rip_skip_blanks(p + 4, end);
+    if (p >= end || (*p != '+' && *p != '-')) return false;
+    bool negative = *p == '-';
+    p = rip_skip_blanks(p + 1, end);
+    if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) p += 2;
+    
+    // disp32: at most 8 digits
+    uint32_t value = 0;
+    size_t digits = 0;
+    int digit;
+    while (p < end && digits < 8 && (digit = rip_hex_digit(*p)) >= 0) {
+        value = (value << 4) | (uint32_t)digit;
+        digits++;
+        p++;
+    }
+    p = rip_skip_blanks(p, end);
+    if (digits == 0 || p >= end || *p != ']') return false;
+    
+    *disp = negative ? -(int64_t)value : (int64_t)value;
+    *after = p + 1;
+    return true;
+}
+
+// Reference at `address` in `refs` (sorted by address), NULL if none
+static const RIP_REF* rip_find_ref(const RIP_REF* refs, size_t ref_count, uint64_t address) {
+    size_t lo = 0, hi = ref_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (refs[mid].address < address) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo < ref_count && refs[lo].address == address ? &refs[lo] : NULL;
+}
+
+static bool rip_relabel_line(const char* line, const char* end,
+                             const RIP_REF* refs, size_t ref_count, RIP_OUTPUT* out) {
+    const char* copied = line;
+    const char* p = line;
+    const RIP_REF* ref = NULL;
+    bool looked_up = false;
+    
+    while ((p = memchr(p, '[', end - p)) != NULL) {
+        int64_t disp;
+        const char* after;
+        if (!rip_parse_operand(p, end, &disp, &after)) {
+            p++;
+            continue;
         }
         
-        memcpy(buf->data + buf->used, asm_code + read_pos, copy_len);
-        buf->used += copy_len;
-        
-        // Parse the offset value
-        int32_t offset = 0;
-        const char* offset_start = strchr(rip_pattern, '+');
-        if (!offset_start) offset_start = strchr(rip_pattern, '-');
-        
-        if (offset_start && sscanf(offset_start + 1, "%x", (unsigned int*)&offset) == 1) {
-            // Write label reference instead
-            buf->used += sprintf(buf->data + buf->used, "[data_0x%lx]", offset & 0xFFFFFFFF);
-        } else {
-            // Keep original if we can't parse
-            strcpy(buf->data + buf->used, rip_pattern);
-            buf->used += strlen(rip_pattern);
+        if (!looked_up) {
+            uint64_t address;
+            if (refs && rip_line_address(line, end, &address)) {
+                ref = rip_find_ref(refs, ref_count, address);
+            }
+            looked_up = true;
         }
+        uint64_t label = ref && ref->offset == disp
+            ? ref->target
+            : (uint64_t)(disp < 0 ? -disp : disp);
         
-        // Skip past the original [rip ...] part
-        const char* end_bracket = strchr(rip_pattern, ']');
-        if (end_bracket) {
-            read_pos = (end_bracket + 1) - asm_code;
-        } else {
+        if (!rip_out_put(out, copied, p - copied) || !rip_out_label(out, label)) return false;
+        copied = p = after;
+    }
+    return rip_out_put(out, copied, end - copied);
+}
+
+// Relabel RIP-relative operands in `text` (no terminator needed) into the
+// caller's `out` buffer, which is not terminated either. Only whole lines
+// are written: when `out` fills up the call stops at a line boundary and
+// *consumed says where to continue. A trailing line without '\n' counts as
+// whole, so a listing can be fed in chunks that end on line boundaries.
+// Returns the number of bytes written.
+EXPORT size_t rip_relabel_references(const char* text, size_t text_len,
+                                     const RIP_REF* refs, size_t ref_count,
+                                     char* out, size_t out_capacity,
+                                     size_t* consumed) {
+    if (!consumed) return 0;
+    *consumed = 0;
+    if (!text || !out) return 0;
+    
+    RIP_OUTPUT output = { out, out_capacity, 0 };
+    size_t pos = 0;
+    
+    while (pos < text_len) {
+        const char* line = text + pos;
+        const char* newline = memchr(line, '\n', text_len - pos);
+        const char* end = newline ? newline + 1 : text + text_len;
+        
+        size_t mark = output.used;
+        if (!rip_relabel_line(line, end, refs, ref_count, &output)) {
+            output.used = mark;
             break;
         }
+        pos = end - text;
+    }
+    
+    *consumed = pos;
+    return output.used;
+}
+
+// rip_relabel_references into a growing result buffer
+EXPORT bool rip_fix_references_len(const char* asm_code, size_t code_len,
+                                   const RIP_REF* refs, size_t ref_count,
+                                   void* output_buffer) {
+    RESULT_BUFFER* buf = (RESULT_BUFFER*)output_buffer;
+    if (!buf || (!asm_code && code_len)) return false;
+    
+    // Labels are barely longer than the operands they replace
+    size_t extra = code_len + code_len / 8 + 64;
+    size_t pos = 0;
+    
+    while (pos < code_len) {
+        if (!rip_buffer_reserve(buf, extra)) return false;
+        
+        size_t consumed;
+        buf->used += rip_relabel_references(asm_code + pos, code_len - pos, refs, ref_count,
+                                            buf->data + buf->used, buf->capacity - buf->used - 1,
+                                            &consumed);
+        pos += consumed;
+        
+        // Nothing fitted: the next line alone needs more room than is left
+        extra = consumed ? code_len - pos + 64 : buf->capacity - buf->used;
     }
     
     buf->data[buf->used] = '\0';
-    return !buf->truncated;
+    return true;
+}
+
+// Fix RIP-relative addresses to use proper labels (NUL-terminated listing)
+EXPORT bool rip_fix_references(const char* asm_code,
+                              const RIP_REF* refs, size_t ref_count,
+                              void* output_buffer) {
+    if (!asm_code) return false;
+    return rip_fix_references_len(asm_code, strlen(asm_code), refs, ref_count, output_buffer);
 }
 
 // Validate section integrity before disassembly with enhanced heuristics
@@ -403,5 +929,5 @@ EXPORT bool rip_validate_section(const uint8_t* code, size_t size) {
 
 // Export version for compatibility checking
 EXPORT const char* rip_get_version(void) {
-    return "2.0.0-enhanced";
+    return "2.3.0";
 }
\ No newline at end of file
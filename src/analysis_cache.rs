@@ -0,0 +1,186 @@
+// ============================================================================
+// PERSISTENT ANALYSIS CACHE
+// ============================================================================
+// Per-function results (blocks, variables and the rendered pseudo/C/Rust
+// text) are written to disk so re-opening a binary skips re-analysing it.
+// A key covers the function's RVA and bytes plus the few facts from the rest
+// of the image its output depends on, which the caller passes in as context,
+// so a rebuild that patches one function misses only that function's entry.
+// One JSON file per function, sharded by the first key byte like a git
+// object store. On by default in the per-user cache directory
+// (`configured`).
+// ============================================================================
+
+use serde::{Deserialize, Serialize};
+use sha2::{Digest, Sha256};
+use std::env;
+use std::fs;
+use std::path::PathBuf;
+
+/// Layout of the entries on disk; mixed into every key
+const SCHEMA: &str = "cataclysm-analysis/1";
+
+/// Version of what the analysis produces, mixed into every key. It MUST be
+/// bumped by any change that alters cached output - the passes, function
+/// recovery, variable recovery or the pseudo/C/Rust renderers - otherwise
+/// the cache keeps serving text from before the change.
+pub const ANALYSIS_VERSION: u32 = 3;
+
+/// SHA-256 of (`SCHEMA`, `ANALYSIS_VERSION`, RVA, function bytes, context)
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct FunctionKey([u8; 32]);
+
+impl FunctionKey {
+    /// `context` is whatever the function's output depends on beyond its own
+    /// bytes, serialised by the caller
+    pub fn of(rva: u64, bytes: &[u8], context: &[u8]) -> Self {
+        let mut hasher = Sha256::new();
+        hasher.update(SCHEMA.as_bytes());
+        hasher.update(ANALYSIS_VERSION.to_le_bytes());
+        hasher.update(rva.to_le_bytes());
+        hasher.update((bytes.len() as u64).to_le_bytes());
+        hasher.update(bytes);
+        hasher.update(context);
+        FunctionKey(hasher.finalize().into())
+    }
+
+    pub fn to_hex(&self) -> String {
+        self.0.iter().map(|byte| format!("{:02x}", byte)).collect()
+    }
+}
+
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct CachedBlock {
+    pub start_addr: u64,
+    pub instruction_count: usize,
+}
+
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct CachedVariable {
+    pub name: String,
+    pub var_type: String,
+    pub is_param: bool,
+    pub size: usize,
+}
+
+/// Everything the session needs from a function without re-analysing it
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct CachedFunction {
+    pub name: String,
+    pub start_addr: u64,
+    pub end_addr: u64,
+    pub blocks: Vec<CachedBlock>,
+    pub variables: Vec<CachedVariable>,
+    /// Line for the C forward declarations, `None` for imported functions
+    pub c_declaration: Option<String>,
+    /// Rendered text per backend, stored as each backend is first asked for
+    #[serde(default)]
+    pub pseudo: Option<String>,
+    #[serde(default)]
+    pub c: Option<String>,
+    #[serde(default)]
+    pub rust: Option<String>,
+}
+
+pub struct AnalysisCache {
+    dir: PathBuf,
+}
+
+impl AnalysisCache {
+    /// Cache rooted at `dir` (for example a project folder), created if needed
+    pub fn open(dir: impl Into<PathBuf>) -> Result<Self, String> {
+        let dir = dir.into();
+        fs::create_dir_all(&dir)
+            .map_err(|e| format!("Failed to create cache directory {}: {}", dir.display(), e))?;
+        Ok(AnalysisCache { dir })
+    }
+
+    /// The cache the decompiler uses: `user_default()`, unless
+    /// `CATACLYSM_ANALYSIS_CACHE` names another directory, or is empty or `0`
+    /// to turn caching off.
+    pub fn configured() -> Option<Self> {
+        let Some(value) = env::var_os("CATACLYSM_ANALYSIS_CACHE") else {
+            return Self::user_default();
+        };
+        match value.to_str() {
+            Some("") | Some("0") => None,
+            _ => Self::open(PathBuf::from(value)).ok(),
+        }
+    }
+
+    /// The per-user cache: `$XDG_CACHE_HOME/cataclysm/analysis`, falling back
+    /// to `~/.cache` (or `%LOCALAPPDATA%` on Windows). `None` when there is no
+    /// usable location; the decompiler then simply runs uncached.
+    pub fn user_default() -> Option<Self> {
+        let base = env::var_os("XDG_CACHE_HOME")
+            .map(PathBuf::from)
+            .or_else(|| env::var_os("HOME").map(|home| PathBuf::from(home).join(".cache")))
+            .or_else(|| env::var_os("LOCALAPPDATA").map(PathBuf::from))?;
+        Self::open(base.join("cataclysm").join("analysis")).ok()
+    }
+
+    fn entry_path(&self, key: &FunctionKey) -> PathBuf {
+        let hex = key.to_hex();
+        self.dir.join(&hex[..2]).join(format!("{}.json", &hex[2..]))
+    }
+
+    /// The stored entry for `key`. Missing, unreadable or corrupt entries are
+    /// all just misses.
+    pub fn load(&self, key: &FunctionKey) -> Option<CachedFunction> {
+        let json = fs::read_to_string(self.entry_path(key)).ok()?;
+        serde_json::from_str(&json).ok()
+    }
+
+    /// Write an entry through a temporary file and a rename, so a concurrent
+    /// reader never sees a half-written entry.
+    pub fn store(&self, key: &FunctionKey, entry: &CachedFunction) -> Result<(), String> {
+        let path = self.entry_path(key);
+        if let Some(shard) = path.parent() {
+            fs::create_dir_all(shard)
+                .map_err(|e| format!("Failed to create cache directory {}: {}", shard.display(), e))?;
+        }
+        let json = serde_json::to_string(entry)
+            .map_err(|e| format!("Failed to serialize cache entry: {}", e))?;
+        let tmp = path.with_extension(format!("json.{}.tmp", std::process::id()));
+        fs::write(&tmp, json)
+            .map_err(|e| format!("Failed to write cache entry {}: {}", tmp.display(), e))?;
+        fs::rename(&tmp, &path)
+            .map_err(|e| format!("Failed to write cache entry {}: {}", path.display(), e))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_entries_round_trip_by_content() {
+        let dir = env::temp_dir().join(format!("cataclysm-cache-test-{}", std::process::id()));
+        let cache = AnalysisCache::open(&dir).unwrap();
+        let entry = CachedFunction {
+            name: "func_1000".to_string(),
+            start_addr: 0x1000,
+            end_addr: 0x1004,
+            blocks: vec![CachedBlock { start_addr: 0x1000, instruction_count: 3 }],
+            variables: vec![CachedVariable { name: "local_4".to_string(), var_type: "Int32".to_string(), is_param: false, size: 4 }],
+            c_declaration: Some("int func_1000();\n".to_string()),
+            pseudo: Some("func_1000() {}".to_string()),
+            c: None,
+            rust: None,
+        };
+
+        let bytes = [0x55, 0x48, 0x89, 0xe5, 0xc3];
+        let key = FunctionKey::of(0x1000, &bytes, b"func_1000");
+        assert_eq!(key, FunctionKey::of(0x1000, &bytes, b"func_1000"));
+        assert!(cache.load(&key).is_none());
+        cache.store(&key, &entry).unwrap();
+        assert_eq!(cache.load(&key), Some(entry));
+
+        // A patched function, the same bytes at another RVA, or with other
+        // context all miss
+        assert!(cache.load(&FunctionKey::of(0x1000, &[0x55, 0x48, 0x89, 0xe5, 0x90, 0xc3], b"func_1000")).is_none());
+        assert!(cache.load(&FunctionKey::of(0x2000, &bytes, b"func_1000")).is_none());
+        assert!(cache.load(&FunctionKey::of(0x1000, &bytes, b"func_1000\0")).is_none());
+        let _ = fs::remove_dir_all(&dir);
+    }
+}
@@ -20,16 +20,13 @@
 
 #![allow(dead_code)]
 
+use rayon::prelude::*;
 use std::collections::{HashMap, HashSet};
+use std::time::Instant;
 // use regex::Regex;
 
-#[derive(Debug, Clone)]
-pub struct Instruction {
-    pub address: u64,
-    pub mnemonic: String,
-    pub operands: String,
-    pub raw_line: String,
-}
+use crate::ir::{Condition, FlowClass, Mnemonic};
+pub use crate::ir::Instruction;
 
 #[derive(Debug, Clone, PartialEq)]
 pub enum ObfuscationType {
@@ -70,35 +67,70 @@ pub struct DeobfuscationResult {
     pub cleaned_count: usize,
     pub removed_instructions: usize,
     pub signatures: Vec<ObfuscationSignature>,
-    pub cleaned_instructions: Vec<Instruction>,
     pub success_rate: f32,
+    /// Phases skipped or cut short because the time budget ran out
+    pub over_budget: Vec<&'static str>,
 }
 
 // ============================================================================
 // MAIN DEOBFUSCATION ENGINE
 // ============================================================================
 
-pub fn deobfuscate_instructions(instructions: &[Instruction]) -> DeobfuscationResult {
-    let mut cleaned = instructions.to_vec();
-    let mut signatures = Vec::new();
-    let original_count = instructions.len();
-    
-    // Phase 1: Detect obfuscation techniques
-    signatures.extend(detect_control_flow_flattening(&cleaned));
-    signatures.extend(detect_opaque_predicates(&cleaned));
-    signatures.extend(detect_dead_code(&cleaned));
-    signatures.extend(detect_instruction_substitution(&cleaned));
-    signatures.extend(detect_virtualization(&cleaned));
-    signatures.extend(detect_string_encryption(&cleaned));
-    signatures.extend(detect_api_hashing(&cleaned));
-    signatures.extend(detect_junk_code(&cleaned));
+/// Detect obfuscation in `cleaned` and strip it in place. Removal compacts the
+/// vector without cloning; only rewritten instructions allocate. `roots` are
+/// addresses where code starts without any branch leading there (entry
+/// point, exports, `.pdata` function starts); dead-code detection treats them
+/// as jump targets. Work stops at `deadline`; whatever was skipped is listed
+/// in `over_budget`.
+pub fn deobfuscate_instructions(cleaned: &mut Vec<Instruction>, roots: &[u64], deadline: Instant) -> DeobfuscationResult {
+    let original_count = cleaned.len();
+    let mut over_budget = Vec::new();
+    
+    // Branch/call targets, collected once. Junk removal never drops a branch,
+    // so the set stays valid for the dead-code removal that follows it.
+    let targets = JumpTargets::collect(cleaned, roots);
+    
+    // Phase 1: Detect obfuscation techniques. The detectors are independent
+    // read-only scans, so they run side by side; results keep this order.
+    let detectors: [&(dyn Fn(&[Instruction]) -> Vec<ObfuscationSignature> + Sync); 8] = [
+        &detect_control_flow_flattening,
+        &detect_opaque_predicates,
+        &|instructions| detect_dead_code(instructions, &targets),
+        &detect_instruction_substitution,
+        &detect_virtualization,
+        &detect_string_encryption,
+        &detect_api_hashing,
+        &detect_junk_code,
+    ];
+    let signatures: Vec<ObfuscationSignature> = detectors
+        .par_iter()
+        .map(|detect| detect(cleaned))
+        .collect::<Vec<_>>()
+        .into_iter()
+        .flatten()
+        .collect();
+    if Instant::now() >= deadline {
+        over_budget.push("detection");
+    }
     
     // Phase 2: Remove obfuscation (in order of safety)
-    cleaned = remove_junk_code(&cleaned);
-    cleaned = remove_dead_code(&cleaned);
-    cleaned = remove_opaque_predicates(&cleaned);
-    cleaned = simplify_instruction_substitution(&cleaned);
-    cleaned = unfold_constants(&cleaned);
+    let removals: [(&'static str, &dyn Fn(&mut Vec<Instruction>)); 5] = [
+        ("junk code removal", &remove_junk_code),
+        ("dead code removal", &|instructions| remove_dead_code(instructions, &targets)),
+        ("opaque predicate removal", &remove_opaque_predicates),
+        ("substitution simplification", &simplify_instruction_substitution),
+        ("constant unfolding", &unfold_constants),
+    ];
+    for (name, remove) in removals {
+        if Instant::now() >= deadline {
+            over_budget.push(name);
+            continue;
+        }
+        remove(cleaned);
+        if Instant::now() >= deadline {
+            over_budget.push(name);
+        }
+    }
     
     let cleaned_count = cleaned.len();
     let removed = original_count.saturating_sub(cleaned_count);
@@ -113,8 +145,8 @@ pub fn deobfuscate_instructions(instructions: &[Instruction]) -> DeobfuscationRe
         cleaned_count,
         removed_instructions: removed,
         signatures,
-        cleaned_instructions: cleaned,
         success_rate,
+        over_budget,
     }
 }
 
@@ -132,14 +164,14 @@ fn detect_control_flow_flattening(instructions: &[Instruction]) -> Vec<Obfuscati
         let window = &instructions[i..i+5];
         
         // Pattern: mov reg, imm; cmp reg, imm; je/jne
-        if window[0].mnemonic == "mov" && 
-           window[1].mnemonic == "cmp" &&
-           (window[2].mnemonic.starts_with("j") && window[2].mnemonic != "jmp") {
+        if window[0].mnemonic == Mnemonic::MOV && 
+           window[1].mnemonic == Mnemonic::CMP &&
+           window[2].mnemonic.info().flow == FlowClass::CondJump {
             
             // Check if this is part of a switch-like structure
             let mut jump_targets = HashSet::new();
             for j in i..std::cmp::min(i + 20, instructions.len()) {
-                if instructions[j].mnemonic.starts_with("j") {
+                if matches!(instructions[j].mnemonic.info().flow, FlowClass::Jump | FlowClass::CondJump) {
                     jump_targets.insert(&instructions[j].operands);
                 }
             }
@@ -182,15 +214,14 @@ fn detect_opaque_predicates(instructions: &[Instruction]) -> Vec<ObfuscationSign
         let window = &instructions[i..i+3];
         
         // Pattern 1: xor reg, reg; test reg, reg; jz (always taken)
-        if window[0].mnemonic == "xor" && 
-           window[1].mnemonic == "test" &&
-           window[2].mnemonic == "jz" {
-            let xor_ops: Vec<&str> = window[0].operands.split(',').map(|s| s.trim()).collect();
-            let test_ops: Vec<&str> = window[1].operands.split(',').map(|s| s.trim()).collect();
+        if window[0].mnemonic == Mnemonic::XOR && 
+           window[1].mnemonic == Mnemonic::TEST &&
+           window[2].mnemonic == Mnemonic::JZ {
+            let (xor_ops, test_ops) = (&window[0].operands, &window[1].operands);
             
-            if xor_ops.len() == 2 && xor_ops[0] == xor_ops[1] &&
-               test_ops.len() == 2 && test_ops[0] == test_ops[1] &&
-               xor_ops[0] == test_ops[0] {
+            if xor_ops.count() == 2 && xor_ops.get(0) == xor_ops.get(1) &&
+               test_ops.count() == 2 && test_ops.get(0) == test_ops.get(1) &&
+               xor_ops.get(0) == test_ops.get(0) {
                 _opaque_count += 1;
                 
                 signatures.push(ObfuscationSignature {
@@ -198,7 +229,7 @@ fn detect_opaque_predicates(instructions: &[Instruction]) -> Vec<ObfuscationSign
                     confidence: 0.95,
                     location: window[0].address,
                     evidence: vec![
-                        format!("xor {}, {} ; test {}, {} ; jz", xor_ops[0], xor_ops[1], test_ops[0], test_ops[1]),
+                        format!("xor {}, {} ; test {}, {} ; jz", xor_ops.get(0).unwrap_or(""), xor_ops.get(1).unwrap_or(""), test_ops.get(0).unwrap_or(""), test_ops.get(1).unwrap_or("")),
                         "Always-true predicate (register XOR with itself = 0)".to_string(),
                     ],
                     description: "Opaque predicate: always-true condition used to confuse analysis".to_string(),
@@ -208,9 +239,9 @@ fn detect_opaque_predicates(instructions: &[Instruction]) -> Vec<ObfuscationSign
         }
         
         // Pattern 2: cmp reg, reg; je (always taken)
-        if window[0].mnemonic == "cmp" && window[1].mnemonic == "je" {
-            let cmp_ops: Vec<&str> = window[0].operands.split(',').map(|s| s.trim()).collect();
-            if cmp_ops.len() == 2 && cmp_ops[0] == cmp_ops[1] {
+        if window[0].mnemonic == Mnemonic::CMP && window[1].mnemonic == Mnemonic::JE {
+            let cmp_ops = &window[0].operands;
+            if cmp_ops.count() == 2 && cmp_ops.get(0) == cmp_ops.get(1) {
                 _opaque_count += 1;
                 
                 signatures.push(ObfuscationSignature {
@@ -218,7 +249,7 @@ fn detect_opaque_predicates(instructions: &[Instruction]) -> Vec<ObfuscationSign
                     confidence: 0.90,
                     location: window[0].address,
                     evidence: vec![
-                        format!("cmp {}, {} ; je", cmp_ops[0], cmp_ops[1]),
+                        format!("cmp {}, {} ; je", cmp_ops.get(0).unwrap_or(""), cmp_ops.get(1).unwrap_or("")),
                         "Always-true predicate (register compared with itself)".to_string(),
                     ],
                     description: "Opaque predicate: always-true comparison".to_string(),
@@ -228,9 +259,9 @@ fn detect_opaque_predicates(instructions: &[Instruction]) -> Vec<ObfuscationSign
         }
         
         // Pattern 3: Mathematical identities (x*x >= 0, x^2 - x is even, etc.)
-        if window[0].mnemonic == "imul" && window[1].mnemonic == "test" {
-            let imul_ops: Vec<&str> = window[0].operands.split(',').map(|s| s.trim()).collect();
-            if imul_ops.len() >= 2 && imul_ops[0] == imul_ops[1] {
+        if window[0].mnemonic == Mnemonic::IMUL && window[1].mnemonic == Mnemonic::TEST {
+            let imul_ops = &window[0].operands;
+            if imul_ops.count() >= 2 && imul_ops.get(0) == imul_ops.get(1) {
                 _opaque_count += 1;
                 
                 signatures.push(ObfuscationSignature {
@@ -238,7 +269,7 @@ fn detect_opaque_predicates(instructions: &[Instruction]) -> Vec<ObfuscationSign
                     confidence: 0.85,
                     location: window[0].address,
                     evidence: vec![
-                        format!("imul {}, {}", imul_ops[0], imul_ops[1]),
+                        format!("imul {}, {}", imul_ops.get(0).unwrap_or(""), imul_ops.get(1).unwrap_or("")),
                         "Mathematical identity: x*x always >= 0".to_string(),
                     ],
                     description: "Opaque predicate: mathematical identity used for obfuscation".to_string(),
@@ -255,7 +286,7 @@ fn detect_opaque_predicates(instructions: &[Instruction]) -> Vec<ObfuscationSign
 // DEAD CODE DETECTION
 // ============================================================================
 
-fn detect_dead_code(instructions: &[Instruction]) -> Vec<ObfuscationSignature> {
+fn detect_dead_code(instructions: &[Instruction], targets: &JumpTargets) -> Vec<ObfuscationSignature> {
     let mut signatures = Vec::new();
     let mut _dead_blocks = 0;
     
@@ -264,18 +295,18 @@ fn detect_dead_code(instructions: &[Instruction]) -> Vec<ObfuscationSignature> {
         let curr = &instructions[i];
         
         // Check for unconditional control flow change
-        if curr.mnemonic == "jmp" || curr.mnemonic == "ret" || curr.mnemonic == "retn" {
+        if matches!(curr.mnemonic.info().flow, FlowClass::Jump | FlowClass::Return) {
             // Check if next instruction is not a label/target
             if i + 1 < instructions.len() {
                 let next = &instructions[i + 1];
                 
                 // If next instruction is not a common jump target, it might be dead code
-                if !next.raw_line.contains(':') && !is_likely_jump_target(next.address, instructions) {
+                if !next.has_label() && !targets.contains(next.address) {
                     // Count consecutive non-label instructions
                     let mut dead_count = 0;
                     for j in (i+1)..std::cmp::min(i + 10, instructions.len()) {
-                        if instructions[j].raw_line.contains(':') || 
-                           is_likely_jump_target(instructions[j].address, instructions) {
+                        if instructions[j].has_label() || 
+                           targets.contains(instructions[j].address) {
                             break;
                         }
                         dead_count += 1;
@@ -304,18 +335,30 @@ fn detect_dead_code(instructions: &[Instruction]) -> Vec<ObfuscationSignature> {
     signatures
 }
 
-fn is_likely_jump_target(address: u64, instructions: &[Instruction]) -> bool {
-    for instr in instructions {
-        if instr.mnemonic.starts_with('j') || instr.mnemonic == "call" {
-            // Try to extract target address from operands
-            if let Some(target) = extract_address_from_operand(&instr.operands) {
-                if target == address {
-                    return true;
-                }
-            }
-        }
+/// Sorted, deduplicated direct targets of every jump and call, plus the
+/// caller's known code roots, built in one pass so membership is a binary
+/// search instead of a rescan of the listing. Without the roots, a function
+/// only reached through a pointer would look like dead code after the `ret`
+/// of the function before it.
+pub struct JumpTargets {
+    addresses: Vec<u64>,
+}
+
+impl JumpTargets {
+    pub fn collect(instructions: &[Instruction], roots: &[u64]) -> Self {
+        let mut addresses: Vec<u64> = instructions.iter()
+            .filter(|instr| instr.mnemonic.info().is_branch())
+            .filter_map(|instr| extract_address_from_operand(&instr.operands))
+            .chain(roots.iter().copied())
+            .collect();
+        addresses.sort_unstable();
+        addresses.dedup();
+        JumpTargets { addresses }
+    }
+
+    pub fn contains(&self, address: u64) -> bool {
+        self.addresses.binary_search(&address).is_ok()
     }
-    false
 }
 
 fn extract_address_from_operand(operand: &str) -> Option<u64> {
@@ -340,13 +383,13 @@ fn detect_instruction_substitution(instructions: &[Instruction]) -> Vec<Obfuscat
         
         // Pattern 1: neg + add instead of sub
         // sub eax, 5 => neg eax; add eax, -5
-        if window[0].mnemonic == "neg" && window[1].mnemonic == "add" {
+        if window[0].mnemonic == Mnemonic::NEG && window[1].mnemonic == Mnemonic::ADD {
             substitution_count += 1;
         }
         
         // Pattern 2: not + inc instead of neg
         // neg eax => not eax; inc eax
-        if window[0].mnemonic == "not" && window[1].mnemonic == "inc" {
+        if window[0].mnemonic == Mnemonic::NOT && window[1].mnemonic == Mnemonic::INC {
             substitution_count += 1;
         }
         
@@ -354,9 +397,9 @@ fn detect_instruction_substitution(instructions: &[Instruction]) -> Vec<Obfuscat
         // mov eax, ebx => xor eax, eax; xor eax, ebx
         if i + 2 < instructions.len() {
             let triple = &instructions[i..i+3];
-            if triple[0].mnemonic == "xor" && triple[1].mnemonic == "xor" {
-                let ops1: Vec<&str> = triple[0].operands.split(',').map(|s| s.trim()).collect();
-                if ops1.len() == 2 && ops1[0] == ops1[1] {
+            if triple[0].mnemonic == Mnemonic::XOR && triple[1].mnemonic == Mnemonic::XOR {
+                let ops1 = &triple[0].operands;
+                if ops1.count() == 2 && ops1.get(0) == ops1.get(1) {
                     substitution_count += 1;
                 }
             }
@@ -395,19 +438,19 @@ fn detect_virtualization(instructions: &[Instruction]) -> Vec<ObfuscationSignatu
         let window = &instructions[i..i+5];
         
         // Pattern 1: Bytecode fetch pattern (lodsb/lodsw/lodsd)
-        if window.iter().any(|inst| inst.mnemonic == "lodsb" || inst.mnemonic == "lodsw" || inst.mnemonic == "lodsd") {
+        if window.iter().any(|inst| inst.mnemonic == Mnemonic::LODSB || inst.mnemonic == Mnemonic::LODSW || inst.mnemonic == Mnemonic::LODSD) {
             vm_indicators += 1;
             evidence.push("Bytecode fetch instruction (lods*)".to_string());
         }
         
         // Pattern 2: Indirect jump table (common in VM dispatchers)
-        if window.iter().any(|inst| inst.mnemonic == "jmp" && inst.operands.contains('[')) {
+        if window.iter().any(|inst| inst.mnemonic == Mnemonic::JMP && inst.operands.contains('[')) {
             vm_indicators += 1;
         }
         
         // Pattern 3: Context structure access (multiple mov to/from memory)
         let mem_access_count = window.iter()
-            .filter(|inst| (inst.mnemonic == "mov" || inst.mnemonic == "lea") && 
+            .filter(|inst| (inst.mnemonic == Mnemonic::MOV || inst.mnemonic == Mnemonic::LEA) && 
                           (inst.operands.contains('[') || inst.operands.contains("ptr")))
             .count();
         
@@ -446,13 +489,13 @@ fn detect_string_encryption(instructions: &[Instruction]) -> Vec<ObfuscationSign
         
         // Pattern: xor byte ptr [...], key; inc/add; loop/jnz
         let has_xor_mem = window.iter().any(|inst| 
-            inst.mnemonic == "xor" && inst.operands.contains("byte ptr")
+            inst.mnemonic == Mnemonic::XOR && inst.operands.contains("byte ptr")
         );
         let has_inc = window.iter().any(|inst| 
-            inst.mnemonic == "inc" || inst.mnemonic == "add"
+            inst.mnemonic == Mnemonic::INC || inst.mnemonic == Mnemonic::ADD
         );
         let has_loop = window.iter().any(|inst| 
-            inst.mnemonic == "loop" || inst.mnemonic.starts_with("jn")
+            matches!(inst.mnemonic.info().cond, Some(Condition::NotEqual | Condition::CountNonZero))
         );
         
         if has_xor_mem && has_inc && has_loop {
@@ -491,12 +534,12 @@ fn detect_api_hashing(instructions: &[Instruction]) -> Vec<ObfuscationSignature>
         
         // Pattern: rol/ror + xor/add (common hash algorithms)
         let has_rotate = window.iter().any(|inst| 
-            inst.mnemonic == "rol" || inst.mnemonic == "ror"
+            inst.mnemonic == Mnemonic::ROL || inst.mnemonic == Mnemonic::ROR
         );
         let has_xor_add = window.iter().filter(|inst| 
-            inst.mnemonic == "xor" || inst.mnemonic == "add"
+            inst.mnemonic == Mnemonic::XOR || inst.mnemonic == Mnemonic::ADD
         ).count() >= 2;
-        let has_call = window.iter().any(|inst| inst.mnemonic == "call");
+        let has_call = window.iter().any(|inst| inst.mnemonic == Mnemonic::CALL);
         
         if has_rotate && has_xor_add && has_call {
             hash_patterns += 1;
@@ -533,21 +576,18 @@ fn detect_junk_code(instructions: &[Instruction]) -> Vec<ObfuscationSignature> {
         let next = &instructions[i + 1];
         
         // Pattern 1: push + pop same register
-        if curr.mnemonic == "push" && next.mnemonic == "pop" && curr.operands == next.operands {
+        if curr.mnemonic == Mnemonic::PUSH && next.mnemonic == Mnemonic::POP && curr.operands == next.operands {
             junk_count += 1;
         }
         
         // Pattern 2: nop, nop, nop...
-        if curr.mnemonic == "nop" {
+        if curr.mnemonic == Mnemonic::NOP {
             junk_count += 1;
         }
         
         // Pattern 3: mov reg, reg (same register)
-        if curr.mnemonic == "mov" {
-            let ops: Vec<&str> = curr.operands.split(',').map(|s| s.trim()).collect();
-            if ops.len() == 2 && ops[0] == ops[1] {
-                junk_count += 1;
-            }
+        if curr.mnemonic == Mnemonic::MOV && curr.operands.count() == 2 && curr.operands.get(0) == curr.operands.get(1) {
+            junk_count += 1;
         }
     }
     
@@ -573,48 +613,52 @@ fn detect_junk_code(instructions: &[Instruction]) -> Vec<ObfuscationSignature> {
 // DEOBFUSCATION REMOVAL FUNCTIONS
 // ============================================================================
 
-fn remove_junk_code(instructions: &[Instruction]) -> Vec<Instruction> {
-    let mut cleaned = Vec::new();
+/// Compact `instructions` down to the entries whose `keep` flag is set
+fn retain_marked(instructions: &mut Vec<Instruction>, keep: &[bool]) {
+    let mut flags = keep.iter();
+    instructions.retain(|_| *flags.next().unwrap_or(&true));
+}
+
+fn remove_junk_code(instructions: &mut Vec<Instruction>) {
+    let mut keep = vec![true; instructions.len()];
     let mut skip_next = false;
     
     for i in 0..instructions.len() {
         if skip_next {
             skip_next = false;
+            keep[i] = false;
             continue;
         }
         
         let curr = &instructions[i];
         
         // Remove nops
-        if curr.mnemonic == "nop" {
+        if curr.mnemonic == Mnemonic::NOP {
+            keep[i] = false;
             continue;
         }
         
         // Remove mov reg, reg (same register)
-        if curr.mnemonic == "mov" {
-            let ops: Vec<&str> = curr.operands.split(',').map(|s| s.trim()).collect();
-            if ops.len() == 2 && ops[0] == ops[1] {
-                continue;
-            }
+        if curr.mnemonic == Mnemonic::MOV && curr.operands.count() == 2 && curr.operands.get(0) == curr.operands.get(1) {
+            keep[i] = false;
+            continue;
         }
         
         // Remove push/pop pairs
         if i + 1 < instructions.len() {
             let next = &instructions[i + 1];
-            if curr.mnemonic == "push" && next.mnemonic == "pop" && curr.operands == next.operands {
+            if curr.mnemonic == Mnemonic::PUSH && next.mnemonic == Mnemonic::POP && curr.operands == next.operands {
                 skip_next = true;
-                continue;
+                keep[i] = false;
             }
         }
-        
-        cleaned.push(curr.clone());
     }
     
-    cleaned
+    retain_marked(instructions, &keep);
 }
 
-fn remove_dead_code(instructions: &[Instruction]) -> Vec<Instruction> {
-    let mut cleaned = Vec::new();
+fn remove_dead_code(instructions: &mut Vec<Instruction>, targets: &JumpTargets) {
+    let mut keep = vec![true; instructions.len()];
     let mut in_dead_block = false;
     
     for i in 0..instructions.len() {
@@ -623,33 +667,32 @@ fn remove_dead_code(instructions: &[Instruction]) -> Vec<Instruction> {
         // Check if we're entering dead code
         if i > 0 {
             let prev = &instructions[i - 1];
-            if (prev.mnemonic == "jmp" || prev.mnemonic == "ret" || prev.mnemonic == "retn") &&
-               !curr.raw_line.contains(':') &&
-               !is_likely_jump_target(curr.address, instructions) {
+            if matches!(prev.mnemonic.info().flow, FlowClass::Jump | FlowClass::Return) &&
+               !curr.has_label() &&
+               !targets.contains(curr.address) {
                 in_dead_block = true;
             }
         }
         
         // Check if we're exiting dead code (found a label/jump target)
-        if in_dead_block && (curr.raw_line.contains(':') || is_likely_jump_target(curr.address, instructions)) {
+        if in_dead_block && (curr.has_label() || targets.contains(curr.address)) {
             in_dead_block = false;
         }
         
-        if !in_dead_block {
-            cleaned.push(curr.clone());
-        }
+        keep[i] = !in_dead_block;
     }
     
-    cleaned
+    retain_marked(instructions, &keep);
 }
 
-fn remove_opaque_predicates(instructions: &[Instruction]) -> Vec<Instruction> {
-    let mut cleaned = Vec::new();
+fn remove_opaque_predicates(instructions: &mut Vec<Instruction>) {
+    let mut keep = vec![true; instructions.len()];
     let mut skip_count = 0;
     
     for i in 0..instructions.len() {
         if skip_count > 0 {
             skip_count -= 1;
+            keep[i] = false;
             continue;
         }
         
@@ -658,62 +701,55 @@ fn remove_opaque_predicates(instructions: &[Instruction]) -> Vec<Instruction> {
             let window = &instructions[i..i+3];
             
             // Pattern: xor reg, reg; test reg, reg; jz
-            if window[0].mnemonic == "xor" && window[1].mnemonic == "test" && window[2].mnemonic == "jz" {
-                let xor_ops: Vec<&str> = window[0].operands.split(',').map(|s| s.trim()).collect();
-                let test_ops: Vec<&str> = window[1].operands.split(',').map(|s| s.trim()).collect();
+            if window[0].mnemonic == Mnemonic::XOR && window[1].mnemonic == Mnemonic::TEST && window[2].mnemonic == Mnemonic::JZ {
+                let (xor_ops, test_ops) = (&window[0].operands, &window[1].operands);
                 
-                if xor_ops.len() == 2 && xor_ops[0] == xor_ops[1] &&
-                   test_ops.len() == 2 && test_ops[0] == test_ops[1] {
+                if xor_ops.count() == 2 && xor_ops.get(0) == xor_ops.get(1) &&
+                   test_ops.count() == 2 && test_ops.get(0) == test_ops.get(1) {
                     // Skip all three instructions (opaque predicate)
                     skip_count = 2;
-                    continue;
+                    keep[i] = false;
                 }
             }
         }
-        
-        cleaned.push(instructions[i].clone());
     }
     
-    cleaned
+    retain_marked(instructions, &keep);
 }
 
-fn simplify_instruction_substitution(instructions: &[Instruction]) -> Vec<Instruction> {
-    let mut cleaned = Vec::new();
+fn simplify_instruction_substitution(instructions: &mut Vec<Instruction>) {
+    let mut keep = vec![true; instructions.len()];
     let mut skip_next = false;
     
     for i in 0..instructions.len() {
         if skip_next {
             skip_next = false;
+            keep[i] = false;
             continue;
         }
         
         // Check for substitution patterns and simplify
         if i + 1 < instructions.len() {
-            let curr = &instructions[i];
-            let next = &instructions[i + 1];
+            let (curr, next) = (&instructions[i], &instructions[i + 1]);
             
-            // Pattern: not + inc => neg
-            if curr.mnemonic == "not" && next.mnemonic == "inc" && curr.operands == next.operands {
-                let mut simplified = curr.clone();
-                simplified.mnemonic = "neg".to_string();
-                simplified.raw_line = format!("neg {}", curr.operands);
-                cleaned.push(simplified);
+            // Pattern: not + inc => neg (rewritten in place, the inc is dropped)
+            if curr.mnemonic == Mnemonic::NOT && next.mnemonic == Mnemonic::INC && curr.operands == next.operands {
+                let raw_line = format!("neg {}", curr.operands);
+                let simplified = &mut instructions[i];
+                simplified.mnemonic = Mnemonic::NEG;
+                simplified.raw_line = Some(raw_line.into());
                 skip_next = true;
-                continue;
             }
         }
-        
-        cleaned.push(instructions[i].clone());
     }
     
-    cleaned
+    retain_marked(instructions, &keep);
 }
 
-fn unfold_constants(instructions: &[Instruction]) -> Vec<Instruction> {
+fn unfold_constants(_instructions: &mut Vec<Instruction>) {
     // This would require more complex analysis to evaluate constant expressions
-    // For now, just return the instructions as-is
+    // For now, leave the instructions as-is
     // Future enhancement: evaluate arithmetic operations on constants
-    instructions.to_vec()
 }
 
 // ============================================================================
@@ -732,7 +768,11 @@ pub fn format_deobfuscation_report(result: &DeobfuscationResult) -> String {
     report.push_str(&format!("   Cleaned Instructions:  {}\n", result.cleaned_count));
     report.push_str(&format!("   Removed Instructions:  {} ({:.1}%)\n", 
         result.removed_instructions, result.success_rate));
-    report.push_str(&format!("   Obfuscation Techniques: {}\n\n", result.signatures.len()));
+    report.push_str(&format!("   Obfuscation Techniques: {}\n", result.signatures.len()));
+    if !result.over_budget.is_empty() {
+        report.push_str(&format!("   Time Budget Exceeded:  {}\n", result.over_budget.join(", ")));
+    }
+    report.push_str("\n");
     
     if result.signatures.is_empty() {
         report.push_str("✅ No obfuscation detected - code appears clean!\n\n");
@@ -784,4 +824,64 @@ pub fn format_deobfuscation_report(result: &DeobfuscationResult) -> String {
     report.push_str("✨ Deobfuscation applied - cleaned code available for analysis\n\n");
     
     report
-}
\ No newline at end of file
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_jump_targets_collected_once() {
+        let instructions = vec![
+            Instruction::new(0x1000, "jmp", "0x1010"),
+            Instruction::new(0x1005, "call", "0x1000"),
+            Instruction::new(0x100a, "jne", "0x1010"),
+            Instruction::new(0x100c, "mov", "eax, 0x2000"),
+            Instruction::new(0x1010, "call", "qword ptr [rip + 0x10]"),
+        ];
+        let targets = JumpTargets::collect(&instructions, &[0x1010, 0x3000]);
+        assert_eq!(targets.addresses, [0x1000, 0x1010, 0x3000]);
+        assert!(targets.contains(0x1010));
+        assert!(!targets.contains(0x2000));
+    }
+
+    #[test]
+    fn test_dead_code_keeps_functions_reached_from_roots() {
+        let listing = [
+            (0x1000, "call", "0x1010"),
+            (0x1005, "ret", ""),
+            // Only reached through a pointer; its start is a .pdata entry
+            (0x1006, "mov", "eax, 1"),
+            (0x100b, "add", "eax, ecx"),
+            (0x100d, "ret", ""),
+            (0x1010, "xor", "eax, eax"),
+            (0x1012, "ret", ""),
+        ];
+        let instructions: Vec<Instruction> = listing.iter().map(|&(a, m, o)| Instruction::new(a, m, o)).collect();
+        let deadline = Instant::now() + std::time::Duration::from_secs(60);
+
+        let mut rooted = instructions.clone();
+        deobfuscate_instructions(&mut rooted, &[0x1000, 0x1006], deadline);
+        assert_eq!(rooted.len(), instructions.len());
+
+        let mut unrooted = instructions;
+        deobfuscate_instructions(&mut unrooted, &[], deadline);
+        assert_eq!(unrooted.iter().map(|i| i.address).collect::<Vec<_>>(), vec![0x1000, 0x1005, 0x1010, 0x1012]);
+    }
+
+    #[test]
+    fn test_deobfuscation_runs_in_place() {
+        let mut instructions = vec![
+            Instruction::new(0x1000, "nop", ""),
+            Instruction::new(0x1001, "not", "eax"),
+            Instruction::new(0x1003, "inc", "eax"),
+            Instruction::new(0x1005, "mov", "ebx, ebx"),
+            Instruction::new(0x1007, "ret", ""),
+        ];
+        let result = deobfuscate_instructions(&mut instructions, &[], Instant::now() + std::time::Duration::from_secs(60));
+        let kept: Vec<String> = instructions.iter().map(|i| format!("{} {}", i.mnemonic, i.operands)).collect();
+        assert_eq!(kept, ["neg eax", "ret "]);
+        assert_eq!(result.cleaned_count, 2);
+        assert_eq!(result.removed_instructions, 3);
+    }
+}
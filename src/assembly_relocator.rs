@@ -15,6 +15,7 @@
 use std::collections::HashMap;
 use std::path::Path;
 use crate::native_disassembler;
+use crate::pe_image::{self, LoadedImage};
 
 #[derive(Debug, Clone)]
 pub struct RipReference {
@@ -191,7 +192,7 @@ fn find_rip_references(source: &str) -> Vec<RipReference> {
 }
 
 /// Extract the offset from a RIP-relative address like "[rip + 0x2f4a]" or "[rip - 0x10]"
-fn extract_rip_offset(line: &str) -> Option<i64> {
+pub(crate) fn extract_rip_offset(line: &str) -> Option<i64> {
     // Look for [rip + 0x...] or [rip - 0x...]
     if let Some(start) = line.find("[rip") {
         let rest = &line[start..];
@@ -350,16 +351,10 @@ impl ExtractedPEData {
 
 /// Extract data from the original PE executable using native C module
 fn extract_pe_data(exe_path: &Path, rip_refs: &[RipReference]) -> Result<ExtractedPEData, String> {
-    use goblin::pe::PE;
-    use std::fs;
-    
-    // Read the original executable
-    let buffer = fs::read(exe_path)
-        .map_err(|e| format!("Failed to read executable: {}", e))?;
-    
-    // Parse the PE
-    let pe = PE::parse(&buffer)
-        .map_err(|e| format!("Failed to parse PE: {}", e))?;
+    // Map and parse the original executable once; all reads below borrow from it
+    let image = LoadedImage::open(exe_path)?;
+    let buffer = image.bytes();
+    let pe = image.pe();
     
     let mut iat_entries = HashMap::new();
     let mut data_sections = HashMap::new();
@@ -369,12 +364,12 @@ fn extract_pe_data(exe_path: &Path, rip_refs: &[RipReference]) -> Result<Extract
     println!("   Entry point: 0x{:x}", pe.entry);
     
     // Use native module to parse PE header
-    if let Some((entry_point, is_64bit)) = native_disassembler::parse_pe_header(&buffer) {
+    if let Some((entry_point, is_64bit)) = native_disassembler::parse_pe_header(buffer) {
         println!("   ✓ PE Header: Entry=0x{:x}, 64-bit={}", entry_point, is_64bit);
     }
     
     // Extract IAT (Import Address Table) entries
-    if let Some(import_data) = pe.import_data {
+    if let Some(import_data) = &pe.import_data {
         println!("   Imports: {} DLLs", import_data.import_data.len());
         
         // For each RIP reference that looks like a call, extract the actual pointer
@@ -408,7 +403,7 @@ fn extract_pe_data(exe_path: &Path, rip_refs: &[RipReference]) -> Result<Extract
     
     // Extract data sections (.data, .rdata, .bss) - properly this time!
     for section in &pe.sections {
-        let name = String::from_utf8_lossy(&section.name).trim_end_matches('\0').to_string();
+        let name = pe_image::section_name(section);
         println!("   Section: {} (RVA: 0x{:x}, Size: 0x{:x})", 
                  name, section.virtual_address, section.virtual_size);
         
@@ -418,7 +413,7 @@ fn extract_pe_data(exe_path: &Path, rip_refs: &[RipReference]) -> Result<Extract
             let size = section.size_of_raw_data as usize;
             
             if start + size <= buffer.len() {
-                let section_data = &buffer[start..start + size];
+                let section_data = image.section_data(section);
                 
                 for rip_ref in rip_refs.iter().filter(|r| r.is_data) {
                     let offset = rip_ref.offset as usize;
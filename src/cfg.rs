@@ -0,0 +1,370 @@
+// ============================================================================
+// CONTROL FLOW GRAPH
+// ============================================================================
+// Per-function graph over basic blocks, built once when the function is
+// analysed and kept on it. Blocks are numbered in address order; block 0 is
+// the entry. Successor and predecessor lists live in two flat arrays with an
+// offset table each (CSR layout), so a function's whole graph is four
+// allocations. On top of the edges the builder computes reverse postorder,
+// the dominator tree (Cooper/Harvey/Kennedy) and the natural loops, which is
+// what structuring, dead-code and liveness passes need to walk the function
+// without rescanning instruction text.
+// ============================================================================
+
+use std::ops::Range;
+
+use crate::ir::{FlowClass, Instruction};
+
+const NONE: u32 = u32::MAX;
+
+/// Compressed adjacency lists: the edges of node `n` are
+/// `targets[offsets[n]..offsets[n + 1]]`
+#[derive(Debug, Clone, Default)]
+struct Adjacency {
+    offsets: Vec<u32>,
+    targets: Vec<u32>,
+}
+
+impl Adjacency {
+    /// Group `edges` by source with a counting sort; edge order per source is kept
+    fn from_edges(node_count: usize, edges: &[(u32, u32)], by_target: bool) -> Adjacency {
+        let key = |&(from, to): &(u32, u32)| if by_target { (to, from) } else { (from, to) };
+
+        let mut offsets = vec![0u32; node_count + 1];
+        for edge in edges {
+            offsets[key(edge).0 as usize + 1] += 1;
+        }
+        for n in 0..node_count {
+            offsets[n + 1] += offsets[n];
+        }
+
+        let mut fill = offsets.clone();
+        let mut targets = vec![0u32; edges.len()];
+        for edge in edges {
+            let (node, other) = key(edge);
+            targets[fill[node as usize] as usize] = other;
+            fill[node as usize] += 1;
+        }
+        Adjacency { offsets, targets }
+    }
+
+    fn of(&self, node: usize) -> &[u32] {
+        &self.targets[self.offsets[node] as usize..self.offsets[node + 1] as usize]
+    }
+}
+
+/// A loop whose header dominates every block in it
+#[derive(Debug, Clone)]
+pub struct NaturalLoop {
+    pub header: usize,
+    /// Sources of the back edges into `header`
+    pub latches: Vec<usize>,
+    /// Every block of the loop, header included, in ascending order
+    #[allow(dead_code)]
+    pub body: Vec<usize>,
+}
+
+#[derive(Debug, Clone, Default)]
+pub struct ControlFlowGraph {
+    /// Start address of each block, ascending (the address-to-block index)
+    starts: Vec<u64>,
+    succs: Adjacency,
+    preds: Adjacency,
+    /// Reachable blocks in reverse postorder from the entry
+    rpo: Vec<u32>,
+    /// Immediate dominator per block; the entry is its own, unreachable
+    /// blocks have `NONE`
+    idom: Vec<u32>,
+    /// Dominator tree: children of each block
+    dom_tree: Adjacency,
+    /// Dominator tree preorder entry/exit numbers, for O(1) `dominates`
+    dom_pre: Vec<u32>,
+    dom_post: Vec<u32>,
+    loops: Vec<NaturalLoop>,
+}
+
+impl ControlFlowGraph {
+    /// Build the graph for blocks given as index ranges into `instructions`,
+    /// in address order. Direct branch targets that are not the start of one
+    /// of these blocks (tail calls, calls to other functions) get no edge.
+    pub fn build(instructions: &[Instruction], blocks: &[Range<usize>]) -> ControlFlowGraph {
+        let starts: Vec<u64> = blocks.iter().map(|range| instructions[range.start].address).collect();
+        let block_at = |address: u64| starts.binary_search(&address).ok().map(|b| b as u32);
+
+        let mut edges = Vec::with_capacity(blocks.len() * 2);
+        for (b, range) in blocks.iter().enumerate() {
+            let Some(last) = range.end.checked_sub(1).map(|i| &instructions[i]) else {
+                continue;
+            };
+            let from = b as u32;
+            let fallthrough = blocks.get(b + 1).filter(|next| next.start == range.end).map(|_| from + 1);
+            let target = last.operands.imm().and_then(block_at);
+
+            let info = last.mnemonic.info();
+            let (first, second) = match info.flow {
+                FlowClass::Sequential | FlowClass::Call => (fallthrough, None),
+                FlowClass::Jump => (target, None),
+                FlowClass::CondJump => (target, fallthrough.filter(|&f| Some(f) != target)),
+                FlowClass::Return | FlowClass::Stop => (None, None),
+            };
+            edges.extend(first.into_iter().chain(second).map(|to| (from, to)));
+        }
+
+        let n = blocks.len();
+        let mut cfg = ControlFlowGraph {
+            succs: Adjacency::from_edges(n, &edges, false),
+            preds: Adjacency::from_edges(n, &edges, true),
+            starts,
+            ..ControlFlowGraph::default()
+        };
+        if n > 0 {
+            cfg.compute_rpo();
+            cfg.compute_dominators();
+            cfg.compute_loops();
+        }
+        cfg
+    }
+
+    pub fn len(&self) -> usize {
+        self.starts.len()
+    }
+
+    /// Block starting exactly at `address`
+    #[allow(dead_code)]
+    pub fn block_at(&self, address: u64) -> Option<usize> {
+        self.starts.binary_search(&address).ok()
+    }
+
+    /// Block whose address range contains `address`
+    #[allow(dead_code)]
+    pub fn block_containing(&self, address: u64) -> Option<usize> {
+        self.starts.partition_point(|&start| start <= address).checked_sub(1)
+    }
+
+    pub fn successors(&self, block: usize) -> impl Iterator<Item = usize> + '_ {
+        self.succs.of(block).iter().map(|&b| b as usize)
+    }
+
+    pub fn predecessors(&self, block: usize) -> impl Iterator<Item = usize> + '_ {
+        self.preds.of(block).iter().map(|&b| b as usize)
+    }
+
+    /// Reachable blocks, each before its successors except along back edges
+    #[allow(dead_code)]
+    pub fn reverse_postorder(&self) -> impl Iterator<Item = usize> + '_ {
+        self.rpo.iter().map(|&b| b as usize)
+    }
+
+    #[allow(dead_code)]
+    pub fn is_reachable(&self, block: usize) -> bool {
+        self.idom[block] != NONE
+    }
+
+    /// Immediate dominator; `None` for the entry and for unreachable blocks
+    #[allow(dead_code)]
+    pub fn idom(&self, block: usize) -> Option<usize> {
+        match self.idom[block] {
+            NONE => None,
+            d if d as usize == block => None,
+            d => Some(d as usize),
+        }
+    }
+
+    /// Blocks whose immediate dominator is `block`
+    pub fn dom_children(&self, block: usize) -> impl Iterator<Item = usize> + '_ {
+        self.dom_tree.of(block).iter().map(|&b| b as usize)
+    }
+
+    /// Every path from the entry to `b` goes through `a`
+    pub fn dominates(&self, a: usize, b: usize) -> bool {
+        self.idom[a] != NONE && self.idom[b] != NONE &&
+            self.dom_pre[a] <= self.dom_pre[b] && self.dom_post[b] <= self.dom_post[a]
+    }
+
+    pub fn loops(&self) -> &[NaturalLoop] {
+        &self.loops
+    }
+
+    /// Iterative DFS from the entry, so deep graphs cannot overflow the stack
+    fn compute_rpo(&mut self) {
+        let n = self.len();
+        let mut visited = vec![false; n];
+        let mut postorder = Vec::with_capacity(n);
+        let mut stack: Vec<(u32, u32)> = vec![(0, 0)];
+        visited[0] = true;
+
+        while let Some((node, next)) = stack.last_mut() {
+            let succs = self.succs.of(*node as usize);
+            if let Some(&succ) = succs.get(*next as usize) {
+                *next += 1;
+                if !visited[succ as usize] {
+                    visited[succ as usize] = true;
+                    stack.push((succ, 0));
+                }
+            } else {
+                postorder.push(*node);
+                stack.pop();
+            }
+        }
+
+        postorder.reverse();
+        self.rpo = postorder;
+    }
+
+    /// "A Simple, Fast Dominance Algorithm" over the reverse postorder,
+    /// then pre/post numbering of the resulting tree
+    fn compute_dominators(&mut self) {
+        let n = self.len();
+        let mut order = vec![NONE; n];
+        for (i, &b) in self.rpo.iter().enumerate() {
+            order[b as usize] = i as u32;
+        }
+
+        let mut idom = vec![NONE; n];
+        idom[0] = 0;
+        let intersect = |idom: &[u32], mut a: u32, mut b: u32| {
+            while a != b {
+                while order[a as usize] > order[b as usize] {
+                    a = idom[a as usize];
+                }
+                while order[b as usize] > order[a as usize] {
+                    b = idom[b as usize];
+                }
+            }
+            a
+        };
+
+        let mut changed = true;
+        while changed {
+            changed = false;
+            for &b in &self.rpo[1..] {
+                let mut new_idom = NONE;
+                for &p in self.preds.of(b as usize) {
+                    if idom[p as usize] == NONE {
+                        continue;
+                    }
+                    new_idom = if new_idom == NONE { p } else { intersect(&idom, p, new_idom) };
+                }
+                if idom[b as usize] != new_idom {
+                    idom[b as usize] = new_idom;
+                    changed = true;
+                }
+            }
+        }
+
+        // Dominator tree children in CSR form, then one iterative DFS
+        let tree_edges: Vec<(u32, u32)> = (1..n as u32)
+            .filter(|&b| idom[b as usize] != NONE)
+            .map(|b| (idom[b as usize], b))
+            .collect();
+        self.dom_tree = Adjacency::from_edges(n, &tree_edges, false);
+
+        self.dom_pre = vec![0; n];
+        self.dom_post = vec![0; n];
+        let mut clock = 0u32;
+        let mut stack: Vec<(u32, u32)> = vec![(0, 0)];
+        self.dom_pre[0] = clock;
+        while let Some((node, next)) = stack.last_mut() {
+            let kids = self.dom_tree.of(*node as usize);
+            clock += 1;
+            if let Some(&child) = kids.get(*next as usize) {
+                *next += 1;
+                self.dom_pre[child as usize] = clock;
+                stack.push((child, 0));
+            } else {
+                self.dom_post[*node as usize] = clock;
+                stack.pop();
+            }
+        }
+        self.idom = idom;
+    }
+
+    /// One loop per header: the union of the natural loops of all back edges
+    /// into it
+    fn compute_loops(&mut self) {
+        let n = self.len();
+        let mut in_body = vec![false; n];
+        let mut worklist = Vec::new();
+
+        for &header in &self.rpo {
+            let header = header as usize;
+            let latches: Vec<usize> = self.predecessors(header).filter(|&p| self.dominates(header, p)).collect();
+            if latches.is_empty() {
+                continue;
+            }
+
+            let mut body = vec![header];
+            in_body[header] = true;
+            worklist.extend(latches.iter().copied());
+            while let Some(b) = worklist.pop() {
+                if in_body[b] {
+                    continue;
+                }
+                in_body[b] = true;
+                body.push(b);
+                worklist.extend(self.predecessors(b).filter(|&p| !in_body[p]));
+            }
+            for &b in &body {
+                in_body[b] = false;
+            }
+            body.sort_unstable();
+
+            self.loops.push(NaturalLoop { header, latches, body });
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn code(lines: &[(u64, &str, &str)]) -> Vec<Instruction> {
+        lines.iter().map(|&(address, mnemonic, operands)| Instruction::new(address, mnemonic, operands)).collect()
+    }
+
+    #[test]
+    fn test_diamond_and_loop() {
+        // 0: entry, branches to 2 or falls into 1; both reach 3, which loops
+        // back to itself and then returns through 4
+        let instructions = code(&[
+            (0x10, "cmp", "eax, 0"),
+            (0x12, "je", "0x20"),
+            (0x14, "mov", "ebx, 1"),
+            (0x18, "jmp", "0x24"),
+            (0x20, "mov", "ebx, 2"),
+            (0x24, "dec", "ecx"),
+            (0x26, "jne", "0x24"),
+            (0x28, "ret", ""),
+        ]);
+        let cfg = ControlFlowGraph::build(&instructions, &[0..2, 2..4, 4..5, 5..7, 7..8]);
+
+        assert_eq!(cfg.successors(0).collect::<Vec<_>>(), vec![2, 1]);
+        assert_eq!(cfg.predecessors(3).collect::<Vec<_>>(), vec![1, 2, 3]);
+        assert_eq!(cfg.successors(4).count(), 0);
+        assert_eq!(cfg.block_at(0x24), Some(3));
+        assert_eq!(cfg.block_containing(0x26), Some(3));
+
+        assert_eq!(cfg.idom(3), Some(0));
+        assert_eq!(cfg.idom(4), Some(3));
+        assert!(cfg.dominates(0, 4) && cfg.dominates(3, 4));
+        assert!(!cfg.dominates(1, 3));
+
+        let loops = cfg.loops();
+        assert_eq!(loops.len(), 1);
+        assert_eq!((loops[0].header, loops[0].latches.clone(), loops[0].body.clone()), (3, vec![3], vec![3]));
+    }
+
+    #[test]
+    fn test_backward_jump_without_dominance_is_not_a_loop() {
+        // Entry jumps over block 1 into block 2, which jumps back into 1:
+        // 1 does not dominate 2, so the backward edge is not a loop
+        let instructions = code(&[
+            (0x10, "jmp", "0x20"),
+            (0x14, "ret", ""),
+            (0x20, "jmp", "0x14"),
+        ]);
+        let cfg = ControlFlowGraph::build(&instructions, &[0..1, 1..2, 2..3]);
+        assert!(cfg.loops().is_empty());
+        assert_eq!(cfg.reverse_postorder().collect::<Vec<_>>(), vec![0, 2, 1]);
+    }
+}
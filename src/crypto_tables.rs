@@ -0,0 +1,375 @@
+// ============================================================================
+// CRYPTO TABLE SCANNER  (raw section bytes)
+// ============================================================================
+// Real AES/SHA/CRC/Blowfish implementations keep their lookup tables in
+// .rdata/.data, where instruction-level constant matching never looks. This
+// scans the raw bytes of every non-executable section for known tables with
+// one Aho-Corasick automaton (SIMD prefilter), then finds the code that
+// references each hit among the decoded instructions: RIP-relative operands
+// (x64, resolved against the instruction's decoded length) or absolute
+// addresses (x86) that land inside it. Both walks are linear and run in
+// parallel, cheap enough to run on every binary.
+// ============================================================================
+
+use aho_corasick::AhoCorasick;
+use capstone::Capstone;
+use rayon::prelude::*;
+use std::ops::Range;
+use std::sync::OnceLock;
+
+use crate::ir::{Instruction, RegClass};
+use crate::pe_disasm;
+use crate::pe_image::{self, LoadedImage};
+
+const IMAGE_SCN_CNT_CODE: u32 = 0x0000_0020;
+const IMAGE_SCN_MEM_EXECUTE: u32 = 0x2000_0000;
+
+/// Longest x86 instruction
+const MAX_INSN_LEN: usize = 15;
+
+/// Instructions handed to one worker while looking for references
+const XREF_CHUNK: usize = 4096;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum TableFamily {
+    Aes,
+    Md5,
+    Sha1,
+    Sha256,
+    Des,
+    Crc32,
+    Blowfish,
+    Base64,
+}
+
+/// A known table found in a data section
+#[derive(Debug, Clone)]
+pub struct TableHit {
+    pub name: &'static str,
+    pub family: TableFamily,
+    pub section: String,
+    pub va: u64,
+    pub len: usize,
+    /// VAs of the instructions that reference the table
+    pub xrefs: Vec<u64>,
+}
+
+struct TableDef {
+    name: &'static str,
+    family: TableFamily,
+    bytes: Vec<u8>,
+}
+
+// ============================================================================
+// TABLE DEFINITIONS
+// ============================================================================
+
+const MD5_T: [u32; 16] = [
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+];
+
+const SHA1_INIT: [u32; 5] = [0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0];
+
+const SHA256_K: [u32; 64] = [
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+];
+
+/// Blowfish initial P-array (hex digits of pi)
+const BLOWFISH_P: [u32; 18] = [
+    0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344, 0xa4093822, 0x299f31d0, 0x082efa98, 0xec4e6c89,
+    0x452821e6, 0x38d01377, 0xbe5466cf, 0x34e90c6c, 0xc0ac29b7, 0xc97c50dd, 0x3f84d5b5, 0xb5470917,
+    0x9216d5d9, 0x8979fb1b,
+];
+
+/// DES S-box 1, one byte per entry
+const DES_S1: [u8; 64] = [
+    14, 4, 13, 1, 2, 15, 11, 8, 3, 10, 6, 12, 5, 9, 0, 7,
+    0, 15, 7, 4, 14, 2, 13, 1, 10, 6, 12, 11, 9, 5, 3, 8,
+    4, 1, 14, 8, 13, 6, 2, 11, 15, 12, 9, 7, 3, 10, 5, 0,
+    15, 12, 8, 2, 4, 9, 1, 7, 5, 11, 3, 14, 10, 0, 6, 13,
+];
+
+const BASE64_ALPHABET: &[u8; 64] = b"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/// Little-endian bytes of 32-bit words, the way an x86 `uint32_t[]` sits in memory
+fn words_le(words: impl IntoIterator<Item = u32>) -> Vec<u8> {
+    words.into_iter().flat_map(|w| w.to_le_bytes()).collect()
+}
+
+/// Multiply by x in GF(2^8) with the AES polynomial
+fn xtime(b: u8) -> u8 {
+    (b << 1) ^ if b & 0x80 != 0 { 0x1b } else { 0 }
+}
+
+/// AES S-box, computed: multiplicative inverse in GF(2^8), then the affine map
+fn aes_sbox() -> [u8; 256] {
+    let mut sbox = [0u8; 256];
+    // Walk the field with generator 3 and its inverse (246) in lockstep
+    let (mut p, mut q) = (1u8, 1u8);
+    loop {
+        p ^= xtime(p);
+        q ^= q << 1;
+        q ^= q << 2;
+        q ^= q << 4;
+        if q & 0x80 != 0 {
+            q ^= 0x09;
+        }
+        sbox[p as usize] = q ^ q.rotate_left(1) ^ q.rotate_left(2) ^ q.rotate_left(3) ^ q.rotate_left(4) ^ 0x63;
+        if p == 1 {
+            break;
+        }
+    }
+    sbox[0] = 0x63;
+    sbox
+}
+
+/// CRC-32 lookup table for `poly`, reflected (LSB-first) or MSB-first
+fn crc32_table(poly: u32, reflected: bool) -> Vec<u32> {
+    (0..256u32)
+        .map(|n| {
+            let mut c = if reflected { n } else { n << 24 };
+            for _ in 0..8 {
+                c = if reflected {
+                    if c & 1 != 0 { poly ^ (c >> 1) } else { c >> 1 }
+                } else if c & 0x8000_0000 != 0 {
+                    (c << 1) ^ poly
+                } else {
+                    c << 1
+                };
+            }
+            c
+        })
+        .collect()
+}
+
+fn table_defs() -> Vec<TableDef> {
+    let sbox = aes_sbox();
+    let mut inv_sbox = [0u8; 256];
+    for (i, &s) in sbox.iter().enumerate() {
+        inv_sbox[s as usize] = i as u8;
+    }
+    // Te0[x] = (2s, s, s, 3s) packed big-end first; Te1..Te3 are byte rotations
+    let te0: Vec<u32> = sbox
+        .iter()
+        .map(|&s| u32::from_be_bytes([xtime(s), s, s, xtime(s) ^ s]))
+        .collect();
+
+    let def = |name, family, bytes| TableDef { name, family, bytes };
+    let mut defs = vec![
+        def("AES S-box", TableFamily::Aes, sbox.to_vec()),
+        def("AES inverse S-box", TableFamily::Aes, inv_sbox.to_vec()),
+    ];
+    for (k, name) in ["AES T-table Te0", "AES T-table Te1", "AES T-table Te2", "AES T-table Te3"].into_iter().enumerate() {
+        defs.push(def(name, TableFamily::Aes, words_le(te0.iter().map(|t| t.rotate_right(8 * k as u32)))));
+    }
+    defs.extend([
+        def("MD5 sine table", TableFamily::Md5, words_le(MD5_T)),
+        def("SHA-1 initial hash", TableFamily::Sha1, words_le(SHA1_INIT)),
+        def("SHA-256 K", TableFamily::Sha256, words_le(SHA256_K)),
+        def("DES S-box 1", TableFamily::Des, DES_S1.to_vec()),
+        def("CRC-32 table", TableFamily::Crc32, words_le(crc32_table(0xedb8_8320, true))),
+        def("CRC-32 table (MSB-first)", TableFamily::Crc32, words_le(crc32_table(0x04c1_1db7, false))),
+        def("Blowfish P-array", TableFamily::Blowfish, words_le(BLOWFISH_P)),
+        def("Base64 alphabet", TableFamily::Base64, BASE64_ALPHABET.to_vec()),
+    ]);
+    defs
+}
+
+struct Matcher {
+    defs: Vec<TableDef>,
+    automaton: AhoCorasick,
+}
+
+fn matcher() -> &'static Matcher {
+    static MATCHER: OnceLock<Matcher> = OnceLock::new();
+    MATCHER.get_or_init(|| {
+        let defs = table_defs();
+        let automaton = AhoCorasick::new(defs.iter().map(|d| &d.bytes))
+            .expect("crypto table patterns are valid");
+        Matcher { defs, automaton }
+    })
+}
+
+// ============================================================================
+// SCANNING
+// ============================================================================
+
+/// Find known tables in the non-executable sections of `image` and the
+/// `instructions` (decoded from it, addressed by RVA) that reference them
+pub fn scan_image(image: &LoadedImage, instructions: &[Instruction]) -> Vec<TableHit> {
+    let pe = image.pe();
+    let image_base = pe.image_base as u64;
+    let matcher = matcher();
+    let is_code = |characteristics: u32| characteristics & (IMAGE_SCN_MEM_EXECUTE | IMAGE_SCN_CNT_CODE) != 0;
+
+    // (rva range, hit) for every table, in section order
+    let mut hits: Vec<(Range<u64>, TableHit)> = pe
+        .sections
+        .par_iter()
+        .filter(|section| !is_code(section.characteristics))
+        .flat_map_iter(|section| {
+            let section_rva = section.virtual_address as u64;
+            let name = pe_image::section_name(section);
+            matcher
+                .automaton
+                .find_iter(image.section_data(section))
+                .map(|found| {
+                    let def = &matcher.defs[found.pattern().as_usize()];
+                    let rva = section_rva + found.start() as u64;
+                    (rva..rva + def.bytes.len() as u64, TableHit {
+                        name: def.name,
+                        family: def.family,
+                        section: name.clone(),
+                        va: image_base + rva,
+                        len: def.bytes.len(),
+                        xrefs: Vec::new(),
+                    })
+                })
+                .collect::<Vec<_>>()
+        })
+        .collect();
+    if hits.is_empty() {
+        return Vec::new();
+    }
+    hits.sort_unstable_by_key(|(range, _)| range.start);
+
+    let ranges: Vec<Range<u64>> = hits.iter().map(|(range, _)| range.clone()).collect();
+    let table_at = |rva: u64| {
+        let slot = ranges.partition_point(|r| r.start <= rva);
+        (slot > 0 && rva < ranges[slot - 1].end).then(|| slot - 1)
+    };
+
+    let is_64 = pe.is_64;
+    let refs: Vec<(usize, u64)> = instructions
+        .par_chunks(XREF_CHUNK)
+        .map_init(
+            || if is_64 { pe_disasm::build_capstone(true).ok() } else { None },
+            |cs, chunk| {
+                chunk
+                    .iter()
+                    .filter_map(|instr| {
+                        let target = if is_64 {
+                            rip_target(cs.as_ref()?, image, instr)?
+                        } else {
+                            absolute_target(instr)?.checked_sub(image_base)?
+                        };
+                        Some((table_at(target)?, instr.address))
+                    })
+                    .collect::<Vec<_>>()
+            },
+        )
+        .flat_map_iter(|refs| refs)
+        .collect();
+    for (table, rva) in refs {
+        hits[table].1.xrefs.push(image_base + rva);
+    }
+
+    hits.into_iter()
+        .map(|(_, mut hit)| {
+            hit.xrefs.sort_unstable();
+            hit.xrefs.dedup();
+            hit
+        })
+        .collect()
+}
+
+/// RVA addressed by a `[rip +/- disp]` operand of `instr`. The displacement
+/// is relative to the end of the instruction, which is not always where the
+/// displacement ends (`mov dword ptr [rip + X], imm`), so the instruction is
+/// re-decoded for its length.
+fn rip_target(cs: &Capstone, image: &LoadedImage, instr: &Instruction) -> Option<u64> {
+    let disp = (0..instr.operands.count())
+        .filter_map(|index| instr.operands.mem(index))
+        .find(|mem| mem.base.map_or(false, |base| base.class == RegClass::InstructionPointer))?
+        .disp;
+    let rva = instr.address;
+    let code = image.rva_bytes(rva as usize..rva as usize + MAX_INSN_LEN)?;
+    let decoded = cs.disasm_count(code, rva, 1).ok()?;
+    let len = decoded.iter().next()?.len() as u64;
+    Some((rva + len).wrapping_add(disp as u64))
+}
+
+/// VA addressed by `instr` in 32-bit code: the displacement of a memory
+/// operand without a base register (`[0x404000]`, `[ecx*4 + 0x404000]`),
+/// otherwise its immediate (`push 0x404000`)
+fn absolute_target(instr: &Instruction) -> Option<u64> {
+    (0..instr.operands.count())
+        .filter_map(|index| instr.operands.mem(index))
+        .find(|mem| mem.base.is_none())
+        .map(|mem| mem.disp as u64)
+        .or_else(|| instr.operands.imm())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_generated_tables() {
+        let sbox = aes_sbox();
+        assert_eq!(&sbox[..8], &[0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5]);
+        assert_eq!(sbox[0xff], 0x16);
+        let crc = crc32_table(0xedb8_8320, true);
+        assert_eq!(&crc[..3], &[0x0000_0000, 0x7707_3096, 0xee0e_612c]);
+        assert_eq!(crc32_table(0x04c1_1db7, false)[1], 0x04c1_1db7);
+        let te0 = &table_defs()[2];
+        assert_eq!(&te0.bytes[..4], &0xc66363a5u32.to_le_bytes());
+    }
+
+    #[test]
+    fn test_automaton_finds_embedded_table() {
+        let matcher = matcher();
+        let mut data = vec![0xccu8; 100];
+        data.extend(words_le(SHA256_K));
+        data.extend([0u8; 7]);
+        let found: Vec<_> = matcher.automaton.find_iter(&data).collect();
+        assert_eq!(found.len(), 1);
+        assert_eq!(found[0].start(), 100);
+        assert_eq!(matcher.defs[found[0].pattern().as_usize()].name, "SHA-256 K");
+    }
+
+    #[test]
+    fn test_scan_image_reports_references() {
+        use crate::pe_builder::PEBuilder;
+
+        // lea rax, [rip + X] at 0x1000, then mov dword ptr [rip + Y], 1 at
+        // 0x1007, whose displacement is followed by the immediate
+        let mut code = vec![0x48, 0x8d, 0x05, 0, 0, 0, 0];
+        code.extend([0xc7, 0x05, 0, 0, 0, 0, 0x01, 0, 0, 0]);
+        code.push(0xc3);
+        let mut builder = PEBuilder::new(true);
+        builder.add_code(code);
+        builder.add_data(words_le(SHA256_K));
+        let table = builder.data_rva() as u64;
+
+        // The lea takes the table's start, the mov its last word
+        let lea_disp = table as i64 - 0x1007;
+        let mov_disp = (table + 252) as i64 - 0x1011;
+        builder.code[3..7].copy_from_slice(&(lea_disp as i32).to_le_bytes());
+        builder.code[9..13].copy_from_slice(&(mov_disp as i32).to_le_bytes());
+        let path = std::env::temp_dir().join(format!("cataclysm-crypto-{}.exe", std::process::id()));
+        builder.build(&path).unwrap();
+        let image = LoadedImage::open(&path).unwrap();
+        let _ = std::fs::remove_file(&path);
+
+        let instructions = [
+            Instruction::new(0x1000, "lea", &format!("rax, [rip + {:#x}]", lea_disp)),
+            Instruction::new(0x1007, "mov", &format!("dword ptr [rip + {:#x}], 1", mov_disp)),
+            Instruction::new(0x1011, "ret", ""),
+        ];
+        let hits = scan_image(&image, &instructions);
+        assert_eq!(hits.len(), 1);
+        assert_eq!(hits[0].name, "SHA-256 K");
+        assert_eq!(hits[0].section, ".rdata");
+        assert_eq!(hits[0].va, builder.image_base + table);
+        assert_eq!(hits[0].xrefs, vec![builder.image_base + 0x1000, builder.image_base + 0x1007]);
+    }
+}
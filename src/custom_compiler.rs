@@ -1318,8 +1318,8 @@ fn try_builtin_assembler(source: &str, exe: &Path, start: &Instant) -> Compilati
                      ═══════════════════════════════════════════════════════════\n\
                      WHY DISASSEMBLY FAILED:\n\
                      ═══════════════════════════════════════════════════════════\n\
-                     The disassembler hit the 50,000 instruction limit while\n\
-                     processing NOPs, which means:\n\n\
+                     The disassembler spent most of its output on NOPs,\n\
+                     which means:\n\n\
                      1. It never reached the actual code section\n\
                      2. The entry point detection failed\n\
                      3. It's disassembling from the wrong address\n\
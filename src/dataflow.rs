@@ -0,0 +1,717 @@
+// ============================================================================
+// DATAFLOW: STACK FRAME, LIVENESS AND SSA
+// ============================================================================
+// Per-function dataflow over the CFG. The variables are the sixteen general
+// registers (by architectural number, so eax and rax are one variable) and
+// the stack slots the function touches. A slot is named by its offset from
+// the stack pointer at function entry, tracked through push/pop, rsp
+// adjustments and the frame pointer, so `[rbp - 4]` in an rbp frame and
+// `[rsp + 0x1c]` in an rsp frame resolve to the same slot.
+//
+// On top of that: register/slot liveness (bitsets per block), pruned SSA
+// (phis at the iterated dominance frontier where the variable is live), and
+// def-use chains. Every per-instruction and per-value list is a flat array
+// with an offset table, so a sparse pass walks a value's uses directly
+// instead of rescanning the function.
+// ============================================================================
+
+use std::collections::HashMap;
+use std::ops::Range;
+
+use crate::cfg::ControlFlowGraph;
+use crate::ir::{DestRole, FlowClass, Instruction, MemRef, Mnemonic, OperandKind, RegClass, Register};
+
+/// General registers are variables `0..GPR_COUNT`; stack slots follow
+const GPR_COUNT: usize = 16;
+const RAX: u32 = 0;
+const RDX: u32 = 2;
+const RSP: u8 = 4;
+const RBP: u8 = 5;
+/// Registers a call may overwrite (Win64 volatile set; a superset of the
+/// x86 one)
+const CALL_CLOBBERS: [u32; 7] = [0, 1, 2, 8, 9, 10, 11];
+/// Argument registers: rcx, rdx, r8, r9 on x64; ecx, edx (fastcall/thiscall)
+/// on x86
+const ARG_REGS_64: [u32; 4] = [1, 2, 8, 9];
+const ARG_REGS_32: [u32; 2] = [1, 2];
+
+const NONE: u32 = u32::MAX;
+/// Tag bit marking a use site as a phi operand rather than an instruction
+const PHI_USE: u32 = 1 << 31;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct StackSlot {
+    /// Offset from the stack pointer at function entry; the return address
+    /// is at 0, so arguments are above it and locals below
+    pub offset: i64,
+    /// Widest access seen, in bytes
+    pub width: u8,
+    /// Accessed through a vector register (float data)
+    pub vector: bool,
+    /// Accessed through a memory operand, not only by push/pop (register
+    /// saves)
+    pub explicit: bool,
+}
+
+impl StackSlot {
+    /// Above the return address: an incoming argument (or its home space)
+    pub fn is_param(&self) -> bool {
+        self.offset > 0
+    }
+}
+
+/// Where an SSA value is read
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+enum UseSite {
+    Instr(usize),
+    Phi(usize),
+}
+
+#[derive(Debug, Clone, Copy)]
+struct Phi {
+    var: u32,
+    value: usize,
+    /// Start of this phi's operands in `phi_args`, one per predecessor
+    args: u32,
+}
+
+/// Stack pointer and frame pointer as offsets from the entry stack pointer
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+struct FrameState {
+    rsp: Option<i64>,
+    rbp: Option<i64>,
+}
+
+/// Compressed per-item lists, same layout as the CFG's adjacency arrays
+#[derive(Debug, Clone, Default)]
+struct Lists {
+    offsets: Vec<u32>,
+    items: Vec<u32>,
+}
+
+impl Lists {
+    fn of(&self, i: usize) -> Range<usize> {
+        self.offsets[i] as usize..self.offsets[i + 1] as usize
+    }
+}
+
+#[derive(Debug, Clone, Default)]
+pub struct Dataflow {
+    /// Index of the function's first instruction; per-instruction arrays
+    /// are relative to it
+    base: usize,
+    ptr_size: i64,
+    frames: Vec<FrameState>,
+    slots: Vec<StackSlot>,
+    slot_ids: HashMap<i64, u32>,
+    /// Variables read / written by each instruction
+    uses: Lists,
+    defs: Lists,
+    /// SSA value read at each position of `uses`
+    use_values: Vec<u32>,
+    /// Live-in variables per block, `words` u64s each
+    live_in: Vec<u64>,
+    words: usize,
+    phis: Vec<Phi>,
+    phi_args: Vec<u32>,
+    /// First phi of each block (phis are sorted by block)
+    phi_offsets: Vec<u32>,
+    /// Variable of each SSA value. Value `v < var_count` is variable `v`'s
+    /// entry value.
+    value_vars: Vec<u32>,
+    /// Use sites of each value (`PHI_USE`-tagged for phi operands)
+    value_uses: Lists,
+}
+
+impl Dataflow {
+    /// Analyse the function whose blocks are `blocks` (index ranges into
+    /// `instructions`, in address order, numbered like `cfg`'s nodes)
+    pub fn analyze(instructions: &[Instruction], blocks: &[Range<usize>], cfg: &ControlFlowGraph) -> Dataflow {
+        let (Some(first), Some(last)) = (blocks.first(), blocks.last()) else {
+            return Dataflow::default();
+        };
+        let body = first.start..last.end;
+        let mut df = Dataflow {
+            base: body.start,
+            ptr_size: pointer_size(&instructions[body.clone()]),
+            ..Dataflow::default()
+        };
+
+        df.track_frames(instructions, blocks, cfg);
+        df.collect_accesses(&instructions[body]);
+        df.compute_liveness(blocks, cfg);
+        df.place_phis(blocks, cfg);
+        df.rename(blocks, cfg);
+        df.link_uses();
+        df
+    }
+
+    pub fn slots(&self) -> &[StackSlot] {
+        &self.slots
+    }
+
+    /// Stack slot the `operand`-th operand of `instructions[instr]` refers to
+    pub fn slot_of(&self, instructions: &[Instruction], instr: usize, operand: usize) -> Option<usize> {
+        let frame = *self.frames.get(instr.checked_sub(self.base)?)?;
+        let offset = slot_offset(&instructions[instr].operands.mem(operand)?, frame)?;
+        self.slot_ids.get(&offset).map(|&id| id as usize - GPR_COUNT)
+    }
+
+    /// Argument registers whose entry value is read for something other
+    /// than being saved (`push`) or returned, each as the register spelled
+    /// at its first such read
+    pub fn register_params(&self, instructions: &[Instruction]) -> Vec<Register> {
+        let candidates: &[u32] = if self.ptr_size == 8 { &ARG_REGS_64 } else { &ARG_REGS_32 };
+        let mut params = Vec::new();
+        for &var in candidates {
+            if var as usize >= self.value_vars.len() {
+                continue;
+            }
+            let first_read = self.uses_of(var as usize).find_map(|site| match site {
+                UseSite::Instr(i) => {
+                    let instr = &instructions[i];
+                    if instr.mnemonic == Mnemonic::PUSH || instr.mnemonic.info().flow == FlowClass::Return {
+                        return None;
+                    }
+                    (0..instr.operands.count())
+                        .filter_map(|k| instr.operands.reg(k))
+                        .find(|reg| reg.class == RegClass::General && reg.number as u32 == var)
+                }
+                UseSite::Phi(_) => None,
+            });
+            params.extend(first_read);
+        }
+        params
+    }
+
+    fn uses_of(&self, value: usize) -> impl Iterator<Item = UseSite> + '_ {
+        self.value_uses.items[self.value_uses.of(value)].iter().map(move |&site| {
+            if site & PHI_USE != 0 {
+                UseSite::Phi((site & !PHI_USE) as usize)
+            } else {
+                UseSite::Instr(site as usize + self.base)
+            }
+        })
+    }
+
+    fn var_count(&self) -> usize {
+        GPR_COUNT + self.slots.len()
+    }
+
+    /// Frame state before each instruction, propagated in reverse postorder
+    /// from the entry (rsp at offset 0, no frame pointer). A block takes the
+    /// state of the first predecessor that reaches it.
+    fn track_frames(&mut self, instructions: &[Instruction], blocks: &[Range<usize>], cfg: &ControlFlowGraph) {
+        let len = blocks[blocks.len() - 1].end - self.base;
+        self.frames = vec![FrameState::default(); len];
+
+        let mut entry: Vec<Option<FrameState>> = vec![None; blocks.len()];
+        entry[0] = Some(FrameState { rsp: Some(0), rbp: None });
+        for b in cfg.reverse_postorder() {
+            let mut state = entry[b].unwrap_or_default();
+            for i in blocks[b].clone() {
+                self.frames[i - self.base] = state;
+                state = step_frame(state, &instructions[i], self.ptr_size);
+            }
+            for s in cfg.successors(b) {
+                entry[s].get_or_insert(state);
+            }
+        }
+    }
+
+    fn slot(&mut self, offset: i64) -> u32 {
+        let next = (GPR_COUNT + self.slots.len()) as u32;
+        let id = *self.slot_ids.entry(offset).or_insert(next);
+        if id == next {
+            self.slots.push(StackSlot { offset, width: 0, vector: false, explicit: false });
+        }
+        id
+    }
+
+    /// Registers and slots each instruction reads and writes
+    fn collect_accesses(&mut self, body: &[Instruction]) {
+        let mut uses = Lists { offsets: Vec::with_capacity(body.len() + 1), items: Vec::new() };
+        let mut defs = Lists { offsets: Vec::with_capacity(body.len() + 1), items: Vec::new() };
+        uses.offsets.push(0);
+        defs.offsets.push(0);
+
+        for (i, instr) in body.iter().enumerate() {
+            let frame = self.frames[i];
+            let ops = &instr.operands;
+            let info = instr.mnemonic.info();
+            let m = instr.mnemonic;
+            let zero_idiom = (m == Mnemonic::XOR || m == Mnemonic::SUB) && ops.count() == 2 && ops.get(0) == ops.get(1);
+            let other_reg = (0..ops.count()).filter_map(|k| ops.reg(k)).next();
+
+            for k in 0..ops.count() {
+                let (reads, writes) = match (k, info.dest) {
+                    (0, _) if zero_idiom => (false, true),
+                    (_, _) if zero_idiom => (false, false),
+                    (0, DestRole::Write) => (false, true),
+                    (0, DestRole::ReadWrite) => (true, true),
+                    _ => (true, false),
+                };
+                match ops.kind(k) {
+                    OperandKind::Reg => {
+                        if let Some(reg) = ops.reg(k).filter(|r| r.class == RegClass::General) {
+                            if reads {
+                                uses.items.push(reg.number as u32);
+                            }
+                            if writes {
+                                defs.items.push(reg.number as u32);
+                            }
+                        }
+                    }
+                    OperandKind::Mem => {
+                        let Some(mem) = ops.mem(k) else { continue };
+                        // Address registers are read whatever the access
+                        for reg in [mem.base, mem.index].into_iter().flatten() {
+                            if reg.class == RegClass::General {
+                                uses.items.push(reg.number as u32);
+                            }
+                        }
+                        if m == Mnemonic::LEA {
+                            continue;
+                        }
+                        if let Some(offset) = slot_offset(&mem, frame) {
+                            let id = self.slot(offset);
+                            let slot = &mut self.slots[id as usize - GPR_COUNT];
+                            let width = if mem.width != 0 { mem.width } else { other_reg.map_or(0, |r| r.width) };
+                            slot.width = slot.width.max(width);
+                            slot.vector |= other_reg.is_some_and(|r| r.class == RegClass::Vector);
+                            slot.explicit = true;
+                            if reads {
+                                uses.items.push(id);
+                            }
+                            if writes {
+                                defs.items.push(id);
+                            }
+                        }
+                    }
+                    _ => {}
+                }
+            }
+
+            // Implicit operands
+            let rsp = RSP as u32;
+            match m {
+                Mnemonic::PUSH => {
+                    let width = push_width(instr, self.ptr_size);
+                    uses.items.push(rsp);
+                    defs.items.push(rsp);
+                    if let Some(top) = frame.rsp {
+                        let id = self.slot(top - width);
+                        let slot = &mut self.slots[id as usize - GPR_COUNT];
+                        slot.width = slot.width.max(width as u8);
+                        defs.items.push(id);
+                    }
+                }
+                Mnemonic::POP => {
+                    uses.items.push(rsp);
+                    defs.items.push(rsp);
+                    if let Some(top) = frame.rsp {
+                        uses.items.push(self.slot(top));
+                    }
+                }
+                Mnemonic::CALL | Mnemonic::LCALL => {
+                    uses.items.push(rsp);
+                    defs.items.extend(CALL_CLOBBERS);
+                }
+                Mnemonic::LEAVE => {
+                    uses.items.push(RBP as u32);
+                    defs.items.extend([rsp, RBP as u32]);
+                }
+                Mnemonic::MUL | Mnemonic::IMUL | Mnemonic::DIV | Mnemonic::IDIV if ops.count() == 1 => {
+                    uses.items.extend([RAX, RDX]);
+                    defs.items.extend([RAX, RDX]);
+                }
+                Mnemonic::CDQ | Mnemonic::CQO => {
+                    uses.items.push(RAX);
+                    defs.items.push(RDX);
+                }
+                _ if info.flow == FlowClass::Return => {
+                    uses.items.extend([RAX, rsp]);
+                }
+                _ => {}
+            }
+
+            uses.offsets.push(uses.items.len() as u32);
+            defs.offsets.push(defs.items.len() as u32);
+        }
+
+        self.uses = uses;
+        self.defs = defs;
+    }
+
+    /// Backward dataflow to a fixpoint: in = use ∪ (out − def)
+    fn compute_liveness(&mut self, blocks: &[Range<usize>], cfg: &ControlFlowGraph) {
+        let words = self.var_count().div_ceil(64);
+        let n = blocks.len();
+        let mut gen = vec![0u64; n * words];
+        let mut kill = vec![0u64; n * words];
+        let set = |bits: &mut [u64], b: usize, v: u32| bits[b * words + v as usize / 64] |= 1 << (v % 64);
+        let get = |bits: &[u64], b: usize, v: u32| bits[b * words + v as usize / 64] & (1 << (v % 64)) != 0;
+
+        for (b, range) in blocks.iter().enumerate() {
+            for i in range.start - self.base..range.end - self.base {
+                for &v in &self.uses.items[self.uses.of(i)] {
+                    if !get(&kill, b, v) {
+                        set(&mut gen, b, v);
+                    }
+                }
+                for &v in &self.defs.items[self.defs.of(i)] {
+                    set(&mut kill, b, v);
+                }
+            }
+        }
+
+        let mut live_in = gen.clone();
+        let mut out = vec![0u64; words];
+        let mut changed = true;
+        while changed {
+            changed = false;
+            for b in (0..n).rev() {
+                out.fill(0);
+                for s in cfg.successors(b) {
+                    for w in 0..words {
+                        out[w] |= live_in[s * words + w];
+                    }
+                }
+                for w in 0..words {
+                    let value = gen[b * words + w] | (out[w] & !kill[b * words + w]);
+                    if value != live_in[b * words + w] {
+                        live_in[b * words + w] = value;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        self.live_in = live_in;
+        self.words = words;
+    }
+
+    /// Pruned SSA: a phi for `v` goes at each block of the iterated
+    /// dominance frontier of `v`'s definitions where `v` is live-in
+    fn place_phis(&mut self, blocks: &[Range<usize>], cfg: &ControlFlowGraph) {
+        let n = blocks.len();
+        let frontier = dominance_frontiers(cfg);
+
+        // Blocks defining each variable
+        let var_count = self.var_count();
+        let mut def_blocks: Vec<Vec<u32>> = vec![Vec::new(); var_count];
+        for (b, range) in blocks.iter().enumerate() {
+            for i in range.start - self.base..range.end - self.base {
+                for &v in &self.defs.items[self.defs.of(i)] {
+                    if def_blocks[v as usize].last() != Some(&(b as u32)) {
+                        def_blocks[v as usize].push(b as u32);
+                    }
+                }
+            }
+        }
+
+        // Stamps avoid clearing per-block markers between variables
+        let mut has_phi = vec![NONE; n];
+        let mut queued = vec![NONE; n];
+        let mut worklist = Vec::new();
+        let mut placed: Vec<(u32, u32)> = Vec::new();
+        for (v, defs) in def_blocks.iter().enumerate() {
+            let stamp = v as u32;
+            for &b in defs {
+                queued[b as usize] = stamp;
+                worklist.push(b);
+            }
+            while let Some(b) = worklist.pop() {
+                for &y in &frontier[b as usize] {
+                    let live = self.live_in[y as usize * self.words + v / 64] & (1 << (v % 64)) != 0;
+                    if has_phi[y as usize] == stamp || !live {
+                        continue;
+                    }
+                    has_phi[y as usize] = stamp;
+                    placed.push((y, stamp));
+                    if queued[y as usize] != stamp {
+                        queued[y as usize] = stamp;
+                        worklist.push(y);
+                    }
+                }
+            }
+        }
+
+        placed.sort_unstable();
+        self.value_vars = (0..var_count as u32).collect();
+        self.phi_offsets = vec![0; n + 1];
+        for &(block, var) in &placed {
+            let value = self.value_vars.len();
+            self.value_vars.push(var);
+            self.phi_offsets[block as usize + 1] += 1;
+            self.phis.push(Phi { var, value, args: self.phi_args.len() as u32 });
+            self.phi_args.extend(std::iter::repeat(NONE).take(cfg.predecessors(block as usize).count()));
+        }
+        for b in 0..n {
+            self.phi_offsets[b + 1] += self.phi_offsets[b];
+        }
+    }
+
+    /// Walk the dominator tree keeping a stack of current values per
+    /// variable; entry values sit at the bottom of each stack
+    fn rename(&mut self, blocks: &[Range<usize>], cfg: &ControlFlowGraph) {
+        enum Step {
+            Enter(usize),
+            Leave(usize),
+        }
+
+        let mut stacks: Vec<Vec<u32>> = (0..self.var_count() as u32).map(|v| vec![v]).collect();
+        let mut pushed: Vec<u32> = Vec::new();
+        self.use_values = vec![NONE; self.uses.items.len()];
+
+        let mut work = if blocks.is_empty() { Vec::new() } else { vec![Step::Enter(0)] };
+        while let Some(step) = work.pop() {
+            let b = match step {
+                Step::Leave(mark) => {
+                    while pushed.len() > mark {
+                        let v = pushed.pop().unwrap();
+                        stacks[v as usize].pop();
+                    }
+                    continue;
+                }
+                Step::Enter(b) => b,
+            };
+            work.push(Step::Leave(pushed.len()));
+
+            for phi in &self.phis[self.phi_offsets[b] as usize..self.phi_offsets[b + 1] as usize] {
+                stacks[phi.var as usize].push(phi.value as u32);
+                pushed.push(phi.var);
+            }
+            for i in blocks[b].start - self.base..blocks[b].end - self.base {
+                for k in self.uses.of(i) {
+                    self.use_values[k] = *stacks[self.uses.items[k] as usize].last().unwrap();
+                }
+                for k in self.defs.of(i) {
+                    let var = self.defs.items[k];
+                    let value = self.value_vars.len() as u32;
+                    self.value_vars.push(var);
+                    stacks[var as usize].push(value);
+                    pushed.push(var);
+                }
+            }
+            for s in cfg.successors(b) {
+                let Some(position) = cfg.predecessors(s).position(|p| p == b) else { continue };
+                for phi in &self.phis[self.phi_offsets[s] as usize..self.phi_offsets[s + 1] as usize] {
+                    self.phi_args[phi.args as usize + position] = *stacks[phi.var as usize].last().unwrap();
+                }
+            }
+
+            work.extend(cfg.dom_children(b).map(Step::Enter));
+        }
+    }
+
+    /// Invert the per-instruction and per-phi value reads into per-value
+    /// use lists
+    fn link_uses(&mut self) {
+        let mut sites: Vec<(u32, u32)> = Vec::with_capacity(self.use_values.len() + self.phi_args.len());
+        for i in 0..self.uses.offsets.len().saturating_sub(1) {
+            for k in self.uses.of(i) {
+                if self.use_values[k] != NONE {
+                    sites.push((self.use_values[k], i as u32));
+                }
+            }
+        }
+        for (p, phi) in self.phis.iter().enumerate() {
+            // Operand runs are laid out in phi order
+            let end = self.phis.get(p + 1).map_or(self.phi_args.len(), |next| next.args as usize);
+            for &value in &self.phi_args[phi.args as usize..end] {
+                if value != NONE {
+                    sites.push((value, p as u32 | PHI_USE));
+                }
+            }
+        }
+
+        let mut offsets = vec![0u32; self.value_vars.len() + 1];
+        for &(value, _) in &sites {
+            offsets[value as usize + 1] += 1;
+        }
+        for v in 0..self.value_vars.len() {
+            offsets[v + 1] += offsets[v];
+        }
+        let mut fill = offsets.clone();
+        let mut items = vec![0u32; sites.len()];
+        for &(value, site) in &sites {
+            items[fill[value as usize] as usize] = site;
+            fill[value as usize] += 1;
+        }
+        self.value_uses = Lists { offsets, items };
+    }
+}
+
+/// 8 when the function uses any 64-bit general register, else 4
+fn pointer_size(body: &[Instruction]) -> i64 {
+    let is_64 = |reg: Option<Register>| reg.is_some_and(|r| r.class == RegClass::General && r.width == 8);
+    let wide = body.iter().any(|instr| {
+        (0..instr.operands.count()).any(|k| is_64(instr.operands.reg(k)) || is_64(instr.operands.mem(k).and_then(|m| m.base)))
+    });
+    if wide { 8 } else { 4 }
+}
+
+fn push_width(instr: &Instruction, ptr_size: i64) -> i64 {
+    match instr.operands.reg(0) {
+        Some(reg) if reg.class == RegClass::General => reg.width as i64,
+        _ => ptr_size,
+    }
+}
+
+fn is_reg(reg: Option<Register>, number: u8) -> bool {
+    reg.is_some_and(|r| r.class == RegClass::General && r.number == number && r.width >= 4)
+}
+
+/// Literal second operand (`sub rsp, 0x28`, `add esp, 16`)
+fn immediate(instr: &Instruction, index: usize) -> Option<i64> {
+    if instr.operands.kind(index) != OperandKind::Imm {
+        return None;
+    }
+    let text = instr.operands.get(index)?;
+    match text.strip_prefix("0x") {
+        Some(hex) => i64::from_str_radix(hex, 16).ok(),
+        None => text.parse().ok(),
+    }
+}
+
+fn step_frame(mut state: FrameState, instr: &Instruction, ptr_size: i64) -> FrameState {
+    let ops = &instr.operands;
+    let (dest, src) = (ops.reg(0), ops.reg(1));
+    match instr.mnemonic {
+        Mnemonic::PUSH => state.rsp = state.rsp.map(|sp| sp - push_width(instr, ptr_size)),
+        Mnemonic::POP => {
+            if is_reg(dest, RBP) {
+                state.rbp = None;
+            }
+            state.rsp = state.rsp.map(|sp| sp + push_width(instr, ptr_size));
+        }
+        Mnemonic::SUB | Mnemonic::ADD if is_reg(dest, RSP) => {
+            let sign = if instr.mnemonic == Mnemonic::SUB { -1 } else { 1 };
+            state.rsp = state.rsp.zip(immediate(instr, 1)).map(|(sp, n)| sp + sign * n);
+        }
+        Mnemonic::MOV if is_reg(dest, RBP) && is_reg(src, RSP) => state.rbp = state.rsp,
+        Mnemonic::MOV if is_reg(dest, RSP) && is_reg(src, RBP) => state.rsp = state.rbp,
+        Mnemonic::LEA if is_reg(dest, RSP) || is_reg(dest, RBP) => {
+            let target = ops.mem(1).and_then(|mem| slot_offset(&mem, state));
+            if is_reg(dest, RSP) { state.rsp = target } else { state.rbp = target }
+        }
+        Mnemonic::LEAVE => {
+            state.rsp = state.rbp.map(|bp| bp + ptr_size);
+            state.rbp = None;
+        }
+        _ if instr.mnemonic.info().dest != DestRole::Read => {
+            if is_reg(dest, RSP) {
+                state.rsp = None;
+            } else if is_reg(dest, RBP) {
+                state.rbp = None;
+            }
+        }
+        _ => {}
+    }
+    state
+}
+
+/// Entry-relative offset of `[rsp + d]` / `[rbp + d]` when that base
+/// register's value is known
+fn slot_offset(mem: &MemRef, frame: FrameState) -> Option<i64> {
+    if mem.index.is_some() {
+        return None;
+    }
+    let base = mem.base?;
+    if base.is_stack_pointer() {
+        frame.rsp.map(|sp| sp + mem.disp)
+    } else if base.is_frame_pointer() {
+        frame.rbp.map(|bp| bp + mem.disp)
+    } else {
+        None
+    }
+}
+
+/// Cooper/Harvey/Kennedy: walk up from each predecessor of a join point to
+/// its immediate dominator
+fn dominance_frontiers(cfg: &ControlFlowGraph) -> Vec<Vec<u32>> {
+    let mut frontier: Vec<Vec<u32>> = vec![Vec::new(); cfg.len()];
+    for b in 0..cfg.len() {
+        let Some(idom) = cfg.idom(b) else { continue };
+        if cfg.predecessors(b).nth(1).is_none() {
+            continue;
+        }
+        for p in cfg.predecessors(b) {
+            let mut runner = p;
+            while runner != idom && cfg.is_reachable(runner) {
+                if frontier[runner].last() != Some(&(b as u32)) {
+                    frontier[runner].push(b as u32);
+                }
+                match cfg.idom(runner) {
+                    Some(up) => runner = up,
+                    None => break,
+                }
+            }
+        }
+    }
+    frontier
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn function(lines: &[(u64, &str, &str)], blocks: &[Range<usize>]) -> (Vec<Instruction>, ControlFlowGraph, Dataflow) {
+        let instructions: Vec<Instruction> =
+            lines.iter().map(|&(address, mnemonic, operands)| Instruction::new(address, mnemonic, operands)).collect();
+        let cfg = ControlFlowGraph::build(&instructions, blocks);
+        let df = Dataflow::analyze(&instructions, blocks, &cfg);
+        (instructions, cfg, df)
+    }
+
+    #[test]
+    fn test_both_frame_styles_share_slots() {
+        let (rbp_code, _, rbp_frame) = function(&[
+            (0x00, "push", "rbp"),
+            (0x01, "mov", "rbp, rsp"),
+            (0x04, "mov", "dword ptr [rbp - 4], ecx"),
+            (0x07, "mov", "eax, dword ptr [rbp - 4]"),
+            (0x0a, "pop", "rbp"),
+            (0x0b, "ret", ""),
+        ], &[0..6]);
+        let (rsp_code, _, rsp_frame) = function(&[
+            (0x00, "sub", "rsp, 0x28"),
+            (0x04, "mov", "dword ptr [rsp + 0x1c], ecx"),
+            (0x08, "mov", "eax, dword ptr [rsp + 0x1c]"),
+            (0x0c, "add", "rsp, 0x28"),
+            (0x10, "ret", ""),
+        ], &[0..5]);
+
+        let explicit = |df: &Dataflow| df.slots().iter().filter(|s| s.explicit).map(|s| (s.offset, s.width)).collect::<Vec<_>>();
+        assert_eq!(explicit(&rbp_frame), vec![(-12, 4)]);
+        assert_eq!(explicit(&rsp_frame), vec![(-12, 4)]);
+        assert_eq!(rbp_frame.slot_of(&rbp_code, 3, 1), rbp_frame.slot_of(&rbp_code, 2, 0));
+        assert!(rsp_frame.slot_of(&rsp_code, 1, 0).is_some());
+
+        // ecx is read before any write, rax is written before the return
+        let ecx = Register::parse("ecx").unwrap();
+        assert_eq!(rbp_frame.register_params(&rbp_code), vec![ecx]);
+        assert_eq!(rsp_frame.register_params(&rsp_code), vec![ecx]);
+    }
+
+    #[test]
+    fn test_phi_at_join_carries_entry_value() {
+        let (code, _, df) = function(&[
+            (0x00, "test", "edx, edx"),
+            (0x02, "je", "0x09"),
+            (0x04, "mov", "ecx, 1"),
+            (0x09, "mov", "eax, ecx"),
+            (0x0b, "ret", ""),
+        ], &[0..2, 2..3, 3..5]);
+
+        // ecx's entry value only reaches the join through a phi, and the phi
+        // is what the copy reads
+        assert_eq!(df.phis.len(), 1);
+        assert_eq!(df.uses_of(1).collect::<Vec<_>>(), vec![UseSite::Phi(0)]);
+        assert!(df.uses_of(df.phis[0].value).any(|site| site == UseSite::Instr(3)));
+
+        // so only edx counts as a register parameter
+        assert_eq!(df.register_params(&code), vec![Register::parse("edx").unwrap()]);
+    }
+}
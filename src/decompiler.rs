@@ -1,20 +1,23 @@
-use regex::Regex;
-use std::collections::{HashMap, HashSet};
+use rayon::prelude::*;
+use std::borrow::Cow;
+use std::collections::{BTreeMap, HashMap, HashSet};
 use goblin::pe::PE;
-use std::fs;
-use std::sync::OnceLock;
+use std::ops::{Deref, Range};
+use std::path::Path;
+use std::sync::{Arc, OnceLock};
+use std::time::{Duration, Instant};
 
+use crate::analysis_cache::{AnalysisCache, CachedBlock, CachedFunction, CachedVariable, FunctionKey};
 use crate::anti_obfuscation;
+use crate::cfg::ControlFlowGraph;
+use crate::dataflow::Dataflow;
+use crate::crypto_tables::{self, TableFamily, TableHit};
+use crate::ir::{Condition, FlowClass, Mnemonic, Operands, RegClass};
+pub use crate::ir::Instruction;
+use crate::pe_disasm;
+use crate::pe_image::{self, FunctionIndex, LoadedImage};
 use crate::windows_api_db;
 
-#[derive(Debug, Clone)]
-pub struct Instruction {
-    pub address: u64,
-    pub mnemonic: String,
-    pub operands: String,
-    pub raw_line: String,
-}
-
 #[derive(Debug, Clone, PartialEq)]
 enum VarType {
     Int32,
@@ -41,13 +44,52 @@ struct Variable {
     size: usize,
 }
 
+/// Recovered variables by name, plus the operand spellings that refer to
+/// each stack slot (`dword ptr [rbp - 4]`, `dword ptr [rsp + 0x1c]`), so the
+/// renderers can name an operand without redoing the frame analysis.
+/// Variables are kept in name order so every render (and every cached
+/// entry) lists them the same way.
+#[derive(Debug, Clone, Default)]
+struct FrameVariables {
+    vars: BTreeMap<String, Variable>,
+    aliases: HashMap<String, String>,
+}
+
+impl FrameVariables {
+    fn alias(&self, operand: &str) -> Option<&str> {
+        self.aliases.get(operand).map(String::as_str)
+    }
+}
+
+impl Deref for FrameVariables {
+    type Target = BTreeMap<String, Variable>;
+
+    fn deref(&self) -> &BTreeMap<String, Variable> {
+        &self.vars
+    }
+}
+
+impl<'a> IntoIterator for &'a FrameVariables {
+    type Item = (&'a String, &'a Variable);
+    type IntoIter = std::collections::btree_map::Iter<'a, String, Variable>;
+
+    fn into_iter(self) -> Self::IntoIter {
+        self.vars.iter()
+    }
+}
+
+/// A block references its instructions by index range into the instruction
+/// slice the function was recovered from; it owns no copies.
 #[derive(Debug, Clone)]
 struct BasicBlock {
     start_addr: u64,
-    end_addr: u64,
-    instructions: Vec<Instruction>,
-    successors: Vec<u64>,
-    predecessors: Vec<u64>,
+    range: Range<usize>,
+}
+
+impl BasicBlock {
+    fn instructions<'a>(&self, instructions: &'a [Instruction]) -> &'a [Instruction] {
+        &instructions[self.range.clone()]
+    }
 }
 
 #[derive(Debug, Clone)]
@@ -56,7 +98,9 @@ struct Function {
     start_addr: u64,
     end_addr: u64,
     blocks: Vec<BasicBlock>,
-    variables: HashMap<String, Variable>,
+    /// Edges, dominators and loops over `blocks` (block `i` is node `i`)
+    cfg: ControlFlowGraph,
+    variables: FrameVariables,
     is_api_call: bool,
     parameters: Vec<Variable>,
     return_type: VarType,
@@ -155,6 +199,23 @@ pub struct PEInfo {
     pub exports: HashMap<u64, String>,
     #[allow(dead_code)]
     pub iat_range: Option<(u64, u64)>,
+    /// x64 `.pdata` function boundaries (RVAs); empty when there are none
+    pub functions: FunctionIndex,
+    /// The mapped file this info was read from, when there is one; lets the
+    /// passes scan section bytes
+    pub image: Option<Arc<LoadedImage>>,
+}
+
+impl PEInfo {
+    /// RVAs where code starts without a branch leading there: the entry
+    /// point, the exports and the `.pdata` function starts - the roots the
+    /// disassembler traces from
+    fn code_roots(&self) -> Vec<u64> {
+        let mut roots = vec![self.entry_point - self.image_base];
+        roots.extend(self.exports.keys().map(|&va| va - self.image_base));
+        roots.extend(self.functions.ranges().iter().map(|range| range.start));
+        roots
+    }
 }
 
 #[derive(Debug, Clone)]
@@ -239,66 +300,444 @@ struct CryptoPattern {
 
 
 
-pub fn translate_to_pseudo(asm: &str) -> String {
-    translate_to_pseudo_with_pe(asm, None)
+// ============================================================================
+// TYPED PIPELINE
+// ============================================================================
+
+/// A decoded binary ready for the translators: the typed instruction stream
+/// produced by Capstone plus the PE metadata parsed from the same buffer.
+/// Text is only produced at the edges (`listing()` and the `to_*` renderers).
+pub struct Analysis {
+    pub pe_info: PEInfo,
+    pub disassembly: pe_disasm::Disassembly,
+    /// The mapped file this analysis was decoded from, when there is one
+    pub image: Option<Arc<LoadedImage>>,
+    /// Per-function results of earlier runs, reused for every function whose
+    /// key still matches
+    pub cache: Option<AnalysisCache>,
 }
 
-pub fn translate_to_pseudo_with_pe(asm: &str, pe_path: Option<&str>) -> String {
-    let pe_info = pe_path.and_then(|path| parse_pe_file(path));
-    let original_instructions = parse_instructions(asm);
-    let original_count = original_instructions.len();
-    let mut instructions = original_instructions;
-    
-    // Only filter junk if we have a reasonable number of instructions (performance optimization)
-    // Reduced threshold from 10000 to 5000 for better performance
-    let should_filter = instructions.len() < 5000;
-    
-    let (deobf_result, junk_removed) = if should_filter {
-        let before_junk = instructions.len();
-        // Filter junk instructions
-        instructions = filter_junk_instructions(&instructions);
-        let after_junk = instructions.len();
-        let junk_count = before_junk - after_junk;
-        
-        // NEW v4.0: Anti-obfuscation layer
-        let obf_instructions: Vec<anti_obfuscation::Instruction> = instructions.iter().map(|inst| {
-            anti_obfuscation::Instruction {
-                address: inst.address,
-                mnemonic: inst.mnemonic.clone(),
-                operands: inst.operands.clone(),
-                raw_line: inst.raw_line.clone(),
+impl Analysis {
+    /// Assembly listing for display and `_full.asm`
+    pub fn listing(&self) -> String {
+        pe_disasm::render_listing(&self.disassembly)
+    }
+
+    /// Run the shared analysis passes once; render as many outputs as needed
+    /// from the returned session.
+    pub fn session(&self) -> AnalysisSession<'_> {
+        AnalysisSession::with_cache(&self.disassembly.instructions, Some(&self.pe_info), self.cache.as_ref())
+    }
+
+    pub fn to_pseudo(&self) -> String {
+        let session = self.session();
+        let output = session.render_pseudo();
+        session.persist();
+        output
+    }
+
+    pub fn to_c(&self) -> String {
+        let session = self.session();
+        let output = session.render_c();
+        session.persist();
+        output
+    }
+
+    pub fn to_rust(&self) -> String {
+        let session = self.session();
+        let output = session.render_rust();
+        session.persist();
+        output
+    }
+}
+
+/// Parse and disassemble a PE image held in memory. Instructions go straight
+/// from Capstone into the analysis passes without a text round-trip.
+pub fn decompile_binary(buffer: &[u8]) -> Result<Analysis, String> {
+    let pe = pe_image::parse_pe(buffer)?;
+    let disassembly = pe_disasm::disassemble_pe(buffer, &pe)?;
+    Ok(Analysis {
+        pe_info: pe_info_from(&pe),
+        disassembly,
+        image: None,
+        cache: None,
+    })
+}
+
+/// Same as `decompile_binary`, but reuses an already mapped and parsed image
+/// and keeps a handle to it for later consumers (PE report, relocator).
+pub fn decompile_image(image: &Arc<LoadedImage>) -> Result<Analysis, String> {
+    let disassembly = pe_disasm::disassemble_pe(image.bytes(), image.pe())?;
+    Ok(Analysis {
+        pe_info: PEInfo { image: Some(Arc::clone(image)), ..pe_info_from(image.pe()) },
+        disassembly,
+        image: Some(Arc::clone(image)),
+        cache: AnalysisCache::configured(),
+    })
+}
+
+/// Everything the pseudo, C and Rust backends need, computed once: the
+/// junk-filter/deobfuscation/crypto passes, function recovery and API
+/// detection. The backends only read from it, so they can render
+/// concurrently (`render_all`).
+pub struct AnalysisSession<'a> {
+    original_count: usize,
+    pe_info: Option<&'a PEInfo>,
+    passes: PassOutput,
+    functions: Vec<SessionFunction>,
+    cache: Option<&'a AnalysisCache>,
+    api_calls: HashMap<String, String>,
+    // Only the C and Rust backends use this, so it is filled on first use
+    // unless the caller already has it (text input)
+    detected_apis: OnceLock<Vec<String>>,
+}
+
+impl<'a> AnalysisSession<'a> {
+    pub fn new(original_instructions: &'a [Instruction], pe_info: Option<&'a PEInfo>) -> Self {
+        Self::with_cache(original_instructions, pe_info, None)
+    }
+
+    /// Session that takes every function whose `cache` key (`function_key`)
+    /// still matches from the cache and analyses only the rest
+    fn with_cache(original_instructions: &'a [Instruction], pe_info: Option<&'a PEInfo>, cache: Option<&'a AnalysisCache>) -> Self {
+        let passes = run_analysis_passes(original_instructions, pe_info);
+        let instructions = &passes.instructions;
+        let index = pe_info.map(|pe| &pe.functions);
+        let image = pe_info.and_then(|pe| pe.image.as_deref());
+        let functions = function_spans(instructions, index)
+            .into_par_iter()
+            .map(|(name, span)| {
+                let key = cache.map(|_| function_key(image, &name, instructions, &span, index));
+                let start_addr = instructions[span.start].address;
+                let cached = key
+                    .and_then(|key| cache?.load(&key))
+                    .filter(|entry| entry.start_addr == start_addr && entry.name == name);
+                // Cache hits are only analysed if a backend they lack is asked for
+                let func = OnceLock::new();
+                if cached.is_none() {
+                    let _ = func.set(analyze_function(name.clone(), instructions, span.clone(), index));
+                }
+                SessionFunction { name, span, key, cached, func, rendered: Default::default() }
+            })
+            .collect();
+        let api_calls = detect_api_calls(&passes.instructions);
+        AnalysisSession {
+            original_count: original_instructions.len(),
+            pe_info,
+            passes,
+            functions,
+            cache,
+            api_calls,
+            detected_apis: OnceLock::new(),
+        }
+    }
+
+    /// Session for text input, where API names are detected from the source text
+    fn with_detected_apis(original_instructions: &'a [Instruction], pe_info: Option<&'a PEInfo>, detected_apis: Vec<String>) -> Self {
+        let session = Self::new(original_instructions, pe_info);
+        let _ = session.detected_apis.set(detected_apis);
+        session
+    }
+
+    fn detected_apis(&self) -> &[String] {
+        self.detected_apis.get_or_init(|| detect_windows_apis(&self.passes.instructions))
+    }
+
+    /// Render one backend. Call `persist` once after the last render to
+    /// store what was rendered.
+    pub fn render_pseudo(&self) -> String {
+        render_pseudo(self)
+    }
+
+    pub fn render_c(&self) -> String {
+        render_c(self)
+    }
+
+    pub fn render_rust(&self) -> String {
+        render_rust(self)
+    }
+
+    /// Render pseudo-code, C and Rust on separate threads.
+    pub fn render_all(&self) -> (String, String, String) {
+        let outputs = std::thread::scope(|scope| {
+            let pseudo = scope.spawn(|| self.render_pseudo());
+            let c = scope.spawn(|| self.render_c());
+            let rust = self.render_rust();
+            (
+                pseudo.join().expect("pseudo-code renderer panicked"),
+                c.join().expect("C renderer panicked"),
+                rust,
+            )
+        });
+        self.persist();
+        outputs
+    }
+
+    fn index(&self) -> Option<&'a FunctionIndex> {
+        self.pe_info.map(|pe| &pe.functions)
+    }
+
+    /// Store what this session rendered in the cache: a new entry for each
+    /// analysed function, or the backends an existing entry lacked. Backends
+    /// nobody asked for are not rendered just to fill the entry. Write
+    /// failures are ignored: an unwritable cache only means the next run
+    /// renders them again.
+    pub fn persist(&self) {
+        let Some(cache) = self.cache else { return };
+        self.functions.par_iter().for_each(|function| {
+            let Some(key) = &function.key else { return };
+            if function.rendered.iter().all(|text| text.get().is_none()) {
+                return;
             }
-        }).collect();
-        let result = anti_obfuscation::deobfuscate_instructions(&obf_instructions);
-        instructions = result.cleaned_instructions.iter().map(|inst| {
-            Instruction {
-                address: inst.address,
-                mnemonic: inst.mnemonic.clone(),
-                operands: inst.operands.clone(),
-                raw_line: inst.raw_line.clone(),
+            let mut entry = match (&function.cached, function.func.get()) {
+                (Some(entry), _) => entry.clone(),
+                (None, Some(func)) => cached_structure(func),
+                (None, None) => return,
+            };
+            for (slot, text) in [&mut entry.pseudo, &mut entry.c, &mut entry.rust].into_iter().zip(&function.rendered) {
+                if let Some(text) = text.get() {
+                    *slot = Some(text.clone());
+                }
             }
-        }).collect();
-        (result, junk_count)
-    } else {
-        let count = instructions.len();
-        (anti_obfuscation::DeobfuscationResult {
-            original_count: count,
-            cleaned_count: count,
-            removed_instructions: 0,
-            signatures: Vec::new(),
-            cleaned_instructions: Vec::new(),
-            success_rate: 1.0,
-        }, 0)
+            let _ = cache.store(key, &entry);
+        });
+    }
+}
+
+/// A function of a session. Functions without a cache entry are analysed
+/// when the session is built; cache hits reuse the stored structure and
+/// text, and are only analysed if a backend missing from the entry is asked
+/// for.
+struct SessionFunction {
+    name: String,
+    span: Range<usize>,
+    /// Cache key, when the session has a cache
+    key: Option<FunctionKey>,
+    cached: Option<CachedFunction>,
+    func: OnceLock<Function>,
+    /// Text rendered in this session per `Backend`
+    rendered: [OnceLock<String>; 3],
+}
+
+#[derive(Debug, Clone, Copy)]
+enum Backend {
+    Pseudo,
+    C,
+    Rust,
+}
+
+impl SessionFunction {
+    fn name(&self) -> &str {
+        &self.name
+    }
+
+    fn block_count(&self) -> usize {
+        match (&self.cached, self.func.get()) {
+            (Some(entry), _) => entry.blocks.len(),
+            (None, Some(func)) => func.blocks.len(),
+            (None, None) => 0,
+        }
+    }
+
+    fn c_declaration(&self) -> Option<String> {
+        match (&self.cached, self.func.get()) {
+            (Some(entry), _) => entry.c_declaration.clone(),
+            (None, Some(func)) => c_forward_declaration(func),
+            (None, None) => None,
+        }
+    }
+
+    fn render(&self, backend: Backend, instructions: &[Instruction], index: Option<&FunctionIndex>) -> &str {
+        let stored = self.cached.as_ref().and_then(|entry| match backend {
+            Backend::Pseudo => entry.pseudo.as_deref(),
+            Backend::C => entry.c.as_deref(),
+            Backend::Rust => entry.rust.as_deref(),
+        });
+        if let Some(text) = stored {
+            return text;
+        }
+        self.rendered[backend as usize].get_or_init(|| {
+            let func = self.func.get_or_init(|| analyze_function(self.name.clone(), instructions, self.span.clone(), index));
+            match backend {
+                Backend::Pseudo => generate_pseudo_function(func, instructions),
+                Backend::C => generate_c_function(func, instructions),
+                Backend::Rust => generate_rust_function(func, instructions, is_function_safe(func, instructions)),
+            }
+        })
+    }
+}
+
+/// Cache entry for `func` with no rendered text yet
+fn cached_structure(func: &Function) -> CachedFunction {
+    CachedFunction {
+        name: func.name.clone(),
+        start_addr: func.start_addr,
+        end_addr: func.end_addr,
+        blocks: func.blocks
+            .iter()
+            .map(|block| CachedBlock { start_addr: block.start_addr, instruction_count: block.range.len() })
+            .collect(),
+        variables: func.variables
+            .values()
+            .map(|var| CachedVariable {
+                name: var.name.clone(),
+                var_type: format!("{:?}", var.var_type),
+                is_param: var.is_param,
+                size: var.size,
+            })
+            .collect(),
+        c_declaration: c_forward_declaration(func),
+        pseudo: None,
+        c: None,
+        rust: None,
+    }
+}
+
+/// Longest possible x86 instruction; bounds the bytes hashed for the last
+/// function of the stream
+const MAX_INSTRUCTION_LEN: usize = 15;
+
+/// Cache key for the function `name` at `instructions[span]`: its RVA, its
+/// bytes when the image is mapped (from the first instruction up to the next
+/// one after the span, so bytes the junk filter dropped are still covered),
+/// and what its output takes from the rest of the image. That is only the
+/// instructions the whole-image passes left in it and the known function
+/// starts inside it: calls and IAT slots are rendered by address, so other
+/// functions' names and the import names do not reach its text.
+fn function_key(image: Option<&LoadedImage>, name: &str, instructions: &[Instruction], span: &Range<usize>, index: Option<&FunctionIndex>) -> FunctionKey {
+    let start = instructions[span.start].address;
+    let last = instructions[span.end - 1].address;
+    let end = instructions.get(span.end).map_or(last + MAX_INSTRUCTION_LEN as u64, |next| next.address);
+    let bytes = image.and_then(|image| image.rva_bytes(start as usize..end as usize)).unwrap_or_default();
+
+    let mut context = Vec::with_capacity(span.len() * 32);
+    context.extend_from_slice(name.as_bytes());
+    context.push(0);
+    for instr in &instructions[span.clone()] {
+        context.extend_from_slice(&instr.address.to_le_bytes());
+        context.extend_from_slice(instr.mnemonic.as_str().as_bytes());
+        context.push(0);
+        context.extend_from_slice(instr.operands.as_str().as_bytes());
+        context.push(0);
+    }
+    for function_start in index.into_iter().flat_map(|index| index.starts_in(start..last + 1)) {
+        context.extend_from_slice(&function_start.to_le_bytes());
+    }
+    FunctionKey::of(start, bytes, &context)
+}
+
+/// Wall-clock budget for each analysis pass. Every pass runs regardless of
+/// input size; one that reaches its budget stops early and is reported.
+const PASS_TIME_BUDGET: Duration = Duration::from_secs(10);
+
+/// Which analysis passes ran to completion, in run order
+#[derive(Debug, Clone, Default)]
+struct PassReport {
+    completed: Vec<&'static str>,
+    over_budget: Vec<&'static str>,
+}
+
+impl PassReport {
+    fn record(&mut self, pass: &'static str, completed: bool) {
+        if completed {
+            self.completed.push(pass);
+        } else {
+            self.over_budget.push(pass);
+        }
+    }
+
+    /// `FULL (...)` when every pass finished, `FAST (...)` otherwise
+    fn mode(&self) -> String {
+        if self.over_budget.is_empty() {
+            format!("FULL ({})", self.completed.join(", "))
+        } else {
+            format!("FAST (over time budget: {})", self.over_budget.join(", "))
+        }
+    }
+}
+
+/// Output of the junk-filter, deobfuscation and crypto passes shared by all
+/// translators.
+struct PassOutput {
+    instructions: Vec<Instruction>,
+    deobf_result: anti_obfuscation::DeobfuscationResult,
+    junk_removed: usize,
+    crypto_sigs: Vec<CryptoSignature>,
+    report: PassReport,
+}
+
+fn run_analysis_passes(original_instructions: &[Instruction], pe_info: Option<&PEInfo>) -> PassOutput {
+    let mut report = PassReport::default();
+    
+    // Filter junk instructions (one linear sweep, always completes)
+    let mut instructions = filter_junk_instructions(original_instructions);
+    let junk_removed = original_instructions.len() - instructions.len();
+    report.record("junk filter", true);
+    
+    // NEW v4.0: Anti-obfuscation layer (rewrites the filtered list in place)
+    let roots = pe_info.map(PEInfo::code_roots).unwrap_or_default();
+    let deobf_result = anti_obfuscation::deobfuscate_instructions(&mut instructions, &roots, Instant::now() + PASS_TIME_BUDGET);
+    report.record("deobfuscation", deobf_result.over_budget.is_empty());
+    
+    // Detect crypto algorithms
+    let deadline = Instant::now() + PASS_TIME_BUDGET;
+    let tables = match pe_info.and_then(|pe| pe.image.as_deref()) {
+        Some(image) => crypto_tables::scan_image(image, &instructions),
+        None => Vec::new(),
     };
+    let (crypto_sigs, crypto_complete) = detect_crypto_algorithms(&instructions, &tables, deadline);
+    report.record("crypto detection", crypto_complete);
     
-    // Detect crypto algorithms (only for smaller inputs)
-    let crypto_sigs = if should_filter {
-        detect_crypto_algorithms(&instructions)
-    } else {
-        Vec::new()
-    };
+    PassOutput {
+        instructions,
+        deobf_result,
+        junk_removed,
+        crypto_sigs,
+        report,
+    }
+}
+
+/// Typed counterpart of `windows_api_db::detect_api_calls_in_code`: looks for
+/// known API names in operands instead of the rendered listing.
+fn detect_windows_apis(instructions: &[Instruction]) -> Vec<String> {
+    let db = windows_api_db::get_windows_api_database();
+    let mut detected: Vec<String> = db
+        .into_keys()
+        .filter(|api_name| instructions.iter().any(|instr| instr.operands.contains(api_name.as_str())))
+        .collect();
+    detected.sort();
+    detected
+}
+
+/// Render every function on the rayon pool and join the results in function
+/// order, each followed by a blank line, so output is identical to a serial
+/// loop. Cached functions contribute their stored text.
+fn render_functions(session: &AnalysisSession, backend: Backend) -> String {
+    let instructions = &session.passes.instructions;
+    let index = session.index();
+    let rendered: Vec<&str> = session.functions.par_iter().map(|func| func.render(backend, instructions, index)).collect();
+    let mut output = String::with_capacity(rendered.iter().map(|text| text.len() + 1).sum());
+    for text in rendered {
+        output.push_str(text);
+        output.push('\n');
+    }
+    output
+}
+
+pub fn translate_to_pseudo(asm: &str) -> String {
+    translate_to_pseudo_with_pe(asm, None)
+}
+
+pub fn translate_to_pseudo_with_pe(asm: &str, pe_path: Option<&str>) -> String {
+    let pe_info = pe_path.and_then(|path| parse_pe_file(path));
+    let instructions = parse_instructions(asm);
+    render_pseudo(&AnalysisSession::new(&instructions, pe_info.as_ref()))
+}
+
+fn render_pseudo(session: &AnalysisSession) -> String {
+    let AnalysisSession { original_count, pe_info, passes, functions, .. } = session;
+    let PassOutput { instructions, deobf_result, junk_removed, crypto_sigs, report } = passes;
     
-    let functions = identify_functions(&instructions);
     let mut output = String::new();
     
     output.push_str("╔════════════════════════════════════════════════════════════════╗\n");
@@ -313,15 +752,11 @@ pub fn translate_to_pseudo_with_pe(asm: &str, pe_path: Option<&str>) -> String {
     output.push_str(&format!("│ Obfuscation Removed:       {:>6}\n", deobf_result.removed_instructions));
     output.push_str(&format!("│ Final Instruction Count:   {:>6}\n", instructions.len()));
     output.push_str(&format!("│ Functions Identified:      {:>6}\n", functions.len()));
-    output.push_str(&format!("│ Basic Blocks Created:      {:>6}\n", functions.iter().map(|f| f.blocks.len()).sum::<usize>()));
-    if should_filter {
-        output.push_str("│ Analysis Mode:             FULL (with optimization)\n");
-    } else {
-        output.push_str("│ Analysis Mode:             FAST (large input detected)\n");
-    }
+    output.push_str(&format!("│ Basic Blocks Created:      {:>6}\n", functions.iter().map(|f| f.block_count()).sum::<usize>()));
+    output.push_str(&format!("│ Analysis Mode:             {}\n", report.mode()));
     output.push_str("└───────────────────────────────────────────────────────────────┘\n\n");
     
-    if let Some(ref pe) = pe_info {
+    if let Some(pe) = pe_info {
         output.push_str("┌─ PE File Information ─────────────────────────────────────────┐\n");
         output.push_str(&format!("│ Image Base:   0x{:016x}\n", pe.image_base));
         output.push_str(&format!("│ Entry Point:  0x{:016x}\n", pe.entry_point));
@@ -341,71 +776,23 @@ pub fn translate_to_pseudo_with_pe(asm: &str, pe_path: Option<&str>) -> String {
         output.push_str(&format_crypto_report(&crypto_sigs));
     }
     
-    for func in &functions {
-        output.push_str(&generate_pseudo_function(func, &instructions));
-        output.push_str("\n");
-    }
+    output.push_str(&render_functions(session, Backend::Pseudo));
     
     output
 }
 
 pub fn translate_to_rust_with_pe(asm: &str, pe_path: Option<&str>) -> String {
     let pe_info = pe_path.and_then(|path| parse_pe_file(path));
-    let original_instructions = parse_instructions(asm);
-    let original_count = original_instructions.len();
-    let mut instructions = original_instructions;
-
-    // Only filter junk if we have a reasonable number of instructions (performance optimization)
-    // Reduced threshold from 10000 to 5000 for better performance
-    let should_filter = instructions.len() < 5000;
-
-    let (deobf_result, junk_removed) = if should_filter {
-        let before_junk = instructions.len();
-        // Filter junk instructions
-        instructions = filter_junk_instructions(&instructions);
-        let after_junk = instructions.len();
-        let junk_count = before_junk - after_junk;
-
-        // NEW v4.0: Anti-obfuscation layer
-        let obf_instructions: Vec<anti_obfuscation::Instruction> = instructions.iter().map(|inst| {
-            anti_obfuscation::Instruction {
-                address: inst.address,
-                mnemonic: inst.mnemonic.clone(),
-                operands: inst.operands.clone(),
-                raw_line: inst.raw_line.clone(),
-            }
-        }).collect();
-        let result = anti_obfuscation::deobfuscate_instructions(&obf_instructions);
-        instructions = result.cleaned_instructions.iter().map(|inst| {
-            Instruction {
-                address: inst.address,
-                mnemonic: inst.mnemonic.clone(),
-                operands: inst.operands.clone(),
-                raw_line: inst.raw_line.clone(),
-            }
-        }).collect();
-        (result, junk_count)
-    } else {
-        let count = instructions.len();
-        (anti_obfuscation::DeobfuscationResult {
-            original_count: count,
-            cleaned_count: count,
-            removed_instructions: 0,
-            signatures: Vec::new(),
-            cleaned_instructions: Vec::new(),
-            success_rate: 1.0,
-        }, 0)
-    };
-
-    // Detect crypto algorithms (only for smaller inputs)
-    let crypto_sigs = if should_filter {
-        detect_crypto_algorithms(&instructions)
-    } else {
-        Vec::new()
-    };
+    // Detect Windows API calls from assembly
+    let detected_apis = windows_api_db::detect_api_calls_in_code(asm);
+    let instructions = parse_instructions(asm);
+    render_rust(&AnalysisSession::with_detected_apis(&instructions, pe_info.as_ref(), detected_apis))
+}
 
-    let functions = identify_functions(&instructions);
-    let api_calls = detect_api_calls(&instructions);
+fn render_rust(session: &AnalysisSession) -> String {
+    let AnalysisSession { original_count, pe_info, passes, functions, api_calls, .. } = session;
+    let PassOutput { instructions, deobf_result, junk_removed, crypto_sigs, report } = passes;
+    let detected_apis = session.detected_apis();
 
     let mut output = String::new();
 
@@ -421,9 +808,9 @@ pub fn translate_to_rust_with_pe(asm: &str, pe_path: Option<&str>) -> String {
     output.push_str(&format!(" * Final Instruction Count:   {}\n", instructions.len()));
     output.push_str(&format!(" * Functions Identified:      {}\n", functions.len()));
     output.push_str(&format!(" * API Calls Detected:        {}\n", api_calls.len()));
-    output.push_str(&format!(" * Basic Blocks Created:      {}\n", functions.iter().map(|f| f.blocks.len()).sum::<usize>()));
+    output.push_str(&format!(" * Basic Blocks Created:      {}\n", functions.iter().map(|f| f.block_count()).sum::<usize>()));
 
-    if let Some(ref pe) = pe_info {
+    if let Some(pe) = pe_info {
         output.push_str(&format!(" * Image Base: 0x{:x}\n", pe.image_base));
         output.push_str(&format!(" * Entry Point: 0x{:x}\n", pe.entry_point));
         output.push_str(&format!(" * Imports: {}\n", pe.imports.len()));
@@ -438,11 +825,7 @@ pub fn translate_to_rust_with_pe(asm: &str, pe_path: Option<&str>) -> String {
         output.push_str(&format!(" * 🔐 Crypto Algorithms: {} detected\n", crypto_sigs.len()));
     }
 
-    if should_filter {
-        output.push_str(" * Analysis Mode: FULL (with optimization)\n");
-    } else {
-        output.push_str(" * Analysis Mode: FAST (large input detected)\n");
-    }
+    output.push_str(&format!(" * Analysis Mode: {}\n", report.mode()));
 
     output.push_str(" * Features: Control Flow Recovery, Type Inference, Pattern Recognition\n");
     output.push_str(" * Features: PE Parsing, IAT Resolution, Anti-Obfuscation, Crypto Detection\n");
@@ -467,15 +850,12 @@ pub fn translate_to_rust_with_pe(asm: &str, pe_path: Option<&str>) -> String {
         output.push_str(" */\n\n");
     }
 
-    // Detect Windows API calls from assembly
-    let detected_apis = windows_api_db::detect_api_calls_in_code(asm);
-    
     // Includes
     output.push_str("#![allow(unused_variables, unused_mut, dead_code)]\n\n");
 
     // Add Windows API FFI declarations if detected
     if !detected_apis.is_empty() {
-        output.push_str(&windows_api_db::generate_rust_api_declarations(&detected_apis));
+        output.push_str(&windows_api_db::generate_rust_api_declarations(detected_apis));
     } else if !api_calls.is_empty() {
         output.push_str("// Windows API bindings\n");
         output.push_str("#[cfg(windows)]\n");
@@ -493,14 +873,10 @@ pub fn translate_to_rust_with_pe(asm: &str, pe_path: Option<&str>) -> String {
     output.push_str("\n");
 
     // Generate each function
-    for func in &functions {
-        let is_safe = is_function_safe(func, &instructions);
-        output.push_str(&generate_rust_function(func, &instructions, is_safe));
-        output.push_str("\n");
-    }
+    output.push_str(&render_functions(session, Backend::Rust));
     
     // Add main function if not present
-    if !functions.iter().any(|f| f.name == "main") {
+    if !functions.iter().any(|f| f.name() == "main") {
         output.push_str("// ═══════════════════════════════════════════════════════════════\n");
         output.push_str("// MAIN FUNCTION\n");
         output.push_str("// ═══════════════════════════════════════════════════════════════\n");
@@ -545,7 +921,7 @@ pub fn translate_to_rust_with_pe(asm: &str, pe_path: Option<&str>) -> String {
             if !functions.is_empty() {
                 output.push_str("    unsafe {\n");
                 output.push_str(&format!("        // Call the first identified function\n"));
-                output.push_str(&format!("        {}();\n", functions[0].name));
+                output.push_str(&format!("        {}();\n", functions[0].name()));
                 output.push_str("    }\n");
             } else {
                 output.push_str("    // TODO: Implement program logic\n");
@@ -569,61 +945,16 @@ pub fn translate_to_rust(asm: &str) -> String {
 
 pub fn translate_to_c_with_pe(asm: &str, pe_path: Option<&str>) -> String {
     let pe_info = pe_path.and_then(|path| parse_pe_file(path));
-    let original_instructions = parse_instructions(asm);
-    let original_count = original_instructions.len();
-    let mut instructions = original_instructions;
-    
-    // Only filter junk if we have a reasonable number of instructions (performance optimization)
-    // Reduced threshold from 10000 to 5000 for better performance
-    let should_filter = instructions.len() < 5000;
-    
-    let (deobf_result, junk_removed) = if should_filter {
-        let before_junk = instructions.len();
-        // Filter junk instructions
-        instructions = filter_junk_instructions(&instructions);
-        let after_junk = instructions.len();
-        let junk_count = before_junk - after_junk;
-        
-        // NEW v4.0: Anti-obfuscation layer
-        let obf_instructions: Vec<anti_obfuscation::Instruction> = instructions.iter().map(|inst| {
-            anti_obfuscation::Instruction {
-                address: inst.address,
-                mnemonic: inst.mnemonic.clone(),
-                operands: inst.operands.clone(),
-                raw_line: inst.raw_line.clone(),
-            }
-        }).collect();
-        let result = anti_obfuscation::deobfuscate_instructions(&obf_instructions);
-        instructions = result.cleaned_instructions.iter().map(|inst| {
-            Instruction {
-                address: inst.address,
-                mnemonic: inst.mnemonic.clone(),
-                operands: inst.operands.clone(),
-                raw_line: inst.raw_line.clone(),
-            }
-        }).collect();
-        (result, junk_count)
-    } else {
-        let count = instructions.len();
-        (anti_obfuscation::DeobfuscationResult {
-            original_count: count,
-            cleaned_count: count,
-            cleaned_instructions: Vec::new(),
-            removed_instructions: 0,
-            signatures: Vec::new(),
-            success_rate: 1.0,
-        }, 0)
-    };
-    
-    // Detect crypto algorithms (only for smaller inputs)
-    let crypto_sigs = if should_filter {
-        detect_crypto_algorithms(&instructions)
-    } else {
-        Vec::new()
-    };
-    
-    let functions = identify_functions(&instructions);
-    let api_calls = detect_api_calls(&instructions);
+    // Detect Windows API calls from assembly
+    let detected_apis = windows_api_db::detect_api_calls_in_code(asm);
+    let instructions = parse_instructions(asm);
+    render_c(&AnalysisSession::with_detected_apis(&instructions, pe_info.as_ref(), detected_apis))
+}
+
+fn render_c(session: &AnalysisSession) -> String {
+    let AnalysisSession { original_count, pe_info, passes, functions, api_calls, .. } = session;
+    let PassOutput { instructions, deobf_result, junk_removed, crypto_sigs, report } = passes;
+    let detected_apis = session.detected_apis();
     
     let mut output = String::new();
     
@@ -639,9 +970,9 @@ pub fn translate_to_c_with_pe(asm: &str, pe_path: Option<&str>) -> String {
     output.push_str(&format!(" * Final Instruction Count:   {}\n", instructions.len()));
     output.push_str(&format!(" * Functions Identified:      {}\n", functions.len()));
     output.push_str(&format!(" * API Calls Detected:        {}\n", api_calls.len()));
-    output.push_str(&format!(" * Basic Blocks Created:      {}\n", functions.iter().map(|f| f.blocks.len()).sum::<usize>()));
+    output.push_str(&format!(" * Basic Blocks Created:      {}\n", functions.iter().map(|f| f.block_count()).sum::<usize>()));
     
-    if let Some(ref pe) = pe_info {
+    if let Some(pe) = pe_info {
         output.push_str(&format!(" * Image Base: 0x{:x}\n", pe.image_base));
         output.push_str(&format!(" * Entry Point: 0x{:x}\n", pe.entry_point));
         output.push_str(&format!(" * Imports: {}\n", pe.imports.len()));
@@ -656,11 +987,7 @@ pub fn translate_to_c_with_pe(asm: &str, pe_path: Option<&str>) -> String {
         output.push_str(&format!(" * 🔐 Crypto Algorithms: {} detected\n", crypto_sigs.len()));
     }
     
-    if should_filter {
-        output.push_str(" * Analysis Mode: FULL (with optimization)\n");
-    } else {
-        output.push_str(" * Analysis Mode: FAST (large input detected)\n");
-    }
+    output.push_str(&format!(" * Analysis Mode: {}\n", report.mode()));
     
     output.push_str(" * Features: Control Flow Recovery, Type Inference, Pattern Recognition\n");
     output.push_str(" * Features: PE Parsing, IAT Resolution, Anti-Obfuscation, Crypto Detection\n");
@@ -685,9 +1012,6 @@ pub fn translate_to_c_with_pe(asm: &str, pe_path: Option<&str>) -> String {
         output.push_str(" */\n\n");
     }
     
-    // Detect Windows API calls from assembly
-    let detected_apis = windows_api_db::detect_api_calls_in_code(asm);
-    
     // Includes
     output.push_str("#include <stdio.h>\n");
     output.push_str("#include <stdlib.h>\n");
@@ -702,7 +1026,7 @@ pub fn translate_to_c_with_pe(asm: &str, pe_path: Option<&str>) -> String {
     
     // Add Windows API declarations if detected
     if !detected_apis.is_empty() {
-        output.push_str(&windows_api_db::generate_c_api_declarations(&detected_apis));
+        output.push_str(&windows_api_db::generate_c_api_declarations(detected_apis));
     }
     
     // Type definitions - using standard C types for better compatibility
@@ -720,26 +1044,17 @@ pub fn translate_to_c_with_pe(asm: &str, pe_path: Option<&str>) -> String {
     // Forward declarations
     if functions.len() > 1 {
         output.push_str("// ═══ Forward Declarations ═══\n");
-        for func in &functions {
-            if !func.is_api_call {
-                let return_type = match &func.return_type {
-                    VarType::Unknown => "int",
-                    _ => &type_to_c_string(&func.return_type),
-                };
-                output.push_str(&format!("{} {}();\n", return_type, func.name));
-            }
+        for declaration in functions.iter().filter_map(|func| func.c_declaration()) {
+            output.push_str(&declaration);
         }
         output.push_str("\n");
     }
     
     // Generate each function
-    for func in &functions {
-        output.push_str(&generate_c_function(func, &instructions));
-        output.push_str("\n");
-    }
+    output.push_str(&render_functions(session, Backend::C));
 
     // Add main function if not present
-    if !functions.iter().any(|f| f.name == "main") {
+    if !functions.iter().any(|f| f.name() == "main") {
         output.push_str("// ═══════════════════════════════════════════════════════════════\n");
         output.push_str("// MAIN FUNCTION\n");
         output.push_str("// ═══════════════════════════════════════════════════════════════\n");
@@ -777,7 +1092,7 @@ pub fn translate_to_c_with_pe(asm: &str, pe_path: Option<&str>) -> String {
             output.push_str("int main() {\n");
             if !functions.is_empty() {
                 output.push_str(&format!("    // Call the first identified function\n"));
-                output.push_str(&format!("    {}();\n", functions[0].name));
+                output.push_str(&format!("    {}();\n", functions[0].name()));
             } else {
                 output.push_str("    // TODO: Implement program logic\n");
                 output.push_str("    // The decompiler could not identify clear function boundaries.\n");
@@ -817,19 +1132,14 @@ fn init_junk_patterns() -> Vec<JunkPattern> {
 }
 
 fn is_junk_instruction(instr: &Instruction, next: Option<&Instruction>, _patterns: &[JunkPattern]) -> bool {
-    // Multi-byte NOPs
-    if instr.mnemonic == "nop" {
-        return true;
-    }
-    
-    // NOP variants: nop dword ptr [eax], etc.
-    if instr.mnemonic == "nop" && instr.operands.contains("ptr") {
+    // NOPs, including the multi-byte `nop dword ptr [eax]` forms
+    if instr.mnemonic == Mnemonic::NOP {
         return true;
     }
     
     // Check inc/dec cancellation
     if let Some(next_instr) = next {
-        if instr.mnemonic == "inc" && next_instr.mnemonic == "dec" {
+        if instr.mnemonic == Mnemonic::INC && next_instr.mnemonic == Mnemonic::DEC {
             // Check if same register
             if instr.operands == next_instr.operands {
                 return true;
@@ -837,7 +1147,7 @@ fn is_junk_instruction(instr: &Instruction, next: Option<&Instruction>, _pattern
         }
         
         // Check push/pop cancellation
-        if instr.mnemonic == "push" && next_instr.mnemonic == "pop" {
+        if instr.mnemonic == Mnemonic::PUSH && next_instr.mnemonic == Mnemonic::POP {
             if instr.operands == next_instr.operands {
                 return true;
             }
@@ -847,39 +1157,52 @@ fn is_junk_instruction(instr: &Instruction, next: Option<&Instruction>, _pattern
     false
 }
 
+#[derive(Clone, Copy, PartialEq)]
+enum JunkClass {
+    Keep,
+    Junk,
+    /// Junk together with its successor (a cancelling pair)
+    PairStart,
+}
+
+/// Canceling pairs (most common junk): `inc`/`dec`, `push`/`pop`, `add`/`sub`
+/// on the same operands
+fn is_cancelling_pair(instr: &Instruction, next: &Instruction) -> bool {
+    instr.operands == next.operands && matches!(
+        (instr.mnemonic, next.mnemonic),
+        (Mnemonic::INC, Mnemonic::DEC) | (Mnemonic::DEC, Mnemonic::INC) | (Mnemonic::PUSH, Mnemonic::POP) |
+        (Mnemonic::ADD, Mnemonic::SUB) | (Mnemonic::SUB, Mnemonic::ADD)
+    )
+}
+
 fn filter_junk_instructions(instructions: &[Instruction]) -> Vec<Instruction> {
-    // Pre-allocate with full capacity (most instructions will be kept)
-    let mut filtered = Vec::with_capacity(instructions.len());
     let patterns = init_junk_patterns();
-    let mut skip_next = false;
     
-    for (i, instr) in instructions.iter().enumerate() {
+    // Each position is classified on its own, so this part runs in parallel
+    let classes: Vec<JunkClass> = (0..instructions.len()).into_par_iter().map(|i| {
+        let instr = &instructions[i];
+        let next = instructions.get(i + 1);
+        if next.is_some_and(|next_instr| is_cancelling_pair(instr, next_instr)) {
+            JunkClass::PairStart
+        } else if is_junk_instruction(instr, next, &patterns) {
+            JunkClass::Junk
+        } else {
+            JunkClass::Keep
+        }
+    }).collect();
+    
+    // A pair swallows its successor, so pairs are resolved left to right
+    let mut filtered = Vec::with_capacity(instructions.len());
+    let mut skip_next = false;
+    for (instr, class) in instructions.iter().zip(classes) {
         if skip_next {
             skip_next = false;
             continue;
         }
-        
-        let next = instructions.get(i + 1);
-        
-        // Fast path: check common junk patterns inline before calling is_junk_instruction
-        let is_junk = if let Some(next_instr) = next {
-            // Check canceling pairs first (most common junk)
-            if (instr.mnemonic == "inc" && next_instr.mnemonic == "dec" && instr.operands == next_instr.operands) ||
-               (instr.mnemonic == "dec" && next_instr.mnemonic == "inc" && instr.operands == next_instr.operands) ||
-               (instr.mnemonic == "push" && next_instr.mnemonic == "pop" && instr.operands == next_instr.operands) ||
-               (instr.mnemonic == "add" && next_instr.mnemonic == "sub" && instr.operands == next_instr.operands) ||
-               (instr.mnemonic == "sub" && next_instr.mnemonic == "add" && instr.operands == next_instr.operands) {
-                skip_next = true;
-                true
-            } else {
-                is_junk_instruction(instr, Some(next_instr), &patterns)
-            }
-        } else {
-            is_junk_instruction(instr, None, &patterns)
-        };
-        
-        if !is_junk {
-            filtered.push(instr.clone());
+        match class {
+            JunkClass::PairStart => skip_next = true,
+            JunkClass::Junk => {}
+            JunkClass::Keep => filtered.push(instr.clone()),
         }
     }
     
@@ -926,12 +1249,14 @@ fn init_crypto_patterns() -> Vec<CryptoPattern> {
             instructions: vec!["add".to_string(), "ror".to_string(), "xor".to_string()],
             description: "SHA-256 hash round constants".to_string(),
         },
-        // RC4 key scheduling
+        // RC4 key scheduling. Small constants and mov/add/xor occur in every
+        // binary, so this pattern has none: only a whole key-schedule loop
+        // counts as evidence (`rc4_key_schedule`)
         CryptoPattern {
             name: "RC4 KSA".to_string(),
             algorithm: CryptoAlgorithm::RC4,
-            constants: vec![0x00, 0x01, 0x02, 0x03],
-            instructions: vec!["xor".to_string(), "add".to_string(), "mov".to_string()],
+            constants: vec![],
+            instructions: vec![],
             description: "RC4 key scheduling algorithm".to_string(),
         },
         // DES S-Boxes
@@ -961,74 +1286,191 @@ fn init_crypto_patterns() -> Vec<CryptoPattern> {
     ]
 }
 
-fn detect_crypto_algorithms(instructions: &[Instruction]) -> Vec<CryptoSignature> {
-    // Skip crypto detection for very large inputs (performance optimization)
-    if instructions.len() > 5000 {
-        return Vec::new();
+/// All patterns compiled for a single pass: every magic constant in one
+/// sorted table and every indicative mnemonic mapped to a bitmask of patterns.
+struct CryptoMatcher {
+    patterns: Vec<CryptoPattern>,
+    /// `(constant, pattern index)`, sorted by constant
+    constants: Vec<(u64, usize)>,
+    mnemonics: HashMap<Mnemonic, u32>,
+}
+
+fn crypto_matcher() -> &'static CryptoMatcher {
+    static MATCHER: OnceLock<CryptoMatcher> = OnceLock::new();
+    MATCHER.get_or_init(|| {
+        let patterns = init_crypto_patterns();
+        debug_assert!(patterns.len() <= 32, "pattern bitmask is a u32");
+        
+        let mut constants: Vec<(u64, usize)> = patterns.iter().enumerate()
+            .flat_map(|(index, pattern)| pattern.constants.iter().map(move |&c| (c as u64, index)))
+            .collect();
+        constants.sort_unstable();
+        constants.dedup();
+        
+        let mut mnemonics: HashMap<Mnemonic, u32> = HashMap::new();
+        for (index, pattern) in patterns.iter().enumerate() {
+            for mnemonic in &pattern.instructions {
+                *mnemonics.entry(Mnemonic::intern(mnemonic)).or_default() |= 1 << index;
+            }
+        }
+        
+        CryptoMatcher { patterns, constants, mnemonics }
+    })
+}
+
+/// Evidence gathered for one pattern during the scan
+#[derive(Default)]
+struct PatternHits {
+    evidence: Vec<String>,
+    /// Score from evidence specific to the algorithm: distinctive constants,
+    /// tables in data sections, the RC4 key-schedule loop
+    confidence: f32,
+    /// Score from small constants, which ordinary code is full of
+    weak: f32,
+    /// Instructions of the pattern's mix seen anywhere in the input
+    mnemonic_hits: u32,
+    /// One bit per entry of the pattern's `constants` already found
+    constants_seen: u32,
+    location: u64,
+}
+
+/// Immediates below this (loop bounds, sizes, S-box nibbles and bytes) are
+/// too common in ordinary code to identify an algorithm on their own
+const MIN_DISTINCTIVE_CONSTANT: u64 = 0x10000;
+
+/// Most the instruction mix can add to a pattern's confidence
+const MNEMONIC_SCORE_CAP: f32 = 0.25;
+
+impl PatternHits {
+    /// Small constants and the instruction mix occur in every binary, so
+    /// they only count towards a pattern that already has specific evidence
+    fn total(&self) -> f32 {
+        if self.confidence == 0.0 {
+            return 0.0;
+        }
+        self.confidence + self.weak + (self.mnemonic_hits as f32 * 0.05).min(MNEMONIC_SCORE_CAP)
     }
+}
+
+/// Scan for crypto constants and instruction mixes in one linear pass over
+/// the instructions, and fold in the tables found in data sections. Each
+/// constant counts once however often it recurs. Returns the signatures
+/// found and whether the instruction scan finished before `deadline`.
+fn detect_crypto_algorithms(instructions: &[Instruction], tables: &[TableHit], deadline: Instant) -> (Vec<CryptoSignature>, bool) {
+    let matcher = crypto_matcher();
+    let mut hits: Vec<PatternHits> = matcher.patterns.iter().map(|_| PatternHits::default()).collect();
+    let mut complete = true;
+    let mut xor_count = 0;
+    let mut first_xor = None;
+    let rc4 = matcher.patterns.iter().position(|p| p.algorithm == CryptoAlgorithm::RC4);
     
-    let patterns = init_crypto_patterns();
-    let mut signatures = Vec::with_capacity(patterns.len());
-    let mut detected = HashSet::with_capacity(patterns.len());
-    
-    // Scan for magic constants
-    for pattern in &patterns {
-        let mut evidence = Vec::new();
-        let mut confidence: f32 = 0.0;
-        let mut location = 0u64;
+    for (i, instr) in instructions.iter().enumerate() {
+        if i % 4096 == 0 && Instant::now() >= deadline {
+            complete = false;
+            break;
+        }
+        if let Some(constant) = extract_constant(&instr.operands) {
+            let first = matcher.constants.partition_point(|&(value, _)| value < constant);
+            for &(_, index) in matcher.constants[first..].iter().take_while(|&&(value, _)| value == constant) {
+                let bit = 1 << matcher.patterns[index].constants.iter().position(|&c| c as u64 == constant).unwrap_or(0);
+                let pattern = &mut hits[index];
+                if pattern.constants_seen & bit != 0 {
+                    continue;
+                }
+                pattern.constants_seen |= bit;
+                pattern.evidence.push(format!("Found constant 0x{:x} at 0x{:x}", constant, instr.address));
+                if constant >= MIN_DISTINCTIVE_CONSTANT {
+                    pattern.confidence += 0.3;
+                } else {
+                    pattern.weak += 0.3;
+                }
+                if pattern.location == 0 {
+                    pattern.location = instr.address;
+                }
+            }
+        }
         
-        // Check for constant patterns (optimized loop)
-        for instr in instructions {
-            // Extract immediate values from operands
-            if let Some(constant) = extract_constant(&instr.operands) {
-                for &magic in &pattern.constants {
-                    if constant == magic as u64 {
-                        evidence.push(format!("Found constant 0x{:x} at 0x{:x}", magic, instr.address));
-                        confidence += 0.3;
-                        if location == 0 {
-                            location = instr.address;
-                        }
-                        break; // Found match, no need to check other constants
-                    }
+        if let Some(&mask) = matcher.mnemonics.get(&instr.mnemonic) {
+            for (index, pattern) in hits.iter_mut().enumerate() {
+                if mask & (1 << index) != 0 {
+                    pattern.mnemonic_hits += 1;
                 }
             }
-            
-            // Check for instruction patterns (fast path with direct comparison)
-            for pattern_instr in &pattern.instructions {
-                if instr.mnemonic == pattern_instr.as_str() {
-                    confidence += 0.05;
-                    break;
+        }
+        
+        if instr.mnemonic == Mnemonic::XOR {
+            xor_count += 1;
+            first_xor.get_or_insert(instr.address);
+        }
+        
+        if let Some(index) = rc4.filter(|_| instr.mnemonic == Mnemonic::CMP) {
+            if let Some(loop_start) = rc4_key_schedule(instructions, i) {
+                let pattern = &mut hits[index];
+                pattern.evidence.push(format!("Key-schedule loop over 256 entries at 0x{:x}", loop_start));
+                pattern.confidence += 0.6;
+                if pattern.location == 0 {
+                    pattern.location = loop_start;
                 }
             }
-            
-            // Early exit if confidence is already high enough
-            if confidence > 1.0 {
-                break;
+        }
+    }
+    
+    // Tables in data sections are the strongest evidence: listed first, and
+    // families without an instruction pattern (CRC-32, Blowfish) get their own
+    // signature
+    let mut table_only: Vec<(CryptoAlgorithm, Vec<&TableHit>)> = Vec::new();
+    for hit in tables.iter().rev() {
+        let algorithm = table_algorithm(hit.family);
+        match matcher.patterns.iter().position(|p| p.algorithm == algorithm) {
+            Some(index) => {
+                let pattern = &mut hits[index];
+                pattern.evidence.insert(0, describe_table_hit(hit));
+                pattern.confidence += 0.6;
+                pattern.location = hit.va;
             }
+            None => match table_only.iter_mut().find(|(a, _)| *a == algorithm) {
+                Some((_, found)) => found.insert(0, hit),
+                None => table_only.push((algorithm, vec![hit])),
+            },
         }
-        
-        // If we found enough evidence, add signature
+    }
+    
+    let mut signatures = Vec::with_capacity(matcher.patterns.len());
+    let mut detected = HashSet::with_capacity(matcher.patterns.len());
+    
+    // If we found enough evidence, add signature
+    for (pattern, found) in matcher.patterns.iter().zip(hits) {
+        let confidence = found.total();
         if confidence > 0.5 && !detected.contains(&pattern.algorithm) {
             signatures.push(CryptoSignature {
                 algorithm: pattern.algorithm.clone(),
                 confidence: confidence.min(1.0),
-                location,
-                evidence,
+                location: found.location,
+                evidence: found.evidence,
                 description: pattern.description.clone(),
             });
             detected.insert(pattern.algorithm.clone());
         }
     }
     
-    // Detect XOR encryption (simple pattern) - optimized count
-    let xor_count = instructions.iter().filter(|i| i.mnemonic == "xor").count();
+    for (algorithm, found) in table_only {
+        signatures.push(CryptoSignature {
+            confidence: 0.9,
+            location: found[0].va,
+            evidence: found.iter().map(|hit| describe_table_hit(hit)).collect(),
+            description: format!("{} lookup table in a data section", found[0].name),
+            algorithm,
+        });
+    }
+    
+    // Detect XOR encryption (simple pattern)
     if xor_count > 10 {
         let xor_confidence = (xor_count as f32 / instructions.len() as f32).min(1.0);
         if xor_confidence > 0.1 && !detected.contains(&CryptoAlgorithm::XOR) {
             signatures.push(CryptoSignature {
                 algorithm: CryptoAlgorithm::XOR,
                 confidence: xor_confidence,
-                location: instructions.iter().find(|i| i.mnemonic == "xor").map(|i| i.address).unwrap_or(0),
+                location: first_xor.unwrap_or(0),
                 evidence: vec![format!("Found {} XOR operations", xor_count)],
                 description: "XOR-based encryption/obfuscation detected".to_string(),
             });
@@ -1037,27 +1479,88 @@ fn detect_crypto_algorithms(instructions: &[Instruction]) -> Vec<CryptoSignature
     
     // Sort by confidence (unstable sort is faster)
     signatures.sort_unstable_by(|a, b| b.confidence.partial_cmp(&a.confidence).unwrap());
-    signatures
+    (signatures, complete)
+}
+
+/// How far back from a loop's closing `cmp` its body may start
+const RC4_LOOP_WINDOW: usize = 48;
+
+/// If the `cmp` at `instructions[i]` closes an RC4 key-schedule loop, the
+/// loop's start address. The loop must count to 256 (`cmp reg, 0x100` or
+/// `0xff`, then a backward conditional jump), and its body must hold the
+/// S-box swap (two byte loads, two byte stores) and the `j += S[i] + key[i]`
+/// addition. All of it has to be in the one loop, so unrelated small
+/// constants elsewhere in the binary no longer add up to RC4.
+fn rc4_key_schedule(instructions: &[Instruction], i: usize) -> Option<u64> {
+    let bound = instructions[i].operands.get(1)?;
+    if !matches!(bound, "0x100" | "0xff" | "256" | "255") {
+        return None;
+    }
+    
+    let jump = instructions.get(i + 1)?;
+    if jump.mnemonic.info().flow != FlowClass::CondJump {
+        return None;
+    }
+    let target = jump.operands.imm().filter(|&target| target < instructions[i].address)?;
+    let window = i.saturating_sub(RC4_LOOP_WINDOW);
+    let start = window + instructions[window..i].iter().position(|instr| instr.address == target)?;
+    
+    let body = &instructions[start..i];
+    let byte_access = |instr: &Instruction, operand: usize| instr.operands.mem(operand).is_some_and(|mem| mem.width == 1);
+    let loads = body.iter().filter(|instr| instr.mnemonic == Mnemonic::MOVZX && byte_access(instr, 1)).count();
+    let stores = body.iter().filter(|instr| instr.mnemonic == Mnemonic::MOV && byte_access(instr, 0)).count();
+    let adds = body.iter().filter(|instr| instr.mnemonic == Mnemonic::ADD).count();
+    (loads >= 2 && stores >= 2 && adds >= 1).then_some(target)
+}
+
+fn table_algorithm(family: TableFamily) -> CryptoAlgorithm {
+    match family {
+        TableFamily::Aes => CryptoAlgorithm::AES,
+        TableFamily::Md5 => CryptoAlgorithm::MD5,
+        TableFamily::Sha1 => CryptoAlgorithm::SHA1,
+        TableFamily::Sha256 => CryptoAlgorithm::SHA256,
+        TableFamily::Des => CryptoAlgorithm::DES,
+        TableFamily::Crc32 => CryptoAlgorithm::Unknown("CRC-32 Checksum".to_string()),
+        TableFamily::Blowfish => CryptoAlgorithm::Blowfish,
+        TableFamily::Base64 => CryptoAlgorithm::Base64,
+    }
+}
+
+fn describe_table_hit(hit: &TableHit) -> String {
+    let mut text = format!("{} ({} bytes) in {} at 0x{:x}", hit.name, hit.len, hit.section, hit.va);
+    match hit.xrefs.as_slice() {
+        [] => text.push_str(", no code references"),
+        xrefs => {
+            let shown: Vec<String> = xrefs.iter().take(4).map(|va| format!("0x{:x}", va)).collect();
+            text.push_str(&format!(", referenced from {}", shown.join(", ")));
+            if xrefs.len() > 4 {
+                text.push_str(&format!(" (+{} more)", xrefs.len() - 4));
+            }
+        }
+    }
+    text
 }
 
-fn extract_constant(operands: &str) -> Option<u64> {
-    // Optimized: use OnceLock to compile regex patterns only once
-    static HEX_RE: OnceLock<Regex> = OnceLock::new();
-    static DEC_RE: OnceLock<Regex> = OnceLock::new();
-    
-    // Try to extract hex constants from operands
-    let hex_re = HEX_RE.get_or_init(|| Regex::new(r"0x([0-9a-fA-F]+)").unwrap());
-    if let Some(caps) = hex_re.captures(operands) {
-        if let Some(hex_str) = caps.get(1) {
-            return u64::from_str_radix(hex_str.as_str(), 16).ok();
-        }
+/// First immediate in the operands: the first `0x` hex literal, otherwise the
+/// first standalone decimal number (what `0x([0-9a-fA-F]+)` and then
+/// `\b(\d+)\b` used to match)
+fn extract_constant(operands: &Operands) -> Option<u64> {
+    if let Some(value) = operands.imm() {
+        return Some(value);
     }
     
-    // Try decimal constants
-    let dec_re = DEC_RE.get_or_init(|| Regex::new(r"\b(\d+)\b").unwrap());
-    if let Some(caps) = dec_re.captures(operands) {
-        if let Some(dec_str) = caps.get(1) {
-            return dec_str.as_str().parse::<u64>().ok();
+    let bytes = operands.as_bytes();
+    let is_word = |b: u8| b.is_ascii_alphanumeric() || b == b'_' || b >= 0x80;
+    let mut i = 0;
+    while i < bytes.len() {
+        if bytes[i].is_ascii_digit() && (i == 0 || !is_word(bytes[i - 1])) {
+            let end = i + bytes[i..].iter().take_while(|b| b.is_ascii_digit()).count();
+            if end == bytes.len() || !is_word(bytes[end]) {
+                return operands[i..end].parse::<u64>().ok();
+            }
+            i = end;
+        } else {
+            i += 1;
         }
     }
     
@@ -1131,79 +1634,124 @@ fn format_crypto_report(signatures: &[CryptoSignature]) -> String {
 // FUNCTION IDENTIFICATION
 // ============================================================================
 
-fn identify_functions(instructions: &[Instruction]) -> Vec<Function> {
-    let mut functions = Vec::new();
-    let mut current_func_start = 0u64;
+fn identify_functions(instructions: &[Instruction], index: Option<&FunctionIndex>) -> Vec<Function> {
+    // Boundaries are found serially (cheap); the per-function analysis runs
+    // on the rayon pool and `collect` keeps address order
+    function_spans(instructions, index)
+        .into_par_iter()
+        .map(|(name, span)| analyze_function(name, instructions, span, index))
+        .collect()
+}
+
+/// Name and instruction span of every function, in address order
+fn function_spans(instructions: &[Instruction], index: Option<&FunctionIndex>) -> Vec<(String, Range<usize>)> {
+    let spans = match index {
+        Some(index) if !index.is_empty() => spans_from_index(instructions, index),
+        _ => spans_from_prologues(instructions, 0..instructions.len()),
+    };
+    
+    // If no functions detected, treat entire code as one function
+    if spans.is_empty() && !instructions.is_empty() {
+        return vec![("main".to_string(), 0..instructions.len())];
+    }
+    
+    spans
+        .into_iter()
+        .map(|span| (format!("func_{:x}", instructions[span.start].address), span))
+        .collect()
+}
+
+/// x64 path: every `.pdata` entry is an exact function boundary, so each one
+/// is sliced out with two binary searches. Leaf functions need no unwind
+/// data, so code between entries still goes through prologue detection.
+fn spans_from_index(instructions: &[Instruction], index: &FunctionIndex) -> Vec<Range<usize>> {
+    let mut spans: Vec<Range<usize>> = index
+        .ranges()
+        .iter()
+        .map(|range| {
+            instructions.partition_point(|instr| instr.address < range.start)
+                ..instructions.partition_point(|instr| instr.address < range.end)
+        })
+        .filter(|span| !span.is_empty())
+        .collect();
+    
+    let mut gaps = Vec::new();
+    let mut gap_start = 0;
+    for span in spans.iter().chain(std::iter::once(&(instructions.len()..instructions.len()))) {
+        if gap_start < span.start {
+            gaps.push(gap_start..span.start);
+        }
+        gap_start = gap_start.max(span.end);
+    }
+    
+    for gap in gaps {
+        spans.extend(spans_from_prologues(instructions, gap));
+    }
+    
+    spans.sort_by_key(|span| span.start);
+    spans
+}
+
+/// Heuristic path: a function runs from a `push rbp; mov rbp, rsp` prologue
+/// to the next `ret`/`leave`. Only `instructions[within]` is scanned.
+fn spans_from_prologues(instructions: &[Instruction], within: Range<usize>) -> Vec<Range<usize>> {
+    let mut spans = Vec::new();
     let mut current_func_start_idx = 0usize;
     let mut in_function = false;
     
-    for (i, instr) in instructions.iter().enumerate() {
+    for i in within.clone() {
+        let instr = &instructions[i];
+        
         // Function prologue detection
-        if is_function_prologue(instr, instructions.get(i + 1)) {
-            current_func_start = instr.address;
+        if is_function_prologue(instr, instructions[..within.end].get(i + 1)) {
             current_func_start_idx = i;
             in_function = true;
         }
         
         // Function epilogue detection
         if in_function && is_function_epilogue(instr) {
-            let func_name = format!("func_{:x}", current_func_start);
-            
-            // Optimized: use slice instead of filter+collect (O(1) vs O(n))
-            let func_instructions = &instructions[current_func_start_idx..=i];
-            
-            let blocks = build_basic_blocks(func_instructions);
-            let variables = analyze_variables(func_instructions);
-            let parameters = extract_parameters(&variables);
-            
-            functions.push(Function {
-                name: func_name,
-                start_addr: current_func_start,
-                end_addr: instr.address,
-                blocks,
-                variables,
-                is_api_call: false,
-                parameters,
-                return_type: VarType::Unknown,
-                called_by: Vec::new(),
-                calls: Vec::new(),
-            });
-            
+            spans.push(current_func_start_idx..i + 1);
             in_function = false;
         }
     }
     
-    // If no functions detected, treat entire code as one function
-    if functions.is_empty() && !instructions.is_empty() {
-        let blocks = build_basic_blocks(instructions);
-        let variables = analyze_variables(instructions);
-        let parameters = extract_parameters(&variables);
-        
-        functions.push(Function {
-            name: "main".to_string(),
-            start_addr: instructions[0].address,
-            end_addr: instructions.last().unwrap().address,
-            blocks,
-            variables,
-            is_api_call: false,
-            parameters,
-            return_type: VarType::Unknown,
-            called_by: Vec::new(),
-            calls: Vec::new(),
-        });
-    }
+    spans
+}
+
+/// Blocks, variables and parameters for the function at `instructions[span]`
+fn analyze_function(name: String, instructions: &[Instruction], span: Range<usize>, index: Option<&FunctionIndex>) -> Function {
+    let func_instructions = &instructions[span.clone()];
+    let blocks = build_basic_blocks(instructions, span.clone(), index);
+    let ranges: Vec<Range<usize>> = blocks.iter().map(|block| block.range.clone()).collect();
+    let cfg = ControlFlowGraph::build(instructions, &ranges);
+    let dataflow = Dataflow::analyze(instructions, &ranges, &cfg);
+    let variables = analyze_variables(instructions, span, &dataflow);
+    let parameters = extract_parameters(&variables);
     
-    functions
+    Function {
+        name,
+        start_addr: func_instructions[0].address,
+        end_addr: func_instructions[func_instructions.len() - 1].address,
+        blocks,
+        cfg,
+        variables,
+        is_api_call: false,
+        parameters,
+        return_type: VarType::Unknown,
+        called_by: Vec::new(),
+        calls: Vec::new(),
+    }
 }
 
 fn is_function_prologue(instr: &Instruction, next: Option<&Instruction>) -> bool {
     // Common function prologues:
     // push ebp / push rbp
     // mov ebp, esp / mov rbp, rsp
-    if instr.mnemonic == "push" && (instr.operands.contains("ebp") || instr.operands.contains("rbp")) {
+    let is_frame_pointer = |operands: &Operands, index| operands.reg(index).is_some_and(|reg| reg.is_frame_pointer());
+    if instr.mnemonic == Mnemonic::PUSH && is_frame_pointer(&instr.operands, 0) {
         if let Some(next_instr) = next {
-            if next_instr.mnemonic == "mov" && 
-               (next_instr.operands.contains("ebp") || next_instr.operands.contains("rbp")) {
+            if next_instr.mnemonic == Mnemonic::MOV && 
+               (is_frame_pointer(&next_instr.operands, 0) || is_frame_pointer(&next_instr.operands, 1)) {
                 return true;
             }
         }
@@ -1213,199 +1761,135 @@ fn is_function_prologue(instr: &Instruction, next: Option<&Instruction>) -> bool
 
 fn is_function_epilogue(instr: &Instruction) -> bool {
     // ret, retn, or leave followed by ret
-    instr.mnemonic == "ret" || instr.mnemonic == "retn" || instr.mnemonic == "leave"
+    instr.mnemonic.info().flow == FlowClass::Return || instr.mnemonic == Mnemonic::LEAVE
 }
 
 // ============================================================================
 // BASIC BLOCK CONSTRUCTION
 // ============================================================================
 
-fn build_basic_blocks(instructions: &[Instruction]) -> Vec<BasicBlock> {
-    if instructions.is_empty() {
+/// Split `instructions[span]` into basic blocks. Leaders are marked in a
+/// bitmap over instruction indices, branch targets are resolved by binary
+/// search over the span's ascending addresses, and each block is the index
+/// range from one leader to the next. Block ranges index into
+/// `instructions`, not into the span.
+fn build_basic_blocks(all_instructions: &[Instruction], span: Range<usize>, index: Option<&FunctionIndex>) -> Vec<BasicBlock> {
+    let base = span.start;
+    let instructions = &all_instructions[span];
+    let n = instructions.len();
+    if n == 0 {
         return Vec::new();
     }
     
-    // Pre-allocate with estimated capacity
-    let mut leaders = HashSet::with_capacity(instructions.len() / 4);
-    leaders.insert(instructions[0].address);
+    let mut leaders = vec![0u64; n.div_ceil(64)];
+    let mut mark = |i: usize| leaders[i / 64] |= 1 << (i % 64);
+    let index_of = |address: u64| instructions.binary_search_by_key(&address, |instr| instr.address).ok();
+    mark(0);
+    
+    // Known function starts always begin a block, even when nothing in this
+    // slice branches to them (e.g. the whole-program fallback)
+    if let Some(index) = index {
+        let span = instructions[0].address..instructions[n - 1].address + 1;
+        index.starts_in(span).filter_map(index_of).for_each(&mut mark);
+    }
     
-    // Find all leaders (targets of jumps, instructions after jumps)
+    // Branch targets start a block; whatever follows a branch, return or
+    // halt does too
     for (i, instr) in instructions.iter().enumerate() {
-        // Fast path: check common branch instructions inline
-        let is_branch = matches!(instr.mnemonic.as_str(), 
-            "jmp" | "je" | "jne" | "jz" | "jnz" | "jg" | "jge" | "jl" | "jle" |
-            "ja" | "jae" | "jb" | "jbe" | "jo" | "jno" | "js" | "jns" | "jp" | "jnp" | "call");
-        
+        let is_branch = is_branch_instruction(instr.mnemonic);
         if is_branch {
-            if let Some(target) = extract_jump_target(&instr.operands) {
-                leaders.insert(target);
-            }
-            if i + 1 < instructions.len() {
-                leaders.insert(instructions[i + 1].address);
+            // Branch target was decoded when the instruction was built
+            if let Some(target) = instr.operands.imm().and_then(index_of) {
+                mark(target);
             }
         }
+        if (is_branch || instr.mnemonic.info().is_exit()) && i + 1 < n {
+            mark(i + 1);
+        }
     }
     
-    // Build blocks efficiently
-    let mut leader_addrs: Vec<u64> = leaders.into_iter().collect();
-    leader_addrs.sort_unstable(); // unstable sort is faster
-    
-    let mut blocks = Vec::with_capacity(leader_addrs.len());
-    
-    // Create address lookup map for faster filtering
-    let addr_to_idx: HashMap<u64, usize> = instructions
-        .iter()
-        .enumerate()
-        .map(|(idx, instr)| (instr.address, idx))
-        .collect();
-    
-    for i in 0..leader_addrs.len() {
-        let start = leader_addrs[i];
-        let end = if i + 1 < leader_addrs.len() {
-            leader_addrs[i + 1]
-        } else {
-            u64::MAX
-        };
-        
-        // Use index-based slicing instead of filtering for better performance
-        if let Some(&start_idx) = addr_to_idx.get(&start) {
-            let mut block_instrs = Vec::new();
-            for instr in &instructions[start_idx..] {
-                if instr.address >= end {
-                    break;
-                }
-                block_instrs.push(instr.clone());
-            }
-            
-            if !block_instrs.is_empty() {
-                blocks.push(BasicBlock {
-                    start_addr: start,
-                    end_addr: block_instrs.last().unwrap().address,
-                    instructions: block_instrs,
-                    successors: Vec::new(),
-                    predecessors: Vec::new(),
-                });
+    let block = |start: usize, end: usize| BasicBlock {
+        start_addr: instructions[start].address,
+        range: base + start..base + end,
+    };
+    let mut blocks = Vec::with_capacity(leaders.iter().map(|word| word.count_ones() as usize).sum());
+    let mut start = 0;
+    for (w, &word) in leaders.iter().enumerate() {
+        let mut bits = word;
+        while bits != 0 {
+            let i = w * 64 + bits.trailing_zeros() as usize;
+            bits &= bits - 1;
+            if i > start {
+                blocks.push(block(start, i));
+                start = i;
             }
         }
     }
+    blocks.push(block(start, n));
     
     blocks
 }
 
-fn is_branch_instruction(mnemonic: &str) -> bool {
-    matches!(mnemonic, 
-        "jmp" | "je" | "jne" | "jz" | "jnz" | "jg" | "jge" | "jl" | "jle" |
-        "ja" | "jae" | "jb" | "jbe" | "jo" | "jno" | "js" | "jns" | "jp" | "jnp" |
-        "call"
-    )
-}
-
-fn extract_jump_target(operands: &str) -> Option<u64> {
-    // Optimized: use OnceLock to compile regex only once
-    static JUMP_TARGET_RE: OnceLock<Regex> = OnceLock::new();
-    let re = JUMP_TARGET_RE.get_or_init(|| {
-        Regex::new(r"0x([0-9a-fA-F]+)").unwrap()
-    });
-    
-    if let Some(caps) = re.captures(operands) {
-        u64::from_str_radix(&caps[1], 16).ok()
-    } else {
-        None
-    }
+/// Jumps, conditional jumps and calls: one flow-class lookup
+fn is_branch_instruction(mnemonic: Mnemonic) -> bool {
+    mnemonic.info().is_branch()
 }
 
 // ============================================================================
 // VARIABLE ANALYSIS
 // ============================================================================
 
-fn analyze_variables(instructions: &[Instruction]) -> HashMap<String, Variable> {
-    // Pre-allocate with estimated capacity (typically 10-20% of instructions are variable-related)
-    let mut variables = HashMap::with_capacity(instructions.len() / 10);
-    let mut register_map = HashMap::with_capacity(16); // Limited number of registers
+/// Locals and parameters from the function's frame analysis: every stack
+/// slot accessed through a memory operand (named by its offset from the
+/// entry stack pointer, so both frame styles agree) and every argument
+/// register read before it is written.
+fn analyze_variables(instructions: &[Instruction], span: Range<usize>, dataflow: &Dataflow) -> FrameVariables {
+    let slot_name = |offset: i64| if offset > 0 { format!("param_{}", offset) } else { format!("local_{}", -offset) };
+    
+    let mut variables = FrameVariables::default();
+    for slot in dataflow.slots().iter().filter(|slot| slot.explicit) {
+        let name = slot_name(slot.offset);
+        let var_type = if slot.vector { VarType::Float } else { type_from_width(RegClass::General, slot.width) };
+        variables.vars.insert(name.clone(), Variable {
+            name,
+            size: if slot.width > 0 { slot.width as usize } else { type_size(&var_type) },
+            var_type,
+            is_param: slot.is_param(),
+            is_local: !slot.is_param(),
+            is_global: false,
+            address: None,
+        });
+    }
     
-    for instr in instructions {
-        match instr.mnemonic.as_str() {
-            "mov" | "lea" => {
-                // UTF-8 SAFE: Use split_once() instead of find() + byte slicing
-                // This prevents crashes when operands contain multi-byte UTF-8 characters
-                if let Some((dest, src)) = instr.operands.split_once(',') {
-                    let dest = dest.trim();
-                    let src = src.trim();
-                    
-                    // Detect stack variables - optimized with byte-level checks
-                    let has_bp = src.contains("ebp") || src.contains("rbp");
-                    let has_sp = src.contains("esp") || src.contains("rsp");
-                    
-                    if has_bp || has_sp {
-                        let var_name = normalize_stack_var(src);
-                        let var_type = infer_type_from_register(dest);
-                        
-                        variables.entry(var_name.clone()).or_insert_with(|| {
-                            let is_param = src.contains("+") && !src.contains("-");
-                            Variable {
-                                name: var_name.clone(),
-                                var_type: var_type.clone(),
-                                is_param,
-                                is_local: src.contains("-"),
-                                is_global: false,
-                                address: None,
-                                size: type_size(&var_type),
-                            }
-                        });
-                        
-                        register_map.insert(dest.to_string(), var_name);
-                    }
-                    
-                    // Track register assignments
-                    if let Some(var_name) = register_map.get(src) {
-                        register_map.insert(dest.to_string(), var_name.clone());
-                    }
+    for reg in dataflow.register_params(instructions) {
+        let name = reg.to_string();
+        variables.vars.insert(name.clone(), Variable {
+            name,
+            var_type: type_from_width(reg.class, reg.width),
+            is_param: true,
+            is_local: false,
+            is_global: false,
+            address: None,
+            size: reg.width as usize,
+        });
+    }
+    
+    // First spelling of each slot wins
+    for i in span {
+        let operands = &instructions[i].operands;
+        for k in 0..operands.count() {
+            if let Some(slot) = dataflow.slot_of(instructions, i, k) {
+                let slot = &dataflow.slots()[slot];
+                if slot.explicit {
+                    variables.aliases.entry(operands.get(k).unwrap_or_default().to_string()).or_insert_with(|| slot_name(slot.offset));
                 }
             }
-            "push" => {
-                // Parameters being pushed
-                let var_name = format!("param_{}", variables.len());
-                variables.insert(var_name.clone(), Variable {
-                    name: var_name,
-                    var_type: VarType::Unknown,
-                    is_param: true,
-                    is_local: false,
-                    is_global: false,
-                    address: None,
-                    size: 4,
-                });
-            }
-            _ => {}
         }
     }
     
     variables
 }
 
-fn normalize_stack_var(operand: &str) -> String {
-    // Optimized: use OnceLock to compile regex only once
-    static STACK_VAR_RE: OnceLock<Regex> = OnceLock::new();
-    let re = STACK_VAR_RE.get_or_init(|| {
-        Regex::new(r"(ebp|rbp|esp|rsp)\s*([+-])\s*0x([0-9a-f]+)").unwrap()
-    });
-    
-    if let Some(caps) = re.captures(operand) {
-        let _base = &caps[1];
-        let sign = &caps[2];
-        let offset = u32::from_str_radix(&caps[3], 16).unwrap_or(0);
-        
-        if sign == "-" {
-            format!("local_{}", offset)
-        } else {
-            format!("param_{}", offset)
-        }
-    } else if operand.contains("ebp") || operand.contains("rbp") {
-        "local_0".to_string()
-    } else {
-        operand.replace("[", "_").replace("];", "_").replace(" ", "_")
-    }
-}
-
 fn type_size(var_type: &VarType) -> usize {
     match var_type {
         VarType::Int32 => 4,
@@ -1419,7 +1903,7 @@ fn type_size(var_type: &VarType) -> usize {
     }
 }
 
-fn extract_parameters(variables: &HashMap<String, Variable>) -> Vec<Variable> {
+fn extract_parameters(variables: &FrameVariables) -> Vec<Variable> {
     variables
         .values()
         .filter(|v| v.is_param)
@@ -1427,19 +1911,14 @@ fn extract_parameters(variables: &HashMap<String, Variable>) -> Vec<Variable> {
         .collect()
 }
 
-fn infer_type_from_register(reg: &str) -> VarType {
-    let reg_lower = reg.to_lowercase();
-    
-    if reg_lower.starts_with('r') && (reg_lower.len() == 3 || reg_lower == "rax" || reg_lower == "rbx") {
-        VarType::Int64
-    } else if reg_lower.starts_with('e') {
-        VarType::Int32
-    } else if reg_lower.contains("ptr") {
-        VarType::Pointer
-    } else if reg_lower.starts_with("xmm") || reg_lower.starts_with("ymm") {
-        VarType::Float
-    } else {
-        VarType::Unknown
+/// Type of a value held in a register of `class`, or a stack slot accessed
+/// `width` bytes at a time
+fn type_from_width(class: RegClass, width: u8) -> VarType {
+    match (class, width) {
+        (RegClass::Vector, _) => VarType::Float,
+        (RegClass::General, 8) => VarType::Int64,
+        (RegClass::General, 4) => VarType::Int32,
+        _ => VarType::Unknown,
     }
 }
 
@@ -1453,7 +1932,7 @@ fn detect_api_calls(instructions: &[Instruction]) -> HashMap<String, String> {
     let known_apis = get_known_api_database();
     
     for instr in instructions {
-        if instr.mnemonic == "call" {
+        if instr.mnemonic == Mnemonic::CALL {
             let call_target = instr.operands.trim();
             
             // Check if it's a known API
@@ -1514,70 +1993,52 @@ fn get_known_api_database() -> HashMap<String, String> {
 // CONTROL FLOW ANALYSIS
 // ============================================================================
 
-fn analyze_control_flow(blocks: &[BasicBlock]) -> HashMap<u64, ControlFlow> {
-    // Pre-allocate with exact capacity
-    let mut control_flow = HashMap::with_capacity(blocks.len());
-    
-    for block in blocks {
-        if let Some(last_instr) = block.instructions.last() {
-            // Optimized: use matches! macro for faster branch checking
-            let flow = if last_instr.mnemonic == "jmp" {
-                if let Some(target) = extract_jump_target(&last_instr.operands) {
-                    // Check if it's a loop (jumping backwards)
-                    if target <= block.start_addr {
-                        ControlFlow::WhileLoop {
-                            condition: "true".to_string(),
-                            body_block: target,
-                        }
-                    } else {
-                        ControlFlow::Sequential
-                    }
-                } else {
-                    ControlFlow::Sequential
-                }
-            } else if matches!(last_instr.mnemonic.as_str(), 
-                "je" | "jz" | "jne" | "jnz" | "jg" | "jge" | "jl" | "jle" | "ja" | "jae" | "jb" | "jbe") {
-                if let Some(target) = extract_jump_target(&last_instr.operands) {
-                    let condition = translate_condition(&last_instr.mnemonic);
-                    
-                    // Check if it's a loop
-                    if target <= block.start_addr {
-                        ControlFlow::WhileLoop {
-                            condition,
-                            body_block: target,
-                        }
-                    } else {
-                        ControlFlow::IfThen {
-                            condition,
-                            true_block: target,
-                        }
-                    }
-                } else {
-                    ControlFlow::Sequential
-                }
-            } else {
-                ControlFlow::Sequential
-            };
-            
-            control_flow.insert(block.start_addr, flow);
-        }
+/// Classify each block's exit from the function's CFG: the latch of a
+/// natural loop closes a loop back to its header, any other conditional jump
+/// opens an `if`.
+fn analyze_control_flow(func: &Function, instructions: &[Instruction]) -> HashMap<u64, ControlFlow> {
+    let mut control_flow = HashMap::with_capacity(func.blocks.len());
+    
+    for (b, block) in func.blocks.iter().enumerate() {
+        let Some(last_instr) = block.instructions(instructions).last() else {
+            continue;
+        };
+        let info = last_instr.mnemonic.info();
+        let header = func.cfg.loops().iter().find(|l| l.latches.contains(&b)).map(|l| l.header);
+        
+        let flow = match (header, info.flow) {
+            (Some(header), flow) => ControlFlow::WhileLoop {
+                condition: if flow == FlowClass::CondJump { translate_condition(info.cond) } else { "true".to_string() },
+                body_block: func.blocks[header].start_addr,
+            },
+            (None, FlowClass::CondJump) => match last_instr.operands.imm() {
+                Some(target) => ControlFlow::IfThen {
+                    condition: translate_condition(info.cond),
+                    true_block: target,
+                },
+                None => ControlFlow::Sequential,
+            },
+            _ => ControlFlow::Sequential,
+        };
+        
+        control_flow.insert(block.start_addr, flow);
     }
     
     control_flow
 }
 
-fn translate_condition(mnemonic: &str) -> String {
-    match mnemonic {
-        "je" | "jz" => "equal".to_string(),
-        "jne" | "jnz" => "not_equal".to_string(),
-        "jg" => "greater".to_string(),
-        "jge" => "greater_or_equal".to_string(),
-        "jl" => "less".to_string(),
-        "jle" => "less_or_equal".to_string(),
-        "ja" => "above".to_string(),
-        "jae" => "above_or_equal".to_string(),
-        "jb" => "below".to_string(),
-        "jbe" => "below_or_equal".to_string(),
+fn translate_condition(cond: Option<Condition>) -> String {
+    match cond {
+        Some(Condition::Equal) => "equal".to_string(),
+        Some(Condition::NotEqual) => "not_equal".to_string(),
+        Some(Condition::Greater) => "greater".to_string(),
+        Some(Condition::GreaterEqual) => "greater_or_equal".to_string(),
+        Some(Condition::Less) => "less".to_string(),
+        Some(Condition::LessEqual) => "less_or_equal".to_string(),
+        Some(Condition::Above) => "above".to_string(),
+        Some(Condition::AboveEqual) => "above_or_equal".to_string(),
+        Some(Condition::Below) => "below".to_string(),
+        Some(Condition::BelowEqual) => "below_or_equal".to_string(),
         _ => "condition".to_string(),
     }
 }
@@ -1586,9 +2047,9 @@ fn translate_condition(mnemonic: &str) -> String {
 // PSEUDO-CODE GENERATION
 // ============================================================================
 
-fn generate_pseudo_function(func: &Function, _instructions: &[Instruction]) -> String {
+fn generate_pseudo_function(func: &Function, instructions: &[Instruction]) -> String {
     // Pre-allocate with estimated capacity (avg 100 bytes per instruction)
-    let estimated_size = func.blocks.iter().map(|b| b.instructions.len()).sum::<usize>() * 100;
+    let estimated_size = func.blocks.iter().map(|b| b.range.len()).sum::<usize>() * 100;
     let mut output = String::with_capacity(estimated_size);
     
     output.push_str(&format!("+─ Function: {} (0x{:x}) ─┐\n", func.name, func.start_addr));
@@ -1605,7 +2066,7 @@ for (name, var) in &func.variables {
     }
     
     // Control flow analysis
-    let control_flow = analyze_control_flow(&func.blocks);
+    let control_flow = analyze_control_flow(func, instructions);
     
     // Generate pseudo code
     output.push_str("│ Code:\n");
@@ -1629,7 +2090,7 @@ for (name, var) in &func.variables {
             }
         }
         
-        for instr in &block.instructions {
+        for instr in block.instructions(instructions) {
             let pseudo = translate_instruction_to_pseudo(instr, &func.variables);
             
             // Always show something - either the pseudo code or the raw instruction
@@ -1641,15 +2102,15 @@ for (name, var) in &func.variables {
             }
             
             // Handle conditional jumps
-            if is_conditional_jump(&instr.mnemonic) && !last_condition.is_empty() {
+            if is_conditional_jump(instr.mnemonic) && !last_condition.is_empty() {
                 output.push_str(&format!("{}│ if ({}) {{\n", "  ".repeat(indent), last_condition));
                 indent += 1;
             }
         }
         
         // Close control structures
-        if let Some(last_instr) = block.instructions.last() {
-            if is_conditional_jump(&last_instr.mnemonic) && indent > 1 {
+        if let Some(last_instr) = block.instructions(instructions).last() {
+            if is_conditional_jump(last_instr.mnemonic) && indent > 1 {
                 indent -= 1;
                 output.push_str(&format!("{}│ }}\n", "  ".repeat(indent)));
             }
@@ -1668,42 +2129,39 @@ for (name, var) in &func.variables {
     output
 }
 
-fn is_conditional_jump(mnemonic: &str) -> bool {
-    matches!(mnemonic, 
-        "je" | "jne" | "jz" | "jnz" | "jg" | "jge" | "jl" | "jle" |
-        "ja" | "jae" | "jb" | "jbe" | "jo" | "jno" | "js" | "jns"
-    )
+fn is_conditional_jump(mnemonic: Mnemonic) -> bool {
+    mnemonic.info().flow == FlowClass::CondJump
 }
 
-fn translate_instruction_to_pseudo(instr: &Instruction, variables: &HashMap<String, Variable>) -> String {
-    let mnemonic = instr.mnemonic.as_str();
+fn translate_instruction_to_pseudo(instr: &Instruction, variables: &FrameVariables) -> String {
+    let mnemonic = instr.mnemonic;
     let operands = &instr.operands;
     
     match mnemonic {
-        "mov" => translate_mov_pseudo(operands, variables),
-        "lea" => translate_lea_pseudo(operands, variables),
-        "add" => translate_arithmetic_pseudo(operands, "+", variables),
-        "sub" => translate_arithmetic_pseudo(operands, "-", variables),
-        "imul" | "mul" => translate_arithmetic_pseudo(operands, "*", variables),
-        "idiv" | "div" => translate_arithmetic_pseudo(operands, "/", variables),
-        "and" => translate_arithmetic_pseudo(operands, "&", variables),
-        "or" => translate_arithmetic_pseudo(operands, "|", variables),
-        "xor" => translate_xor_pseudo(operands, variables),
-        "shl" | "sal" => translate_arithmetic_pseudo(operands, "<<", variables),
-        "shr" | "sar" => translate_arithmetic_pseudo(operands, ">>", variables),
-        "cmp" | "test" => translate_cmp_pseudo(operands, variables),
-        "call" => translate_call_pseudo(operands),
-        "ret" | "retn" => "return".to_string(),
-        "push" => format!("push({})", resolve_operand(operands, variables)),
-        "pop" => format!("pop({})", resolve_operand(operands, variables)),
-        "nop" => String::new(),
-        "jmp" => format!("goto 0x{}", operands),
+        Mnemonic::MOV => translate_mov_pseudo(operands, variables),
+        Mnemonic::LEA => translate_lea_pseudo(operands, variables),
+        Mnemonic::ADD => translate_arithmetic_pseudo(operands, "+", variables),
+        Mnemonic::SUB => translate_arithmetic_pseudo(operands, "-", variables),
+        Mnemonic::IMUL | Mnemonic::MUL => translate_arithmetic_pseudo(operands, "*", variables),
+        Mnemonic::IDIV | Mnemonic::DIV => translate_arithmetic_pseudo(operands, "/", variables),
+        Mnemonic::AND => translate_arithmetic_pseudo(operands, "&", variables),
+        Mnemonic::OR => translate_arithmetic_pseudo(operands, "|", variables),
+        Mnemonic::XOR => translate_xor_pseudo(operands, variables),
+        Mnemonic::SHL | Mnemonic::SAL => translate_arithmetic_pseudo(operands, "<<", variables),
+        Mnemonic::SHR | Mnemonic::SAR => translate_arithmetic_pseudo(operands, ">>", variables),
+        Mnemonic::CMP | Mnemonic::TEST => translate_cmp_pseudo(operands, variables),
+        Mnemonic::CALL => translate_call_pseudo(operands),
+        Mnemonic::RET | Mnemonic::RETN => "return".to_string(),
+        Mnemonic::PUSH => format!("push({})", resolve_operand(operands, variables)),
+        Mnemonic::POP => format!("pop({})", resolve_operand(operands, variables)),
+        Mnemonic::NOP => String::new(),
+        Mnemonic::JMP => format!("goto 0x{}", operands),
         _ if is_conditional_jump(mnemonic) => String::new(), // Handled by control flow
         _ => format!("// {} {}", mnemonic, operands),
     }
 }
 
-fn translate_mov_pseudo(operands: &str, variables: &HashMap<String, Variable>) -> String {
+fn translate_mov_pseudo(operands: &str, variables: &FrameVariables) -> String {
     let parts: Vec<&str> = operands.split(',').map(|s| s.trim()).collect();
     if parts.len() == 2 {
         let dest = resolve_operand(parts[0], variables);
@@ -1714,7 +2172,7 @@ fn translate_mov_pseudo(operands: &str, variables: &HashMap<String, Variable>) -
     }
 }
 
-fn translate_lea_pseudo(operands: &str, variables: &HashMap<String, Variable>) -> String {
+fn translate_lea_pseudo(operands: &str, variables: &FrameVariables) -> String {
     let parts: Vec<&str> = operands.split(',').map(|s| s.trim()).collect();
     if parts.len() == 2 {
         let dest = resolve_operand(parts[0], variables);
@@ -1725,7 +2183,7 @@ fn translate_lea_pseudo(operands: &str, variables: &HashMap<String, Variable>) -
     }
 }
 
-fn translate_arithmetic_pseudo(operands: &str, op: &str, variables: &HashMap<String, Variable>) -> String {
+fn translate_arithmetic_pseudo(operands: &str, op: &str, variables: &FrameVariables) -> String {
     let parts: Vec<&str> = operands.split(',').map(|s| s.trim()).collect();
     if parts.len() == 2 {
         let dest = resolve_operand(parts[0], variables);
@@ -1739,7 +2197,7 @@ fn translate_arithmetic_pseudo(operands: &str, op: &str, variables: &HashMap<Str
     }
 }
 
-fn translate_xor_pseudo(operands: &str, variables: &HashMap<String, Variable>) -> String {
+fn translate_xor_pseudo(operands: &str, variables: &FrameVariables) -> String {
     let parts: Vec<&str> = operands.split(',').map(|s| s.trim()).collect();
     if parts.len() == 2 && parts[0] == parts[1] {
         // xor reg, reg is a common way to zero a register
@@ -1749,7 +2207,7 @@ fn translate_xor_pseudo(operands: &str, variables: &HashMap<String, Variable>) -
     }
 }
 
-fn translate_cmp_pseudo(operands: &str, variables: &HashMap<String, Variable>) -> String {
+fn translate_cmp_pseudo(operands: &str, variables: &FrameVariables) -> String {
     let parts: Vec<&str> = operands.split(',').map(|s| s.trim()).collect();
     if parts.len() == 2 {
         let left = resolve_operand(parts[0], variables);
@@ -1774,15 +2232,12 @@ fn translate_call_pseudo(operands: &str) -> String {
     format!("call({})", target)
 }
 
-fn resolve_operand(operand: &str, variables: &HashMap<String, Variable>) -> String {
+fn resolve_operand(operand: &str, variables: &FrameVariables) -> String {
     let operand = operand.trim();
     
-    // Check if it's a stack variable
-    if operand.contains("ebp") || operand.contains("rbp") || operand.contains("esp") || operand.contains("rsp") {
-        let var_name = normalize_stack_var(operand);
-        if variables.contains_key(&var_name) {
-            return var_name;
-        }
+    // Stack slots were resolved by the frame analysis
+    if let Some(name) = variables.alias(operand) {
+        return name.to_string();
     }
     
     // Check if it's a memory reference
@@ -1799,7 +2254,19 @@ fn resolve_operand(operand: &str, variables: &HashMap<String, Variable>) -> Stri
 // C CODE GENERATION
 // ============================================================================
 
-fn generate_c_function(func: &Function, _instructions: &[Instruction]) -> String {
+/// Forward declaration for the C prologue, `None` for imported functions
+fn c_forward_declaration(func: &Function) -> Option<String> {
+    if func.is_api_call {
+        return None;
+    }
+    let return_type = match &func.return_type {
+        VarType::Unknown => "int".to_string(),
+        other => type_to_c_string(other),
+    };
+    Some(format!("{} {}();\n", return_type, func.name))
+}
+
+fn generate_c_function(func: &Function, instructions: &[Instruction]) -> String {
     let mut output = String::new();
     
     output.push_str(&format!("// ═══════════════════════════════════════════════════════════════\n"));
@@ -1842,7 +2309,7 @@ fn generate_c_function(func: &Function, _instructions: &[Instruction]) -> String
     }
     
     // Control flow analysis
-    let control_flow = analyze_control_flow(&func.blocks);
+    let control_flow = analyze_control_flow(func, instructions);
     
     // Generate C code
     let mut indent = 1;
@@ -1865,11 +2332,11 @@ fn generate_c_function(func: &Function, _instructions: &[Instruction]) -> String
             }
         }
         
-        for instr in &block.instructions {
+        for instr in block.instructions(instructions) {
             let c_code = translate_instruction_to_c(instr, &func.variables);
             
             // Track comparison operands for condition formatting
-            if instr.mnemonic == "cmp" || instr.mnemonic == "test" {
+            if instr.mnemonic == Mnemonic::CMP || instr.mnemonic == Mnemonic::TEST {
                 let parts: Vec<&str> = instr.operands.split(',').map(|s| s.trim()).collect();
                 if parts.len() == 2 {
                     last_cmp_operands = (
@@ -1887,7 +2354,7 @@ fn generate_c_function(func: &Function, _instructions: &[Instruction]) -> String
             // Skip assembly comments for cleaner, more compilable output
             
             // Handle conditional jumps
-            if is_conditional_jump(&instr.mnemonic) && !last_condition.is_empty() {
+            if is_conditional_jump(instr.mnemonic) && !last_condition.is_empty() {
                 let cond_str = format_c_condition(&last_condition, &last_cmp_operands);
                 output.push_str(&format!("{}if ({}) {{\n", "    ".repeat(indent), cond_str));
                 indent += 1;
@@ -1895,8 +2362,8 @@ fn generate_c_function(func: &Function, _instructions: &[Instruction]) -> String
         }
         
         // Close control structures
-        if let Some(last_instr) = block.instructions.last() {
-            if is_conditional_jump(&last_instr.mnemonic) && indent > 1 {
+        if let Some(last_instr) = block.instructions(instructions).last() {
+            if is_conditional_jump(last_instr.mnemonic) && indent > 1 {
                 indent -= 1;
                 output.push_str(&format!("{}}}\n", "    ".repeat(indent)));
             }
@@ -1911,8 +2378,8 @@ fn generate_c_function(func: &Function, _instructions: &[Instruction]) -> String
     
     // Add default return statement if function doesn't end with return
     let has_return = func.blocks.iter()
-        .flat_map(|b| &b.instructions)
-        .any(|i| i.mnemonic == "ret" || i.mnemonic == "retn");
+        .flat_map(|b| b.instructions(instructions))
+        .any(|i| i.mnemonic == Mnemonic::RET || i.mnemonic == Mnemonic::RETN);
     
     if !has_return {
         let default_return = match &func.return_type {
@@ -1929,35 +2396,35 @@ fn generate_c_function(func: &Function, _instructions: &[Instruction]) -> String
     output
 }
 
-fn translate_instruction_to_c(instr: &Instruction, variables: &HashMap<String, Variable>) -> String {
-    let mnemonic = instr.mnemonic.as_str();
+fn translate_instruction_to_c(instr: &Instruction, variables: &FrameVariables) -> String {
+    let mnemonic = instr.mnemonic;
     let operands = &instr.operands;
     
     match mnemonic {
-        "mov" => translate_mov_c(operands, variables),
-        "lea" => translate_lea_c(operands, variables),
-        "add" => translate_arithmetic_c(operands, "+=", variables),
-        "sub" => translate_arithmetic_c(operands, "-=", variables),
-        "imul" | "mul" => translate_arithmetic_c(operands, "*=", variables),
-        "and" => translate_arithmetic_c(operands, "&=", variables),
-        "or" => translate_arithmetic_c(operands, "|=", variables),
-        "xor" => translate_xor_c(operands, variables),
-        "shl" | "sal" => translate_arithmetic_c(operands, "<<=", variables),
-        "shr" | "sar" => translate_arithmetic_c(operands, ">>=", variables),
-        "inc" => format!("{}++;", resolve_operand(operands, variables)),
-        "dec" => format!("{}--;", resolve_operand(operands, variables)),
-        "cmp" | "test" => String::new(), // Handled by control flow
-        "call" => translate_call_c(operands),
-        "ret" | "retn" => "return;".to_string(),
-        "push" | "pop" => String::new(), // Skip stack operations for cleaner code
-        "nop" => String::new(), // Skip NOPs
-        "jmp" => String::new(), // Skip unconditional jumps (handled by control flow)
+        Mnemonic::MOV => translate_mov_c(operands, variables),
+        Mnemonic::LEA => translate_lea_c(operands, variables),
+        Mnemonic::ADD => translate_arithmetic_c(operands, "+=", variables),
+        Mnemonic::SUB => translate_arithmetic_c(operands, "-=", variables),
+        Mnemonic::IMUL | Mnemonic::MUL => translate_arithmetic_c(operands, "*=", variables),
+        Mnemonic::AND => translate_arithmetic_c(operands, "&=", variables),
+        Mnemonic::OR => translate_arithmetic_c(operands, "|=", variables),
+        Mnemonic::XOR => translate_xor_c(operands, variables),
+        Mnemonic::SHL | Mnemonic::SAL => translate_arithmetic_c(operands, "<<=", variables),
+        Mnemonic::SHR | Mnemonic::SAR => translate_arithmetic_c(operands, ">>=", variables),
+        Mnemonic::INC => format!("{}++;", resolve_operand(operands, variables)),
+        Mnemonic::DEC => format!("{}--;", resolve_operand(operands, variables)),
+        Mnemonic::CMP | Mnemonic::TEST => String::new(), // Handled by control flow
+        Mnemonic::CALL => translate_call_c(operands),
+        Mnemonic::RET | Mnemonic::RETN => "return;".to_string(),
+        Mnemonic::PUSH | Mnemonic::POP => String::new(), // Skip stack operations for cleaner code
+        Mnemonic::NOP => String::new(), // Skip NOPs
+        Mnemonic::JMP => String::new(), // Skip unconditional jumps (handled by control flow)
         _ if is_conditional_jump(mnemonic) => String::new(), // Handled by control flow
         _ => String::new(), // Skip unknown instructions for cleaner output
     }
 }
 
-fn translate_mov_c(operands: &str, variables: &HashMap<String, Variable>) -> String {
+fn translate_mov_c(operands: &str, variables: &FrameVariables) -> String {
     let parts: Vec<&str> = operands.split(',').map(|s| s.trim()).collect();
     if parts.len() == 2 {
         let dest = resolve_operand(parts[0], variables);
@@ -1968,7 +2435,7 @@ fn translate_mov_c(operands: &str, variables: &HashMap<String, Variable>) -> Str
     }
 }
 
-fn translate_lea_c(operands: &str, variables: &HashMap<String, Variable>) -> String {
+fn translate_lea_c(operands: &str, variables: &FrameVariables) -> String {
     let parts: Vec<&str> = operands.split(',').map(|s| s.trim()).collect();
     if parts.len() == 2 {
         let dest = resolve_operand(parts[0], variables);
@@ -1979,7 +2446,7 @@ fn translate_lea_c(operands: &str, variables: &HashMap<String, Variable>) -> Str
     }
 }
 
-fn translate_arithmetic_c(operands: &str, op: &str, variables: &HashMap<String, Variable>) -> String {
+fn translate_arithmetic_c(operands: &str, op: &str, variables: &FrameVariables) -> String {
     let parts: Vec<&str> = operands.split(',').map(|s| s.trim()).collect();
     if parts.len() == 2 {
         let dest = resolve_operand(parts[0], variables);
@@ -1993,7 +2460,7 @@ fn translate_arithmetic_c(operands: &str, op: &str, variables: &HashMap<String,
     }
 }
 
-fn translate_xor_c(operands: &str, variables: &HashMap<String, Variable>) -> String {
+fn translate_xor_c(operands: &str, variables: &FrameVariables) -> String {
     let parts: Vec<&str> = operands.split(',').map(|s| s.trim()).collect();
     if parts.len() == 2 && parts[0] == parts[1] {
         format!("{} = 0;", resolve_operand(parts[0], variables))
@@ -2064,9 +2531,9 @@ fn type_to_c_string(var_type: &VarType) -> String {
 // RUST CODE GENERATION
 // ============================================================================
 
-fn generate_rust_function(func: &Function, _instructions: &[Instruction], safe: bool) -> String {
+fn generate_rust_function(func: &Function, instructions: &[Instruction], safe: bool) -> String {
     // Pre-allocate with estimated capacity (avg 120 bytes per instruction for Rust)
-    let estimated_size = func.blocks.iter().map(|b| b.instructions.len()).sum::<usize>() * 120;
+    let estimated_size = func.blocks.iter().map(|b| b.range.len()).sum::<usize>() * 120;
     let mut output = String::with_capacity(estimated_size);
     
     output.push_str(&format!("// ═══════════════════════════════════════════════════════════════\\n"));
@@ -2101,7 +2568,7 @@ fn generate_rust_function(func: &Function, _instructions: &[Instruction], safe:
     }
     
     // Control flow analysis
-    let control_flow = analyze_control_flow(&func.blocks); 
+    let control_flow = analyze_control_flow(func, instructions); 
     
     // Generate Rust code
     let mut indent = 1;
@@ -2124,11 +2591,11 @@ fn generate_rust_function(func: &Function, _instructions: &[Instruction], safe:
             }
         }
         
-        for instr in &block.instructions {
+        for instr in block.instructions(instructions) {
             let rust_code = translate_instruction_to_rust(instr, &func.variables, !safe);
             
             // Track comparison operands for condition formatting
-            if instr.mnemonic == "cmp" || instr.mnemonic == "test" {
+            if instr.mnemonic == Mnemonic::CMP || instr.mnemonic == Mnemonic::TEST {
                 let parts: Vec<&str> = instr.operands.split(',').map(|s| s.trim()).collect();
                 if parts.len() == 2 {
                     last_cmp_operands = (
@@ -2147,7 +2614,7 @@ fn generate_rust_function(func: &Function, _instructions: &[Instruction], safe:
             }
             
             // Handle conditional jumps
-            if is_conditional_jump(&instr.mnemonic) && !last_condition.is_empty() {
+            if is_conditional_jump(instr.mnemonic) && !last_condition.is_empty() {
                 let cond_str = format_rust_condition(&last_condition, &last_cmp_operands);
                 output.push_str(&format!("{}if {} {{\n", "    ".repeat(indent), cond_str));
                 indent += 1;
@@ -2155,8 +2622,8 @@ fn generate_rust_function(func: &Function, _instructions: &[Instruction], safe:
         }
         
         // Close control structures
-        if let Some(last_instr) = block.instructions.last() {
-            if is_conditional_jump(&last_instr.mnemonic) && indent > 1 {
+        if let Some(last_instr) = block.instructions(instructions).last() {
+            if is_conditional_jump(last_instr.mnemonic) && indent > 1 {
                 indent -= 1;
                 output.push_str(&format!("{}}}\n", "    ".repeat(indent)));
             }
@@ -2174,35 +2641,35 @@ fn generate_rust_function(func: &Function, _instructions: &[Instruction], safe:
     output
 }
 
-fn translate_instruction_to_rust(instr: &Instruction, variables: &HashMap<String, Variable>, unsafe_context: bool) -> String {
-    let mnemonic = instr.mnemonic.as_str();
+fn translate_instruction_to_rust(instr: &Instruction, variables: &FrameVariables, unsafe_context: bool) -> String {
+    let mnemonic = instr.mnemonic;
     let operands = &instr.operands;
     
     match mnemonic {
-        "mov" => translate_mov_rust(operands, variables),
-        "lea" => translate_lea_rust(operands, variables, unsafe_context),
-        "add" => translate_arithmetic_rust(operands, "+=", variables),
-        "sub" => translate_arithmetic_rust(operands, "-=", variables),
-        "imul" | "mul" => translate_arithmetic_rust(operands, "*=", variables),
-        "and" => translate_arithmetic_rust(operands, "&=", variables),
-        "or" => translate_arithmetic_rust(operands, "|=", variables),
-        "xor" => translate_xor_rust(operands, variables),
-        "shl" | "sal" => translate_arithmetic_rust(operands, "<<=", variables),
-        "shr" | "sar" => translate_arithmetic_rust(operands, ">>=", variables),
-        "inc" => format!("{} += 1;", resolve_operand(operands, variables)),
-        "dec" => format!("{} -= 1;", resolve_operand(operands, variables)),
-        "cmp" | "test" => String::new(), // Handled by control flow
-        "call" => translate_call_rust(operands),
-        "ret" | "retn" => "return;".to_string(),
-        "push" | "pop" => format!("// {} {}", mnemonic, operands),
-        "nop" => String::new(),
-        "jmp" => format!("// goto label_0x{};", operands),
+        Mnemonic::MOV => translate_mov_rust(operands, variables),
+        Mnemonic::LEA => translate_lea_rust(operands, variables, unsafe_context),
+        Mnemonic::ADD => translate_arithmetic_rust(operands, "+=", variables),
+        Mnemonic::SUB => translate_arithmetic_rust(operands, "-=", variables),
+        Mnemonic::IMUL | Mnemonic::MUL => translate_arithmetic_rust(operands, "*=", variables),
+        Mnemonic::AND => translate_arithmetic_rust(operands, "&=", variables),
+        Mnemonic::OR => translate_arithmetic_rust(operands, "|=", variables),
+        Mnemonic::XOR => translate_xor_rust(operands, variables),
+        Mnemonic::SHL | Mnemonic::SAL => translate_arithmetic_rust(operands, "<<=", variables),
+        Mnemonic::SHR | Mnemonic::SAR => translate_arithmetic_rust(operands, ">>=", variables),
+        Mnemonic::INC => format!("{} += 1;", resolve_operand(operands, variables)),
+        Mnemonic::DEC => format!("{} -= 1;", resolve_operand(operands, variables)),
+        Mnemonic::CMP | Mnemonic::TEST => String::new(), // Handled by control flow
+        Mnemonic::CALL => translate_call_rust(operands),
+        Mnemonic::RET | Mnemonic::RETN => "return;".to_string(),
+        Mnemonic::PUSH | Mnemonic::POP => format!("// {} {}", mnemonic, operands),
+        Mnemonic::NOP => String::new(),
+        Mnemonic::JMP => format!("// goto label_0x{};", operands),
         _ if is_conditional_jump(mnemonic) => String::new(), // Handled by control flow
         _ => format!("// {} {}", mnemonic, operands),
     }
 }
 
-fn translate_mov_rust(operands: &str, variables: &HashMap<String, Variable>) -> String {
+fn translate_mov_rust(operands: &str, variables: &FrameVariables) -> String {
     let parts: Vec<&str> = operands.split(',').map(|s| s.trim()).collect();
     if parts.len() == 2 {
         let dest = resolve_operand(parts[0], variables);
@@ -2213,7 +2680,7 @@ fn translate_mov_rust(operands: &str, variables: &HashMap<String, Variable>) ->
     }
 }
 
-fn translate_lea_rust(operands: &str, variables: &HashMap<String, Variable>, unsafe_context: bool) -> String {
+fn translate_lea_rust(operands: &str, variables: &FrameVariables, unsafe_context: bool) -> String {
     let parts: Vec<&str> = operands.split(',').map(|s| s.trim()).collect();
     if parts.len() == 2 {
         let dest = resolve_operand(parts[0], variables);
@@ -2228,7 +2695,7 @@ fn translate_lea_rust(operands: &str, variables: &HashMap<String, Variable>, uns
     }
 }
 
-fn translate_arithmetic_rust(operands: &str, op: &str, variables: &HashMap<String, Variable>) -> String {
+fn translate_arithmetic_rust(operands: &str, op: &str, variables: &FrameVariables) -> String {
     let parts: Vec<&str> = operands.split(',').map(|s| s.trim()).collect();
     if parts.len() == 2 {
         let dest = resolve_operand(parts[0], variables);
@@ -2281,7 +2748,7 @@ fn type_to_rust_string(var_type: &VarType) -> String {
 
 pub fn generate_multi_file_output(asm: &str, _language: &str, mode: &str) -> Vec<(String, String)> {
     let instructions = parse_instructions(asm);
-    let functions = identify_functions(&instructions);
+    let functions = identify_functions(&instructions, None);
     let mut files = Vec::new();
 
     match mode {
@@ -2324,7 +2791,7 @@ fn is_function_safe(_func: &Function, _instructions: &[Instruction]) -> bool {
     true
 }
 
-fn translate_xor_rust(operands: &str, variables: &HashMap<String, Variable>) -> String {
+fn translate_xor_rust(operands: &str, variables: &FrameVariables) -> String {
     let parts: Vec<&str> = operands.split(',').map(|s| s.trim()).collect();
     if parts.len() == 2 {
         let dest = resolve_operand(parts[0], variables);
@@ -2369,7 +2836,7 @@ fn translate_call_rust(operands: &str) -> String {
 
 fn generate_multi_file_by_type(asm: &str, language: &str) -> Vec<(String, String)> {
     let instructions = parse_instructions(asm);
-    let functions = identify_functions(&instructions);
+    let functions = identify_functions(&instructions, None);
     let api_calls = detect_api_calls(&instructions);
     
     let mut files = Vec::new();
@@ -2582,7 +3049,7 @@ fn generate_multi_file_by_type(asm: &str, language: &str) -> Vec<(String, String
 
 fn generate_multi_file_by_function(asm: &str, language: &str) -> Vec<(String, String)> {
     let instructions = parse_instructions(asm);
-    let functions = identify_functions(&instructions);
+    let functions = identify_functions(&instructions, None);
     let api_calls = detect_api_calls(&instructions);
     
     let mut files = Vec::new();
@@ -2651,42 +3118,94 @@ fn generate_multi_file_by_function(asm: &str, language: &str) -> Vec<(String, St
 // HELPER FUNCTIONS FOR PARSING
 // ============================================================================
 
+/// Text listings below this size are parsed on the calling thread; larger
+/// ones are cut into about four chunks per rayon thread.
+const PARSE_CHUNK_MIN: usize = 64 * 1024;
+
+/// Address given to lines of a listing before its first explicit address
+const LISTING_BASE: u64 = 0x1000;
+
+/// Parse a text listing (`.asm` from the file browser, objdump/x64dbg
+/// exports). Accepted line forms:
+///
+/// - `401000: 55 48 89 e5  push rbp` (address, optional byte dump)
+/// - `0x401000 push rbp`
+/// - `00401000 push rbp` (four or more hex digits, at least one of them a
+///   decimal digit so mnemonics like `fadd` are not taken for addresses)
+/// - `push rbp` (one past the previous line's address)
+///
+/// The scanner works on bytes and borrows every piece from `asm`; no regex
+/// runs per line.
 fn parse_instructions(asm: &str) -> Vec<Instruction> {
-    // Pre-allocate with estimated capacity for better performance
-    let line_count = asm.lines().count();
-    let mut instructions = Vec::with_capacity(line_count);
-    
-    // Optimized: use OnceLock to compile regex patterns only once across all calls
-    static ADDR_COLON_RE: OnceLock<Regex> = OnceLock::new();
-    static ADDR_0X_RE: OnceLock<Regex> = OnceLock::new();
-    static ADDR_PLAIN_RE: OnceLock<Regex> = OnceLock::new();
-    
-    let addr_colon_regex = ADDR_COLON_RE.get_or_init(|| {
-        Regex::new(r"^\s*([0-9a-fA-F]+):\s*(?:[0-9a-fA-F\s]+)?\s*(.+)").unwrap()
-    });
-    let addr_0x_regex = ADDR_0X_RE.get_or_init(|| {
-        Regex::new(r"^\s*0x([0-9a-fA-F]+)\s+(.+)").unwrap()
-    });
-    let addr_plain_regex = ADDR_PLAIN_RE.get_or_init(|| {
-        Regex::new(r"^\s*([0-9a-fA-F]{4,})\s+(.+)").unwrap()
-    });
-    
-    let mut current_addr = 0x1000u64;
-    
-    for line in asm.lines() {
-        let line = line.trim();
-        
-        // Fast path: skip empty lines and comments
-        if line.is_empty() {
-            continue;
+    let chunk_len = (asm.len() / (rayon::current_num_threads() * 4)).max(PARSE_CHUNK_MIN);
+    parse_instructions_chunked(asm, chunk_len)
+}
+
+fn parse_instructions_chunked(asm: &str, chunk_len: usize) -> Vec<Instruction> {
+    let chunks: Vec<ParsedChunk> = split_at_newlines(asm, chunk_len)
+        .into_par_iter()
+        .map(parse_chunk)
+        .collect();
+    
+    // Lines before a chunk's first explicit address continue from where the
+    // previous chunk left off, which is only known once it has been parsed
+    let mut instructions = Vec::with_capacity(chunks.iter().map(|chunk| chunk.instructions.len()).sum());
+    let mut next_addr = LISTING_BASE;
+    for mut chunk in chunks {
+        for instr in &mut chunk.instructions[..chunk.unanchored] {
+            instr.address = instr.address.wrapping_add(next_addr);
         }
-        
-        // UTF-8 SAFE: Use starts_with() instead of byte indexing
-        // This prevents crashes when decompiling binaries with encoding issues
-        if line.starts_with(';') || line.starts_with('#') {
-            continue;
+        next_addr = chunk.next_addr.unwrap_or(next_addr.wrapping_add(chunk.steps));
+        instructions.append(&mut chunk.instructions);
+    }
+    instructions
+}
+
+/// Cut `text` into pieces of at least `chunk_len` bytes, each ending just
+/// after a newline (the last one takes the remainder)
+fn split_at_newlines(text: &str, chunk_len: usize) -> Vec<&str> {
+    let mut chunks = Vec::with_capacity(text.len() / chunk_len + 1);
+    let mut rest = text;
+    while rest.len() > chunk_len {
+        match memchr::memchr(b'\n', &rest.as_bytes()[chunk_len..]) {
+            Some(offset) => {
+                let (chunk, tail) = rest.split_at(chunk_len + offset + 1);
+                chunks.push(chunk);
+                rest = tail;
+            }
+            None => break,
         }
-        if line.starts_with("//") {
+    }
+    chunks.push(rest);
+    chunks
+}
+
+/// Instructions of one chunk of a listing. Until the chunk's first explicit
+/// address, addresses are offsets from wherever the previous chunk ended.
+struct ParsedChunk {
+    instructions: Vec<Instruction>,
+    /// Number of leading instructions with offset addresses
+    unanchored: usize,
+    /// Address following the chunk, if it contained an explicit address
+    next_addr: Option<u64>,
+    /// Lines that advanced the address, for chunks without an explicit one
+    steps: u64,
+}
+
+fn parse_chunk(text: &str) -> ParsedChunk {
+    let bytes = text.as_bytes();
+    let mut instructions = Vec::with_capacity(memchr::memchr_iter(b'\n', bytes).count() + 1);
+    let mut current_addr = 0u64;
+    let mut anchored = false;
+    let mut unanchored = 0;
+    let mut line_start = 0;
+    
+    for line_end in memchr::memchr_iter(b'\n', bytes).chain(std::iter::once(bytes.len())) {
+        let line = text[line_start..line_end].trim();
+        line_start = line_end + 1;
+        
+        // Skip empty lines and comments
+        if line.is_empty() || line.starts_with(';') || line.starts_with('#') || line.starts_with("//") {
             continue;
         }
         
@@ -2695,79 +3214,139 @@ fn parse_instructions(asm: &str) -> Vec<Instruction> {
             continue;
         }
         
-        // Fast path: try to parse address and instruction in one go
-        let (address, instruction_text) = if let Some(caps) = addr_colon_regex.captures(line) {
-            let addr_str = caps.get(1).unwrap().as_str();
-            let rest = caps.get(2).unwrap().as_str();
-            if let Ok(addr) = u64::from_str_radix(addr_str, 16) {
-                current_addr = addr + 1;
-                (addr, rest)
-            } else {
-                let addr = current_addr;
-                current_addr += 1;
-                (addr, line)
-            }
-        } else if let Some(caps) = addr_0x_regex.captures(line) {
-            let addr_str = caps.get(1).unwrap().as_str();
-            let rest = caps.get(2).unwrap().as_str();
-            if let Ok(addr) = u64::from_str_radix(addr_str, 16) {
-                current_addr = addr + 1;
+        let (address, instruction_text) = match split_listing_address(line) {
+            Some((addr, rest)) => {
+                anchored = true;
                 (addr, rest)
-            } else {
-                let addr = current_addr;
-                current_addr += 1;
-                (addr, line)
-            }
-        } else if let Some(caps) = addr_plain_regex.captures(line) {
-            let addr_str = caps.get(1).unwrap().as_str();
-            let rest = caps.get(2).unwrap().as_str();
-            if let Ok(addr) = u64::from_str_radix(addr_str, 16) {
-                current_addr = addr + 1;
-                (addr, rest)
-            } else {
-                let addr = current_addr;
-                current_addr += 1;
-                (addr, line)
             }
-        } else {
-            let addr = current_addr;
-            current_addr += 1;
-            (addr, line)
+            None => (current_addr, line),
         };
+        current_addr = address.wrapping_add(1);
         
-        let instruction_text = instruction_text.trim();
+        let Some((mnemonic, operands)) = split_mnemonic(instruction_text) else {
+            continue;
+        };
         
-        // UTF-8 SAFE: Use split_whitespace() instead of byte slicing
-        // This prevents crashes when instruction text contains multi-byte UTF-8
-        let mut parts = instruction_text.split_whitespace();
-        if let Some(mnemonic) = parts.next() {
-            // Skip hex bytes (2-char hex sequences)
-            if mnemonic.len() == 2 && mnemonic.chars().all(|c| c.is_ascii_hexdigit()) {
-                continue;
-            }
-            
-            if !mnemonic.is_empty() {
-                // Collect remaining parts as operands
-                let operands: Vec<&str> = parts.collect();
-                let operands_str = operands.join(" ");
-                
-                instructions.push(Instruction {
-                    address,
-                    mnemonic: mnemonic.to_lowercase(),
-                    operands: operands_str,
-                    raw_line: line.to_string(),
-                });
-            }
+        // Skip hex bytes (2-char hex sequences)
+        if mnemonic.len() == 2 && mnemonic.bytes().all(|b| b.is_ascii_hexdigit()) {
+            continue;
+        }
+        
+        let lowercase;
+        let mnemonic = if mnemonic.bytes().any(|b| b.is_ascii_uppercase()) {
+            lowercase = mnemonic.to_ascii_lowercase();
+            lowercase.as_str()
+        } else {
+            mnemonic
+        };
+        
+        instructions.push(Instruction::new(address, mnemonic, &collapse_whitespace(operands)).with_raw_line(line));
+        if !anchored {
+            unanchored += 1;
         }
     }
     
-    instructions
+    ParsedChunk {
+        instructions,
+        unanchored,
+        next_addr: anchored.then_some(current_addr),
+        steps: current_addr,
+    }
 }
 
-fn parse_pe_file(path: &str) -> Option<PEInfo> {
-    let buffer = fs::read(path).ok()?;
-    let pe = PE::parse(&buffer).ok()?;
+/// Leading address of a trimmed listing line and the instruction text after
+/// it, or `None` when the line has no (parsable) address
+fn split_listing_address(line: &str) -> Option<(u64, &str)> {
+    let digits = hex_prefix_len(line);
+    
+    // `401000: [byte dump] mnemonic ...`
+    if digits > 0 && line.as_bytes().get(digits) == Some(&b':') {
+        let addr = u64::from_str_radix(&line[..digits], 16).ok()?;
+        return Some((addr, skip_byte_dump(&line[digits + 1..])));
+    }
+    
+    // `0x401000 mnemonic ...`
+    if let Some(hex) = line.strip_prefix("0x") {
+        let digits = hex_prefix_len(hex);
+        if digits == 0 {
+            return None;
+        }
+        let rest = after_whitespace(&hex[digits..])?;
+        return u64::from_str_radix(&hex[..digits], 16).ok().map(|addr| (addr, rest));
+    }
+    
+    // `00401000 mnemonic ...`
+    if digits >= 4 && line.as_bytes()[..digits].iter().any(u8::is_ascii_digit) {
+        let rest = after_whitespace(&line[digits..])?;
+        return u64::from_str_radix(&line[..digits], 16).ok().map(|addr| (addr, rest));
+    }
     
+    None
+}
+
+fn hex_prefix_len(text: &str) -> usize {
+    text.bytes().take_while(u8::is_ascii_hexdigit).count()
+}
+
+/// `text` without its leading whitespace, provided there was some and
+/// something follows it
+fn after_whitespace(text: &str) -> Option<&str> {
+    let rest = text.trim_start();
+    (rest.len() < text.len() && !rest.is_empty()).then_some(rest)
+}
+
+/// Drop the instruction bytes objdump-style listings print after the
+/// address (`55`, `48 89 e5` or `4889e5`). A token counts as bytes when it is
+/// an even number of hex digits and is either a single byte or contains a
+/// decimal digit, so hex-only mnemonics (`add`, `fadd`) are kept.
+fn skip_byte_dump(text: &str) -> &str {
+    let mut rest = text.trim_start();
+    loop {
+        let token_len = rest.bytes().take_while(|b| !b.is_ascii_whitespace()).count();
+        let token = &rest.as_bytes()[..token_len];
+        let is_bytes = token_len % 2 == 0
+            && token.iter().all(u8::is_ascii_hexdigit)
+            && (token_len == 2 || token.iter().any(u8::is_ascii_digit));
+        // The last token is the instruction even if it looks like a byte
+        if token_len == 0 || !is_bytes || token_len == rest.len() {
+            return rest;
+        }
+        rest = rest[token_len..].trim_start();
+    }
+}
+
+/// Split trimmed instruction text into mnemonic and operand text
+fn split_mnemonic(text: &str) -> Option<(&str, &str)> {
+    if text.is_empty() {
+        return None;
+    }
+    match text.bytes().position(|b| b.is_ascii_whitespace()) {
+        Some(end) => Some((&text[..end], text[end..].trim_start())),
+        None => Some((text, "")),
+    }
+}
+
+/// Operand text with every whitespace run collapsed to one space; borrowed
+/// unless the listing actually used tabs or repeated spaces
+fn collapse_whitespace(text: &str) -> Cow<'_, str> {
+    let bytes = text.as_bytes();
+    let clean = bytes
+        .iter()
+        .enumerate()
+        .all(|(i, &b)| if b == b' ' { bytes.get(i + 1) != Some(&b' ') } else { !b.is_ascii_whitespace() });
+    if clean {
+        Cow::Borrowed(text)
+    } else {
+        Cow::Owned(text.split_ascii_whitespace().collect::<Vec<_>>().join(" "))
+    }
+}
+
+fn parse_pe_file(path: &str) -> Option<PEInfo> {
+    let image = LoadedImage::open(Path::new(path)).ok()?;
+    Some(PEInfo { image: Some(Arc::clone(&image)), ..pe_info_from(image.pe()) })
+}
+
+fn pe_info_from(pe: &PE) -> PEInfo {
     let image_base = pe.image_base as u64;
     let entry_point = image_base + pe.entry as u64;
     
@@ -2803,12 +3382,219 @@ fn parse_pe_file(path: &str) -> Option<PEInfo> {
         }
     }
     
-    Some(PEInfo {
+    PEInfo {
         image_base,
         entry_point,
         sections,
         imports,
         exports,
         iat_range: None,
-    })
-}
\ No newline at end of file
+        functions: FunctionIndex::from_pe(pe),
+        image: None,
+    }
+}
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_basic_blocks_from_leader_bitmap() {
+        // Padding first so block ranges have to be offset by the span start
+        let mut instructions = vec![Instruction::new(0x0c, "nop", ""); 2];
+        instructions.extend([
+            Instruction::new(0x10, "test", "ecx, ecx"),
+            Instruction::new(0x12, "je", "0x1a"),
+            Instruction::new(0x14, "inc", "eax"),
+            Instruction::new(0x16, "call", "0x9000"),
+            Instruction::new(0x1a, "ret", ""),
+            Instruction::new(0x1b, "int3", ""),
+        ]);
+        let blocks = build_basic_blocks(&instructions, 2..8, None);
+        let ranges: Vec<Range<usize>> = blocks.iter().map(|b| b.range.clone()).collect();
+        assert_eq!(ranges, vec![2..4, 4..6, 6..7, 7..8]);
+        assert_eq!(blocks[2].start_addr, 0x1a);
+    }
+
+    #[test]
+    fn test_listing_formats_and_chunk_stitching() {
+        let listing = "\
+.text:
+; comment
+401000: 55 48 89 e5  PUSH   rbp
+0x401004 mov\trbp, rsp
+00401008 fadd st0, st1
+add eax, 1
+401010: c3
+sub   rsp,   0x20
+";
+        let instructions = parse_instructions_chunked(listing, usize::MAX);
+        let parsed: Vec<(u64, &str, &str)> = instructions
+            .iter()
+            .map(|instr| (instr.address, instr.mnemonic.as_str(), &*instr.operands))
+            .collect();
+        assert_eq!(parsed, vec![
+            (0x401000, "push", "rbp"),
+            (0x401004, "mov", "rbp, rsp"),
+            (0x401008, "fadd", "st0, st1"),
+            (0x401009, "add", "eax, 1"),
+            (0x401011, "sub", "rsp, 0x20"),
+        ]);
+        assert_eq!(instructions[0].raw_line.as_deref(), Some("401000: 55 48 89 e5  PUSH   rbp"));
+        
+        // One line per chunk: unaddressed lines still follow the previous chunk
+        let chunked = parse_instructions_chunked(listing, 1);
+        assert_eq!(chunked.iter().map(|instr| instr.address).collect::<Vec<_>>(), parsed.iter().map(|p| p.0).collect::<Vec<_>>());
+        let unaddressed = parse_instructions_chunked("nop\nnop\nnop\n", 1);
+        assert_eq!(unaddressed.iter().map(|instr| instr.address).collect::<Vec<_>>(), vec![0x1000, 0x1001, 0x1002]);
+    }
+
+    #[test]
+    fn test_render_all_matches_single_backends() {
+        let listing = "\
+401000: push rbp
+401001: mov rbp, rsp
+401004: mov dword ptr [rbp - 4], ecx
+401007: call 0x401010
+40100c: pop rbp
+40100d: ret
+401010: push rbp
+401011: mov eax, dword ptr [rsp + 8]
+401015: test eax, eax
+401017: je 0x40101c
+401019: add eax, 1
+40101c: pop rbp
+40101d: ret
+";
+        let instructions = parse_instructions(listing);
+        let session = AnalysisSession::new(&instructions, None);
+        let (pseudo, c, rust) = session.render_all();
+        assert_eq!(pseudo, session.render_pseudo());
+        assert_eq!(c, session.render_c());
+        assert_eq!(rust, session.render_rust());
+        
+        // A fresh session renders the same text backend by backend
+        let fresh = AnalysisSession::new(&instructions, None);
+        assert_eq!((fresh.render_pseudo(), fresh.render_c(), fresh.render_rust()), (pseudo, c, rust));
+    }
+
+    #[test]
+    fn test_patch_reanalyses_only_the_patched_function() {
+        let listing = |value: u32| format!("\
+401000: push rbp
+401001: mov rbp, rsp
+401004: mov eax, dword ptr [rbp + 0x10]
+401007: call 0x401010
+40100c: pop rbp
+40100d: ret
+401010: push rbp
+401011: mov rbp, rsp
+401014: mov eax, {:#x}
+401019: pop rbp
+40101a: ret
+", value);
+        let dir = std::env::temp_dir().join(format!("cataclysm-session-cache-{}", std::process::id()));
+        let cache = AnalysisCache::open(&dir).unwrap();
+        let cached = |session: &AnalysisSession| session.functions.iter().map(|f| f.cached.is_some()).collect::<Vec<_>>();
+
+        let original = parse_instructions(&listing(1));
+        let first = AnalysisSession::with_cache(&original, None, Some(&cache));
+        assert_eq!(cached(&first), vec![false, false]);
+        let outputs = first.render_all();
+
+        let again = AnalysisSession::with_cache(&original, None, Some(&cache));
+        assert_eq!(cached(&again), vec![true, true]);
+        assert_eq!(again.render_all(), outputs);
+
+        // Patching the callee leaves its caller's entry valid
+        let patched = parse_instructions(&listing(2));
+        let session = AnalysisSession::with_cache(&patched, None, Some(&cache));
+        assert_eq!(cached(&session), vec![true, false]);
+        assert_eq!(session.render_all(), AnalysisSession::new(&patched, None).render_all());
+        let _ = std::fs::remove_dir_all(&dir);
+    }
+
+    #[test]
+    fn test_passes_run_on_large_input() {
+        // Well past the old 5000-instruction cutoff
+        let instructions: Vec<Instruction> = (0..3000u64)
+            .flat_map(|i| [
+                Instruction::new(i * 4, "push", "rbx"),
+                Instruction::new(i * 4 + 1, "pop", "rbx"),
+                Instruction::new(i * 4 + 2, "mov", "eax, 0x67452301"),
+            ])
+            .collect();
+        let passes = run_analysis_passes(&instructions, None);
+        assert_eq!(passes.junk_removed, 6000);
+        assert_eq!(passes.instructions.len(), 3000);
+        assert_eq!(passes.report.mode(), "FULL (junk filter, deobfuscation, crypto detection)");
+    }
+
+    #[test]
+    fn test_extract_constant_without_regex() {
+        assert_eq!(extract_constant(&Operands::new("eax, 0x67452301")), Some(0x67452301));
+        assert_eq!(extract_constant(&Operands::new("ecx, 14")), Some(14));
+        assert_eq!(extract_constant(&Operands::new("r8d, dword ptr [rax]")), None);
+        assert_eq!(extract_constant(&Operands::new("xmm1, xmm2")), None);
+    }
+
+    #[test]
+    fn test_crypto_constants_single_pass() {
+        let instructions: Vec<Instruction> = [0x67452301u32, 0xefcdab89, 0x98badcfe, 0x10325476]
+            .iter()
+            .enumerate()
+            .map(|(i, c)| Instruction::new(0x1000 + i as u64 * 5, "mov", &format!("dword ptr [rcx + {}], 0x{:x}", i * 4, c)))
+            .collect();
+        let (sigs, complete) = detect_crypto_algorithms(&instructions, &[], Instant::now() + PASS_TIME_BUDGET);
+        assert!(complete);
+        assert_eq!(sigs.len(), 1);
+        assert_eq!(sigs[0].algorithm, CryptoAlgorithm::SHA1);
+        assert_eq!(sigs[0].location, 0x1000);
+        assert_eq!(sigs[0].evidence.len(), 4);
+    }
+
+    #[test]
+    fn test_rc4_needs_a_key_schedule_loop() {
+        // Small constants and mov/add/xor on their own are not RC4
+        let generic: Vec<Instruction> = (0..2000u64)
+            .map(|i| Instruction::new(0x1000 + i * 4, ["mov", "add", "xor"][i as usize % 3], &format!("eax, {}", i % 4)))
+            .collect();
+        let (sigs, _) = detect_crypto_algorithms(&generic, &[], Instant::now() + PASS_TIME_BUDGET);
+        assert!(sigs.iter().all(|sig| sig.algorithm != CryptoAlgorithm::RC4));
+
+        // for (i = 0; i < 256; i++) { j += S[i] + key[i]; swap(S[i], S[j]); }
+        let ksa = [
+            (0x2000, "movzx", "eax, byte ptr [rdi + rcx]"),
+            (0x2004, "add", "edx, eax"),
+            (0x2006, "movzx", "r8d, byte ptr [rsi + rcx]"),
+            (0x200b, "add", "edx, r8d"),
+            (0x200e, "movzx", "edx, dl"),
+            (0x2011, "movzx", "r9d, byte ptr [rdi + rdx]"),
+            (0x2016, "mov", "byte ptr [rdi + rcx], r9b"),
+            (0x201a, "mov", "byte ptr [rdi + rdx], al"),
+            (0x201d, "inc", "rcx"),
+            (0x2020, "cmp", "rcx, 0x100"),
+            (0x2027, "jne", "0x2000"),
+        ];
+        let instructions: Vec<Instruction> = ksa.iter().map(|&(a, m, o)| Instruction::new(a, m, o)).collect();
+        let (sigs, _) = detect_crypto_algorithms(&instructions, &[], Instant::now() + PASS_TIME_BUDGET);
+        let rc4 = sigs.iter().find(|sig| sig.algorithm == CryptoAlgorithm::RC4).expect("RC4 detected");
+        assert_eq!(rc4.location, 0x2000);
+    }
+
+    #[test]
+    fn test_instruction_mix_needs_specific_evidence() {
+        // Every pattern's mnemonics plus DES/AES-sized immediates, many times over
+        let mnemonics = ["add", "shl", "shr", "and", "movzx", "rol", "ror"];
+        let mut instructions: Vec<Instruction> = (0..3000u64)
+            .map(|i| Instruction::new(0x1000 + i * 4, mnemonics[i as usize % mnemonics.len()], &format!("eax, {}", [14, 4, 13, 0x63, 0x7c][i as usize % 5])))
+            .collect();
+        let (sigs, _) = detect_crypto_algorithms(&instructions, &[], Instant::now() + PASS_TIME_BUDGET);
+        assert!(sigs.is_empty(), "{:?}", sigs);
+
+        // One distinctive constant lets the mix count
+        instructions.push(Instruction::new(0x4000, "mov", "ecx, 0x9e3779b9"));
+        let (sigs, _) = detect_crypto_algorithms(&instructions, &[], Instant::now() + PASS_TIME_BUDGET);
+        assert_eq!(sigs.iter().map(|sig| &sig.algorithm).collect::<Vec<_>>(), vec![&CryptoAlgorithm::TEA]);
+        assert_eq!(sigs[0].location, 0x4000);
+    }
+}
@@ -0,0 +1,924 @@
+// ============================================================================
+// COMPACT INSTRUCTION IR
+// ============================================================================
+// The one `Instruction` record shared by the disassembler, the decompiler,
+// the anti-obfuscation passes and the scripting API. Mnemonics are interned
+// into a 16-bit id that also keys a static classification table (flow class,
+// condition, flag effects, destination role), and operand text is shared
+// (`Arc<str>`) together with the pieces the passes keep asking for (operand
+// spans, operand kinds, decoded registers, the first immediate), decoded once
+// when the instruction is built. Cloning an instruction is a refcount bump
+// instead of three heap allocations, and classifying one is a table lookup.
+// ============================================================================
+
+use serde::{Deserialize, Serialize};
+use std::collections::HashMap;
+use std::fmt;
+use std::hash::{Hash, Hasher};
+use std::ops::Deref;
+use std::sync::{Arc, OnceLock, RwLock};
+
+// ============================================================================
+// MNEMONIC INTERNER
+// ============================================================================
+
+// Names live in lazily allocated chunks of write-once slots, so resolving an
+// id is two atomic loads and never takes a lock. Only interning a name that
+// has not been seen before takes the write lock. Each slot carries the
+// mnemonic's classification next to its name.
+const CHUNK_LEN: usize = 1024;
+const CHUNK_COUNT: usize = 64;
+
+type Entry = (&'static str, MnemonicInfo);
+
+static NAMES: [OnceLock<Box<[OnceLock<Entry>]>>; CHUNK_COUNT] = [const { OnceLock::new() }; CHUNK_COUNT];
+static IDS: OnceLock<RwLock<HashMap<&'static str, u16>>> = OnceLock::new();
+
+fn name_slot(id: usize) -> &'static OnceLock<Entry> {
+    let chunk = NAMES[id / CHUNK_LEN].get_or_init(|| (0..CHUNK_LEN).map(|_| OnceLock::new()).collect());
+    &chunk[id % CHUNK_LEN]
+}
+
+/// The interner starts out holding the known mnemonics at their fixed ids
+fn ids() -> &'static RwLock<HashMap<&'static str, u16>> {
+    IDS.get_or_init(|| {
+        let mut ids = HashMap::with_capacity(KNOWN.len() * 2);
+        for (id, entry) in KNOWN.iter().enumerate() {
+            let _ = name_slot(id).set(*entry);
+            ids.insert(entry.0, id as u16);
+        }
+        RwLock::new(ids)
+    })
+}
+
+/// Interned instruction mnemonic. Derefs to `str` and compares against string
+/// literals, so `instr.mnemonic == "ret"` keeps working, but passes should
+/// compare against the `Mnemonic::RET`-style constants or branch on
+/// [`Mnemonic::info`] instead.
+#[derive(Clone, Copy, PartialEq, Eq, Hash, Default)]
+pub struct Mnemonic(u16);
+
+impl Mnemonic {
+    /// Intern `name`. Past 65536 distinct names (only reachable with garbage
+    /// text input) the empty mnemonic is returned.
+    pub fn intern(name: &str) -> Mnemonic {
+        let ids = ids();
+        if let Some(&id) = ids.read().unwrap().get(name) {
+            return Mnemonic(id);
+        }
+
+        let mut ids = ids.write().unwrap();
+        if let Some(&id) = ids.get(name) {
+            return Mnemonic(id);
+        }
+        let id = ids.len();
+        if id >= CHUNK_LEN * CHUNK_COUNT {
+            return Mnemonic::default();
+        }
+        let name: &'static str = Box::leak(name.into());
+        let _ = name_slot(id).set((name, derive_info(name)));
+        ids.insert(name, id as u16);
+        Mnemonic(id as u16)
+    }
+
+    fn entry(self) -> Option<&'static Entry> {
+        let id = self.0 as usize;
+        if let Some(entry) = KNOWN.get(id) {
+            return Some(entry);
+        }
+        NAMES[id / CHUNK_LEN].get().and_then(|chunk| chunk[id % CHUNK_LEN].get())
+    }
+
+    pub fn as_str(&self) -> &'static str {
+        self.entry().map_or("", |entry| entry.0)
+    }
+
+    /// Static classification of this mnemonic
+    pub fn info(self) -> &'static MnemonicInfo {
+        self.entry().map_or(&SEQUENTIAL, |entry| &entry.1)
+    }
+}
+
+impl Deref for Mnemonic {
+    type Target = str;
+
+    fn deref(&self) -> &str {
+        self.as_str()
+    }
+}
+
+impl PartialEq<str> for Mnemonic {
+    fn eq(&self, other: &str) -> bool {
+        self.as_str() == other
+    }
+}
+
+impl PartialEq<&str> for Mnemonic {
+    fn eq(&self, other: &&str) -> bool {
+        self.as_str() == *other
+    }
+}
+
+impl fmt::Display for Mnemonic {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.pad(self.as_str())
+    }
+}
+
+impl fmt::Debug for Mnemonic {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        fmt::Debug::fmt(self.as_str(), f)
+    }
+}
+
+// ============================================================================
+// MNEMONIC CLASSIFICATION TABLE
+// ============================================================================
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum FlowClass {
+    Sequential,
+    Jump,
+    CondJump,
+    Call,
+    Return,
+    /// Execution does not continue (`hlt`, `ud2`, `int3`)
+    Stop,
+}
+
+/// Condition a conditional jump (or `setcc`/`cmovcc`) tests
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Condition {
+    Equal,
+    NotEqual,
+    Greater,
+    GreaterEqual,
+    Less,
+    LessEqual,
+    Above,
+    AboveEqual,
+    Below,
+    BelowEqual,
+    Overflow,
+    NoOverflow,
+    Sign,
+    NoSign,
+    Parity,
+    NoParity,
+    /// `jcxz`/`jecxz`/`jrcxz`
+    CountZero,
+    /// `loop` family
+    CountNonZero,
+}
+
+/// What the instruction does to its first operand
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum DestRole {
+    /// Only read, or there is no operand (`cmp`, `push`, `jmp`)
+    Read,
+    Write,
+    ReadWrite,
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct MnemonicInfo {
+    pub flow: FlowClass,
+    pub cond: Option<Condition>,
+    pub reads_flags: bool,
+    pub writes_flags: bool,
+    pub dest: DestRole,
+}
+
+impl MnemonicInfo {
+    /// Transfers control somewhere other than the next instruction
+    pub fn is_branch(&self) -> bool {
+        matches!(self.flow, FlowClass::Jump | FlowClass::CondJump | FlowClass::Call)
+    }
+
+    /// Falls off the end of a function or stops execution
+    pub fn is_exit(&self) -> bool {
+        matches!(self.flow, FlowClass::Return | FlowClass::Stop)
+    }
+}
+
+const fn info(flow: FlowClass, cond: Option<Condition>, reads_flags: bool, writes_flags: bool, dest: DestRole) -> MnemonicInfo {
+    MnemonicInfo { flow, cond, reads_flags, writes_flags, dest }
+}
+
+const SEQUENTIAL: MnemonicInfo = info(FlowClass::Sequential, None, false, false, DestRole::Read);
+/// Plain data movement: writes its destination, leaves flags alone
+const MOVE: MnemonicInfo = info(FlowClass::Sequential, None, false, false, DestRole::Write);
+/// Arithmetic/logic: reads and writes its destination, sets flags
+const ALU: MnemonicInfo = info(FlowClass::Sequential, None, false, true, DestRole::ReadWrite);
+/// Arithmetic that also consumes the carry flag
+const ALU_CARRY: MnemonicInfo = info(FlowClass::Sequential, None, true, true, DestRole::ReadWrite);
+/// Comparison: reads its operands, sets flags
+const COMPARE: MnemonicInfo = info(FlowClass::Sequential, None, false, true, DestRole::Read);
+const JUMP: MnemonicInfo = info(FlowClass::Jump, None, false, false, DestRole::Read);
+const CALL: MnemonicInfo = info(FlowClass::Call, None, false, false, DestRole::Read);
+const RETURN: MnemonicInfo = info(FlowClass::Return, None, false, false, DestRole::Read);
+const STOP: MnemonicInfo = info(FlowClass::Stop, None, false, false, DestRole::Read);
+
+const fn jcc(cond: Condition) -> MnemonicInfo {
+    info(FlowClass::CondJump, Some(cond), true, false, DestRole::Read)
+}
+
+/// `loop`/`jcxz` test a counter register, not the flags
+const fn counted(cond: Condition) -> MnemonicInfo {
+    info(FlowClass::CondJump, Some(cond), false, false, DestRole::Read)
+}
+
+const fn setcc(cond: Condition) -> MnemonicInfo {
+    info(FlowClass::Sequential, Some(cond), true, false, DestRole::Write)
+}
+
+const fn cmovcc(cond: Condition) -> MnemonicInfo {
+    info(FlowClass::Sequential, Some(cond), true, false, DestRole::ReadWrite)
+}
+
+/// Each row gets a fixed id (its position) and a `Mnemonic::NAME` constant,
+/// so passes can match on mnemonics without touching the interner.
+macro_rules! mnemonic_table {
+    ($($konst:ident = $name:literal => $info:expr,)*) => {
+        #[allow(dead_code, non_camel_case_types, clippy::upper_case_acronyms)]
+        #[repr(u16)]
+        enum KnownId { Empty, $($konst,)* }
+
+        #[allow(dead_code)]
+        impl Mnemonic {
+            $(pub const $konst: Mnemonic = Mnemonic(KnownId::$konst as u16);)*
+        }
+
+        static KNOWN: &[Entry] = &[("", SEQUENTIAL), $(($name, $info),)*];
+    };
+}
+
+mnemonic_table! {
+    MOV = "mov" => MOVE,
+    MOVZX = "movzx" => MOVE,
+    MOVSX = "movsx" => MOVE,
+    MOVSXD = "movsxd" => MOVE,
+    LEA = "lea" => MOVE,
+    PUSH = "push" => SEQUENTIAL,
+    POP = "pop" => MOVE,
+    XCHG = "xchg" => info(FlowClass::Sequential, None, false, false, DestRole::ReadWrite),
+    ADD = "add" => ALU,
+    SUB = "sub" => ALU,
+    ADC = "adc" => ALU_CARRY,
+    SBB = "sbb" => ALU_CARRY,
+    INC = "inc" => ALU,
+    DEC = "dec" => ALU,
+    NEG = "neg" => ALU,
+    NOT = "not" => info(FlowClass::Sequential, None, false, false, DestRole::ReadWrite),
+    AND = "and" => ALU,
+    OR = "or" => ALU,
+    XOR = "xor" => ALU,
+    SHL = "shl" => ALU,
+    SAL = "sal" => ALU,
+    SHR = "shr" => ALU,
+    SAR = "sar" => ALU,
+    ROL = "rol" => ALU,
+    ROR = "ror" => ALU,
+    IMUL = "imul" => ALU,
+    MUL = "mul" => info(FlowClass::Sequential, None, false, true, DestRole::Read),
+    IDIV = "idiv" => info(FlowClass::Sequential, None, false, true, DestRole::Read),
+    DIV = "div" => info(FlowClass::Sequential, None, false, true, DestRole::Read),
+    CMP = "cmp" => COMPARE,
+    TEST = "test" => COMPARE,
+    CDQ = "cdq" => SEQUENTIAL,
+    CQO = "cqo" => SEQUENTIAL,
+    NOP = "nop" => SEQUENTIAL,
+    LEAVE = "leave" => SEQUENTIAL,
+    LODSB = "lodsb" => SEQUENTIAL,
+    LODSW = "lodsw" => SEQUENTIAL,
+    LODSD = "lodsd" => SEQUENTIAL,
+    INT = "int" => SEQUENTIAL,
+    SYSCALL = "syscall" => SEQUENTIAL,
+    CALL = "call" => CALL,
+    LCALL = "lcall" => CALL,
+    JMP = "jmp" => JUMP,
+    LJMP = "ljmp" => JUMP,
+    RET = "ret" => RETURN,
+    RETN = "retn" => RETURN,
+    RETF = "retf" => RETURN,
+    IRET = "iret" => RETURN,
+    IRETD = "iretd" => RETURN,
+    IRETQ = "iretq" => RETURN,
+    HLT = "hlt" => STOP,
+    UD2 = "ud2" => STOP,
+    INT3 = "int3" => STOP,
+    JE = "je" => jcc(Condition::Equal),
+    JZ = "jz" => jcc(Condition::Equal),
+    JNE = "jne" => jcc(Condition::NotEqual),
+    JNZ = "jnz" => jcc(Condition::NotEqual),
+    JG = "jg" => jcc(Condition::Greater),
+    JNLE = "jnle" => jcc(Condition::Greater),
+    JGE = "jge" => jcc(Condition::GreaterEqual),
+    JNL = "jnl" => jcc(Condition::GreaterEqual),
+    JL = "jl" => jcc(Condition::Less),
+    JNGE = "jnge" => jcc(Condition::Less),
+    JLE = "jle" => jcc(Condition::LessEqual),
+    JNG = "jng" => jcc(Condition::LessEqual),
+    JA = "ja" => jcc(Condition::Above),
+    JNBE = "jnbe" => jcc(Condition::Above),
+    JAE = "jae" => jcc(Condition::AboveEqual),
+    JNB = "jnb" => jcc(Condition::AboveEqual),
+    JNC = "jnc" => jcc(Condition::AboveEqual),
+    JB = "jb" => jcc(Condition::Below),
+    JC = "jc" => jcc(Condition::Below),
+    JNAE = "jnae" => jcc(Condition::Below),
+    JBE = "jbe" => jcc(Condition::BelowEqual),
+    JNA = "jna" => jcc(Condition::BelowEqual),
+    JO = "jo" => jcc(Condition::Overflow),
+    JNO = "jno" => jcc(Condition::NoOverflow),
+    JS = "js" => jcc(Condition::Sign),
+    JNS = "jns" => jcc(Condition::NoSign),
+    JP = "jp" => jcc(Condition::Parity),
+    JPE = "jpe" => jcc(Condition::Parity),
+    JNP = "jnp" => jcc(Condition::NoParity),
+    JPO = "jpo" => jcc(Condition::NoParity),
+    JCXZ = "jcxz" => counted(Condition::CountZero),
+    JECXZ = "jecxz" => counted(Condition::CountZero),
+    JRCXZ = "jrcxz" => counted(Condition::CountZero),
+    LOOP = "loop" => counted(Condition::CountNonZero),
+    LOOPE = "loope" => counted(Condition::CountNonZero),
+    LOOPNE = "loopne" => counted(Condition::CountNonZero),
+    SETE = "sete" => setcc(Condition::Equal),
+    SETNE = "setne" => setcc(Condition::NotEqual),
+    SETG = "setg" => setcc(Condition::Greater),
+    SETGE = "setge" => setcc(Condition::GreaterEqual),
+    SETL = "setl" => setcc(Condition::Less),
+    SETLE = "setle" => setcc(Condition::LessEqual),
+    SETA = "seta" => setcc(Condition::Above),
+    SETAE = "setae" => setcc(Condition::AboveEqual),
+    SETB = "setb" => setcc(Condition::Below),
+    SETBE = "setbe" => setcc(Condition::BelowEqual),
+    CMOVE = "cmove" => cmovcc(Condition::Equal),
+    CMOVNE = "cmovne" => cmovcc(Condition::NotEqual),
+    CMOVG = "cmovg" => cmovcc(Condition::Greater),
+    CMOVGE = "cmovge" => cmovcc(Condition::GreaterEqual),
+    CMOVL = "cmovl" => cmovcc(Condition::Less),
+    CMOVLE = "cmovle" => cmovcc(Condition::LessEqual),
+    CMOVA = "cmova" => cmovcc(Condition::Above),
+    CMOVAE = "cmovae" => cmovcc(Condition::AboveEqual),
+    CMOVB = "cmovb" => cmovcc(Condition::Below),
+    CMOVBE = "cmovbe" => cmovcc(Condition::BelowEqual),
+}
+
+/// Classification for a mnemonic outside the table, worked out once when it
+/// is first interned. Only the families whose shape is obvious from the name
+/// get more than `SEQUENTIAL`.
+fn derive_info(name: &str) -> MnemonicInfo {
+    if name.starts_with("loop") {
+        counted(Condition::CountNonZero)
+    } else if name.starts_with('j') {
+        info(FlowClass::CondJump, None, true, false, DestRole::Read)
+    } else if name.starts_with("set") {
+        info(FlowClass::Sequential, None, true, false, DestRole::Write)
+    } else if name.starts_with("cmov") {
+        info(FlowClass::Sequential, None, true, false, DestRole::ReadWrite)
+    } else {
+        SEQUENTIAL
+    }
+}
+
+// ============================================================================
+// REGISTERS
+// ============================================================================
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum RegClass {
+    General,
+    InstructionPointer,
+    Vector,
+    Segment,
+}
+
+/// A register operand decoded from its name. `number` is the architectural
+/// register number (rax/eax/ax/al = 0 ... r15 = 15, xmm3 = 3), so the
+/// sub-registers of one general register compare equal on it.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Register {
+    pub class: RegClass,
+    pub number: u8,
+    /// Width in bytes
+    pub width: u8,
+}
+
+const GPR64: [&str; 8] = ["rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi"];
+const GPR32: [&str; 8] = ["eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi"];
+const GPR16: [&str; 8] = ["ax", "cx", "dx", "bx", "sp", "bp", "si", "di"];
+const GPR8: [&str; 8] = ["al", "cl", "dl", "bl", "spl", "bpl", "sil", "dil"];
+const GPR8_HIGH: [&str; 4] = ["ah", "ch", "dh", "bh"];
+const SEGMENTS: [&str; 6] = ["es", "cs", "ss", "ds", "fs", "gs"];
+
+impl Register {
+    const STACK_POINTER: u8 = 4;
+    const FRAME_POINTER: u8 = 5;
+
+    /// Decode a register name in either case; `None` for anything else
+    pub fn parse(name: &str) -> Option<Register> {
+        let mut buf = [0u8; 6];
+        if name.is_empty() || name.len() > buf.len() {
+            return None;
+        }
+        for (dst, src) in buf.iter_mut().zip(name.bytes()) {
+            *dst = src.to_ascii_lowercase();
+        }
+        let name = std::str::from_utf8(&buf[..name.len()]).ok()?;
+
+        let general = |number: usize, width: u8| Some(Register { class: RegClass::General, number: number as u8, width });
+        for (names, width) in [(&GPR64, 8), (&GPR32, 4), (&GPR16, 2), (&GPR8, 1)] {
+            if let Some(number) = names.iter().position(|&n| n == name) {
+                return general(number, width);
+            }
+        }
+        if let Some(number) = GPR8_HIGH.iter().position(|&n| n == name) {
+            return general(number, 1);
+        }
+        if let Some(number) = SEGMENTS.iter().position(|&n| n == name) {
+            return Some(Register { class: RegClass::Segment, number: number as u8, width: 2 });
+        }
+        match name {
+            "rip" => return Some(Register { class: RegClass::InstructionPointer, number: 0, width: 8 }),
+            "eip" => return Some(Register { class: RegClass::InstructionPointer, number: 0, width: 4 }),
+            _ => {}
+        }
+
+        // r8..r15 with an optional d/w/b suffix
+        if let Some(rest) = name.strip_prefix('r') {
+            let (digits, width) = match rest.as_bytes().last()? {
+                b'd' => (&rest[..rest.len() - 1], 4),
+                b'w' => (&rest[..rest.len() - 1], 2),
+                b'b' => (&rest[..rest.len() - 1], 1),
+                _ => (rest, 8),
+            };
+            return match digits.parse::<u8>() {
+                Ok(number @ 8..=15) if !digits.starts_with('0') => general(number as usize, width),
+                _ => None,
+            };
+        }
+
+        // xmm/ymm/zmm 0..31
+        let width = match name.get(..3)? {
+            "xmm" => 16,
+            "ymm" => 32,
+            "zmm" => 64,
+            _ => return None,
+        };
+        let digits = &name[3..];
+        match digits.parse::<u8>() {
+            Ok(number @ 0..=31) if digits.len() == 1 || !digits.starts_with('0') => {
+                Some(Register { class: RegClass::Vector, number, width })
+            }
+            _ => None,
+        }
+    }
+
+    pub fn is_stack_pointer(self) -> bool {
+        self.class == RegClass::General && self.number == Self::STACK_POINTER && self.width >= 4
+    }
+
+    pub fn is_frame_pointer(self) -> bool {
+        self.class == RegClass::General && self.number == Self::FRAME_POINTER && self.width >= 4
+    }
+}
+
+impl fmt::Display for Register {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        let n = self.number as usize;
+        match (self.class, self.width) {
+            (RegClass::General, 8) if n < 8 => f.write_str(GPR64[n]),
+            (RegClass::General, 4) if n < 8 => f.write_str(GPR32[n]),
+            (RegClass::General, 2) if n < 8 => f.write_str(GPR16[n]),
+            (RegClass::General, 1) if n < 8 => f.write_str(GPR8[n]),
+            (RegClass::General, width) => {
+                let suffix = match width { 4 => "d", 2 => "w", 1 => "b", _ => "" };
+                write!(f, "r{}{}", n, suffix)
+            }
+            (RegClass::InstructionPointer, 8) => f.write_str("rip"),
+            (RegClass::InstructionPointer, _) => f.write_str("eip"),
+            (RegClass::Vector, 32) => write!(f, "ymm{}", n),
+            (RegClass::Vector, 64) => write!(f, "zmm{}", n),
+            (RegClass::Vector, _) => write!(f, "xmm{}", n),
+            (RegClass::Segment, _) => f.write_str(SEGMENTS.get(n).copied().unwrap_or("seg")),
+        }
+    }
+}
+
+// ============================================================================
+// PRE-DECODED OPERANDS
+// ============================================================================
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum OperandKind {
+    #[default]
+    None,
+    /// Register or symbol name
+    Reg,
+    Imm,
+    /// Anything with a `[...]` memory reference
+    Mem,
+}
+
+/// Byte span of one comma-separated operand inside the operand text
+#[derive(Debug, Clone, Copy, Default)]
+struct OperandSpan {
+    start: u16,
+    end: u16,
+    kind: OperandKind,
+    /// Set when the operand is a bare register
+    reg: Option<Register>,
+}
+
+const MAX_OPERANDS: usize = 3;
+
+/// Operand text plus its decoded layout. Derefs to the original text.
+#[derive(Clone, Default)]
+pub struct Operands {
+    text: Arc<str>,
+    spans: [OperandSpan; MAX_OPERANDS],
+    count: u8,
+    imm: Option<u64>,
+}
+
+impl Operands {
+    pub fn new(text: &str) -> Operands {
+        let mut operands = Operands {
+            text: Arc::from(text),
+            imm: first_hex_literal(text),
+            ..Operands::default()
+        };
+
+        // Spans are u16; absurdly long operand text keeps only the raw string
+        if text.len() <= u16::MAX as usize {
+            let mut start = 0;
+            for piece in text.split(',').take(MAX_OPERANDS) {
+                let end = start + piece.len();
+                let trimmed_start = start + (piece.len() - piece.trim_start().len());
+                let trimmed_end = end - (piece.len() - piece.trim_end().len());
+                if trimmed_start < trimmed_end {
+                    let trimmed = &text[trimmed_start..trimmed_end];
+                    let kind = classify_operand(trimmed);
+                    operands.spans[operands.count as usize] = OperandSpan {
+                        start: trimmed_start as u16,
+                        end: trimmed_end as u16,
+                        kind,
+                        reg: if kind == OperandKind::Reg { Register::parse(trimmed) } else { None },
+                    };
+                    operands.count += 1;
+                }
+                start = end + 1;
+            }
+        }
+
+        operands
+    }
+
+    /// The whole operand text
+    pub fn as_str(&self) -> &str {
+        &self.text
+    }
+
+    /// Number of operands (at most three are decoded)
+    pub fn count(&self) -> usize {
+        self.count as usize
+    }
+
+    /// The `index`-th operand, trimmed
+    pub fn get(&self, index: usize) -> Option<&str> {
+        (index < self.count()).then(|| {
+            let span = self.spans[index];
+            &self.text[span.start as usize..span.end as usize]
+        })
+    }
+
+    pub fn kind(&self, index: usize) -> OperandKind {
+        if index < self.count() { self.spans[index].kind } else { OperandKind::None }
+    }
+
+    /// The `index`-th operand as a register, if it is one
+    pub fn reg(&self, index: usize) -> Option<Register> {
+        if index < self.count() { self.spans[index].reg } else { None }
+    }
+
+    /// The `index`-th operand as a memory reference, if it is one whose
+    /// address is registers plus a constant. Decoded on demand: only the
+    /// frame analysis asks for it.
+    pub fn mem(&self, index: usize) -> Option<MemRef> {
+        if self.kind(index) == OperandKind::Mem { MemRef::parse(self.get(index)?) } else { None }
+    }
+
+    /// First `0x...` literal in the text: the target of a direct branch, or
+    /// the immediate/displacement otherwise
+    pub fn imm(&self) -> Option<u64> {
+        self.imm
+    }
+}
+
+/// `size ptr [base + index*scale +/- disp]`
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub struct MemRef {
+    pub base: Option<Register>,
+    pub index: Option<Register>,
+    pub scale: u8,
+    pub disp: i64,
+    /// Access width in bytes from the size prefix; 0 when there is none
+    pub width: u8,
+}
+
+impl MemRef {
+    fn parse(operand: &str) -> Option<MemRef> {
+        let open = operand.find('[')?;
+        let close = open + operand[open..].find(']')?;
+        let width = match operand[..open].split_whitespace().next() {
+            Some("byte") => 1,
+            Some("word") => 2,
+            Some("dword") => 4,
+            Some("qword") => 8,
+            Some("tbyte") => 10,
+            Some("xmmword") => 16,
+            Some("ymmword") => 32,
+            Some("zmmword") => 64,
+            _ => 0,
+        };
+        let mut mem = MemRef { width, ..MemRef::default() };
+
+        let inner = &operand[open + 1..close];
+        let mut negative = false;
+        let mut term_start = 0;
+        for (i, c) in inner.char_indices().chain(std::iter::once((inner.len(), '+'))) {
+            if c != '+' && c != '-' {
+                continue;
+            }
+            let term = inner[term_start..i].trim();
+            if !term.is_empty() {
+                mem.add_term(term, negative)?;
+            }
+            negative = c == '-';
+            term_start = i + 1;
+        }
+        Some(mem)
+    }
+
+    fn add_term(&mut self, term: &str, negative: bool) -> Option<()> {
+        let number = |text: &str| match text.strip_prefix("0x") {
+            Some(hex) => i64::from_str_radix(hex, 16).ok(),
+            None => text.parse::<i64>().ok(),
+        };
+
+        if let Some(value) = number(term) {
+            self.disp = self.disp.wrapping_add(if negative { value.wrapping_neg() } else { value });
+        } else if let Some((a, b)) = term.split_once('*') {
+            let (reg, scale) = match Register::parse(a.trim()) {
+                Some(reg) => (reg, number(b.trim())?),
+                None => (Register::parse(b.trim())?, number(a.trim())?),
+            };
+            if negative || self.index.is_some() {
+                return None;
+            }
+            self.index = Some(reg);
+            self.scale = u8::try_from(scale).ok()?;
+        } else {
+            let reg = Register::parse(term)?;
+            if negative {
+                return None;
+            }
+            if self.base.is_none() {
+                self.base = Some(reg);
+            } else if self.index.is_none() {
+                self.index = Some(reg);
+                self.scale = 1;
+            } else {
+                return None;
+            }
+        }
+        Some(())
+    }
+}
+
+fn classify_operand(operand: &str) -> OperandKind {
+    if operand.contains('[') {
+        OperandKind::Mem
+    } else if operand.starts_with(|c: char| c.is_ascii_digit() || c == '-') {
+        OperandKind::Imm
+    } else {
+        OperandKind::Reg
+    }
+}
+
+/// Same contract as matching `0x([0-9a-fA-F]+)` and parsing the first capture:
+/// the first run of hex digits after `0x`, or `None` if it overflows.
+fn first_hex_literal(text: &str) -> Option<u64> {
+    let bytes = text.as_bytes();
+    for i in 0..bytes.len().saturating_sub(1) {
+        if bytes[i] == b'0' && bytes[i + 1] == b'x' {
+            let digits = bytes[i + 2..].iter().take_while(|b| b.is_ascii_hexdigit()).count();
+            if digits > 0 {
+                return u64::from_str_radix(&text[i + 2..i + 2 + digits], 16).ok();
+            }
+        }
+    }
+    None
+}
+
+impl Deref for Operands {
+    type Target = str;
+
+    fn deref(&self) -> &str {
+        &self.text
+    }
+}
+
+impl PartialEq for Operands {
+    fn eq(&self, other: &Operands) -> bool {
+        self.text == other.text
+    }
+}
+
+impl Eq for Operands {}
+
+impl Hash for Operands {
+    fn hash<H: Hasher>(&self, state: &mut H) {
+        self.text.hash(state)
+    }
+}
+
+impl PartialEq<str> for Operands {
+    fn eq(&self, other: &str) -> bool {
+        &*self.text == other
+    }
+}
+
+impl PartialEq<&str> for Operands {
+    fn eq(&self, other: &&str) -> bool {
+        &*self.text == *other
+    }
+}
+
+impl fmt::Display for Operands {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.pad(&self.text)
+    }
+}
+
+impl fmt::Debug for Operands {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        fmt::Debug::fmt(&*self.text, f)
+    }
+}
+
+// ============================================================================
+// INSTRUCTION RECORD
+// ============================================================================
+
+/// One decoded instruction. Compact and cheap to clone: the mnemonic is an
+/// interned id and the operand text is shared. Serialises as plain text
+/// fields (`InstructionRecord`), the form scripts see.
+#[derive(Debug, Clone, Serialize, Deserialize)]
+#[serde(into = "InstructionRecord", from = "InstructionRecord")]
+pub struct Instruction {
+    pub address: u64,
+    pub mnemonic: Mnemonic,
+    pub operands: Operands,
+    /// Source line, only for instructions parsed out of a text listing
+    pub raw_line: Option<Arc<str>>,
+}
+
+impl Instruction {
+    /// Build a record from decoded parts.
+    pub fn new(address: u64, mnemonic: &str, operands: &str) -> Self {
+        Instruction {
+            address,
+            mnemonic: Mnemonic::intern(mnemonic),
+            operands: Operands::new(operands),
+            raw_line: None,
+        }
+    }
+
+    /// Attach the source line the instruction was parsed from
+    pub fn with_raw_line(mut self, line: &str) -> Self {
+        self.raw_line = Some(Arc::from(line));
+        self
+    }
+
+    /// True when the source line carries a label (`name:` or `addr:`)
+    pub fn has_label(&self) -> bool {
+        self.raw_line.as_deref().is_some_and(|line| line.contains(':'))
+    }
+}
+
+/// Serialised form of an `Instruction`; `raw_line` is empty for instructions
+/// that were decoded rather than parsed from a listing
+#[derive(Serialize, Deserialize)]
+struct InstructionRecord {
+    address: u64,
+    mnemonic: String,
+    operands: String,
+    #[serde(default)]
+    raw_line: String,
+}
+
+impl From<Instruction> for InstructionRecord {
+    fn from(instr: Instruction) -> Self {
+        InstructionRecord {
+            address: instr.address,
+            mnemonic: instr.mnemonic.as_str().to_string(),
+            operands: instr.operands.to_string(),
+            raw_line: instr.raw_line.as_deref().unwrap_or("").to_string(),
+        }
+    }
+}
+
+impl From<InstructionRecord> for Instruction {
+    fn from(record: InstructionRecord) -> Self {
+        let instr = Instruction::new(record.address, &record.mnemonic, &record.operands);
+        if record.raw_line.is_empty() {
+            instr
+        } else {
+            instr.with_raw_line(&record.raw_line)
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_mnemonic_interning() {
+        let a = Mnemonic::intern("vpxor");
+        assert_eq!(a, Mnemonic::intern("vpxor"));
+        assert_eq!(a, "vpxor");
+        assert_eq!(format!("{:<8}|", a), "vpxor   |");
+        assert_eq!(Mnemonic::default(), "");
+    }
+
+    #[test]
+    fn test_operands_decoded_once() {
+        let ops = Operands::new("qword ptr [rbp - 0x10], rax");
+        assert_eq!(ops.count(), 2);
+        assert_eq!(ops.get(0), Some("qword ptr [rbp - 0x10]"));
+        assert_eq!(ops.get(1), Some("rax"));
+        assert_eq!(ops.kind(0), OperandKind::Mem);
+        assert_eq!(ops.kind(1), OperandKind::Reg);
+        assert_eq!(ops.imm(), Some(0x10));
+        assert_eq!(Operands::new("0x401000").kind(0), OperandKind::Imm);
+        assert_eq!(Operands::new("").count(), 0);
+    }
+
+    #[test]
+    fn test_instruction_serializes_as_text() {
+        let decoded = Instruction::new(0x401000, "mov", "eax, 0x2a");
+        let json = serde_json::to_string(&decoded).unwrap();
+        assert_eq!(json, r#"{"address":4198400,"mnemonic":"mov","operands":"eax, 0x2a","raw_line":""}"#);
+        let back: Instruction = serde_json::from_str(&json).unwrap();
+        assert_eq!((back.address, back.mnemonic, back.operands.imm(), back.raw_line), (0x401000, Mnemonic::MOV, Some(0x2a), None));
+
+        let parsed: Instruction = serde_json::from_str(r#"{"address":16,"mnemonic":"ret","operands":"","raw_line":"10: ret"}"#).unwrap();
+        assert!(parsed.has_label());
+    }
+
+    #[test]
+    fn test_mnemonic_table() {
+        assert_eq!(Mnemonic::intern("jmp"), Mnemonic::JMP);
+        assert_eq!(Mnemonic::JNZ.as_str(), "jnz");
+        assert_eq!(Mnemonic::JNZ.info().cond, Some(Condition::NotEqual));
+        assert!(Mnemonic::JNZ.info().reads_flags);
+        assert_eq!(Mnemonic::RETN.info().flow, FlowClass::Return);
+        assert_eq!(Mnemonic::CMP.info().dest, DestRole::Read);
+        assert!(Mnemonic::CMP.info().writes_flags);
+        // Names outside the table are classified by family when interned
+        assert_eq!(Mnemonic::intern("jmpe").info().flow, FlowClass::CondJump);
+        assert_eq!(Mnemonic::intern("vpxor").info().flow, FlowClass::Sequential);
+        assert!(matches!(Mnemonic::intern("xor"), Mnemonic::XOR));
+    }
+
+    #[test]
+    fn test_register_decoding() {
+        let ops = Operands::new("EBP, r12d");
+        assert!(ops.reg(0).is_some_and(Register::is_frame_pointer));
+        assert_eq!(ops.reg(1), Some(Register { class: RegClass::General, number: 12, width: 4 }));
+        assert_eq!(Register::parse("xmm15").map(|r| r.width), Some(16));
+        assert_eq!(Register::parse("al"), Register::parse("rax").map(|r| Register { width: 1, ..r }));
+        assert_eq!(Register::parse("r16"), None);
+        assert_eq!(Register::parse("sub_401000"), None);
+        for name in ["rcx", "r9d", "sil", "xmm7", "gs"] {
+            assert_eq!(Register::parse(name).unwrap().to_string(), name);
+        }
+        assert_eq!(Operands::new("dword ptr [rbp - 4]").reg(0), None);
+    }
+
+    #[test]
+    fn test_memory_operand_decoding() {
+        let rbp = Register::parse("rbp");
+        let ops = Operands::new("dword ptr [rbp - 0x14], eax");
+        assert_eq!(ops.mem(0), Some(MemRef { base: rbp, index: None, scale: 0, disp: -0x14, width: 4 }));
+        assert_eq!(ops.mem(1), None);
+
+        let indexed = Operands::new("qword ptr [rsp + rcx*8 + 0x20]").mem(0).unwrap();
+        assert_eq!((indexed.index, indexed.scale, indexed.disp), (Register::parse("rcx"), 8, 0x20));
+        assert_eq!(Operands::new("[ebp+8]").mem(0).map(|m| (m.disp, m.width)), Some((8, 0)));
+        assert_eq!(Operands::new("qword ptr [rip + label]").mem(0), None);
+    }
+}
@@ -7,5 +7,6 @@ pub mod pe_reassembler;
 pub mod assembly_relocator;
 pub mod pe_builder;
 pub mod pe_fixer;
+pub mod pe_image;
 pub mod native_disassembler;
 pub mod enhanced_disasm;
\ No newline at end of file
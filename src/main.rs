@@ -14,12 +14,17 @@ use ratatui::text::Span;
 use ratatui::widgets::{Block, Borders, List, ListItem, ListState, Paragraph};
 use ratatui::Terminal;
 use tui_textarea::TextArea;
-use goblin::pe;
-use capstone::prelude::*;
 use arboard::Clipboard;
 
 mod decompiler;
+mod ir;
+mod cfg;
+mod dataflow;
+mod analysis_cache;
+mod pe_disasm;
+mod pe_image;
 mod anti_obfuscation;
+mod crypto_tables;
 mod scripting_api;
 mod theme_engine;
 mod script_editor;
@@ -369,7 +374,7 @@ fn is_exe_file(path: &PathBuf) -> bool {
     })
 }
 
-fn disassemble_exe(path: &PathBuf) -> Result<String, String> {
+fn decompile_exe(path: &PathBuf) -> Result<decompiler::Analysis, String> {
     // SAFETY: Check file size before loading to prevent crashes on huge files
     const MAX_FILE_SIZE: u64 = 100 * 1024 * 1024; // 100 MB limit
     
@@ -391,287 +396,12 @@ fn disassemble_exe(path: &PathBuf) -> Result<String, String> {
         ));
     }
     
-    let buffer = fs::read(path)
-        .map_err(|e| format!("Failed to read file: {}", e))?;
-    
-    // Validate PE file format before parsing
-    if buffer.len() < 2 {
-        return Err(
-            "File is too small to be a valid PE executable.\n\n\
-            This file does not appear to be a Windows executable (.exe/.dll).\n\
-            Please select a valid PE file.".to_string()
-        );
-    }
-    
-    // Check for MZ signature (DOS header magic number)
-    if buffer[0] != 0x4D || buffer[1] != 0x5A {  // "MZ" in ASCII
-        let actual_sig = format!("0x{:02x}{:02x}", buffer[1], buffer[0]);
-        return Err(format!(
-            "Invalid PE file format (DOS signature mismatch).\n\n\
-            Expected: 0x5a4d (\"MZ\" - valid Windows executable)\n\
-            Found:    {} (not a PE file)\n\n\
-            This file is NOT a Windows executable (.exe/.dll).\n\n\
-            Possible causes:\n\
-            • The file is corrupted or incomplete\n\
-            • The file is a different format (ELF, Mach-O, script, etc.)\n\
-            • The file was not compiled successfully\n\
-            • You selected the wrong file\n\n\
-            Please ensure you're selecting a valid Windows PE executable.",
-            actual_sig
-        ));
-    }
-    
-    let pe = pe::PE::parse(&buffer)
-        .map_err(|e| format!(
-            "Failed to parse PE file structure: {}\n\n\
-            The file has a valid DOS header but the PE structure is malformed.\n\n\
-            Possible causes:\n\
-            • The executable is corrupted\n\
-            • The file is packed/encrypted (use a unpacker first)\n\
-            • The PE headers are damaged\n\
-            • The file is not a standard Windows executable\n\n\
-            Try:\n\
-            • Recompiling the program\n\
-            • Using a different executable\n\
-            • Unpacking if it's a packed executable",
-            e
-        ))?;
-    
-    let mut disassembly = String::new();
-
-    // Detect architecture from PE header
-    let is_64bit = pe.is_64;
-    let arch_mode = if is_64bit {
-        capstone::arch::x86::ArchMode::Mode64
-    } else {
-        capstone::arch::x86::ArchMode::Mode32
-    };
-
-    let cs = Capstone::new()
-        .x86()
-        .mode(arch_mode)
-        .syntax(capstone::arch::x86::ArchSyntax::Intel)
-        .detail(true)
-        .build()
-        .map_err(|e| format!("Failed to initialize disassembler: {}", e))?;
-
-    // Get entry point to know where actual code starts
-    let entry_point = pe.entry as u64;
-    let _image_base = pe.image_base as u64;
-
-    // PERFORMANCE FIX: Limit disassembly to reasonable size
-    const MAX_INSTRUCTIONS: usize = 50000; // Limit to 50k instructions
-    const MAX_SECTION_SIZE: usize = 1024 * 1024; // 1MB per section max
-    let mut total_instructions = 0;
-    let mut total_nops = 0; // Track NOP instructions to detect data disassembly
+    let image = pe_image::LoadedImage::open(path)?;
+    decompiler::decompile_image(&image)
+}
 
-    for section in &pe.sections {
-        if section.characteristics & pe::section_table::IMAGE_SCN_MEM_EXECUTE != 0 {
-            let start = section.pointer_to_raw_data as usize;
-            let virtual_size = section.virtual_size as usize;
-            let raw_size = section.size_of_raw_data as usize;
-            
-            // Check if entry point is in this section FIRST
-            let section_va = section.virtual_address as u64;
-            let section_end_va = section_va + raw_size.max(virtual_size) as u64;
-            let entry_in_section = entry_point >= section_va && entry_point < section_end_va;
-            
-            // OPTIMIZATION: For small executables, ONLY disassemble the section with the entry point
-            // This prevents disassembling data sections that are marked as executable
-            if file_size < 100_000 && !entry_in_section {
-                disassembly.push_str(&format!("; Section: {} (VA: 0x{:X}) - SKIPPED (entry point not here)\n", 
-                    String::from_utf8_lossy(&section.name).trim_end_matches('\0'),
-                    section_va));
-                continue;
-            }
-            
-            // FIX: Use raw_size primarily, but cap at virtual_size if it's reasonable
-            // Rust executables often have virtual_size < raw_size due to alignment
-            let mut size = if virtual_size > 0 && virtual_size < raw_size && virtual_size > 0x100 {
-                // If virtual_size is reasonable (>256 bytes), use it
-                virtual_size
-            } else {
-                // Otherwise use raw_size (actual data on disk)
-                raw_size
-            };
-            
-            // PERFORMANCE FIX: Limit section size
-            if size > MAX_SECTION_SIZE {
-                size = MAX_SECTION_SIZE;
-                disassembly.push_str(&format!("; WARNING: Section truncated to {} bytes for performance\n", MAX_SECTION_SIZE));
-            }
-            
-            if start + size <= buffer.len() && size > 0 {
-                // 🔧 CRITICAL FIX: Start disassembly FROM the entry point, not section start!
-                // This prevents disassembling padding/data before actual code.
-                let (code_start, disasm_va) = if entry_in_section && entry_point >= section_va {
-                    let entry_offset_in_section = (entry_point - section_va) as usize;
-                    if entry_offset_in_section < size {
-                        // Start FROM the entry point
-                        (start + entry_offset_in_section, entry_point)
-                    } else {
-                        // Entry point beyond section? Use section start
-                        (start, section_va)
-                    }
-                } else {
-                    // Not the entry section, disassemble from start
-                    (start, section_va)
-                };
-                
-                let code_end = start + size;
-                if code_start >= code_end {
-                    continue; // Skip if entry is at/beyond section end
-                }
-                
-                let code = &buffer[code_start..code_end];
-                
-                disassembly.push_str(&format!("; Section: {} (VA: 0x{:X}, Size: 0x{:X}, Raw: 0x{:X}{})\n", 
-                    String::from_utf8_lossy(&section.name).trim_end_matches('\0'),
-                    section_va,
-                    size,
-                    raw_size,
-                    if entry_in_section { ", ENTRY POINT HERE" } else { "" }));
-                
-                if entry_in_section && disasm_va != section_va {
-                    disassembly.push_str(&format!("; 🎯 Starting disassembly from ENTRY POINT at VA: 0x{:X} (skipping {} bytes of padding)\n", 
-                        disasm_va, disasm_va - section_va));
-                }
-                
-                match cs.disasm_all(code, disasm_va) {
-                    Ok(insns) => {
-                        let mut last_addr = disasm_va; // 🔧 FIX: Start from disasm_va, not section_va
-                        let mut section_insn_count = 0;
-                        let mut consecutive_nops = 0;
-                        const MAX_CONSECUTIVE_NOPS: usize = 50; // 🔧 Increased from 10 to 50 - legitimate code can have padding
-                        let mut data_pattern_count = 0; // Track data-like patterns
-                        
-                        // 🔧 FIX: Since we start FROM entry point, ALL instructions are "real code" initially
-                        disassembly.push_str("\n; === ENTRY POINT ===\n");
-                        
-                        for insn in insns.iter() {
-                            // PERFORMANCE FIX: Stop if we hit instruction limit
-                            if total_instructions >= MAX_INSTRUCTIONS {
-                                disassembly.push_str(&format!("; [Truncated: Reached {} instruction limit for performance]\n", MAX_INSTRUCTIONS));
-                                disassembly.push_str("; WARNING: This may indicate the disassembler is processing DATA as CODE.\n");
-                                disassembly.push_str(";          Consider using C/Rust decompilation instead of assembly.\n");
-                                break;
-                            }
-                            
-                            let addr = insn.address();
-                            
-                            // Stop if we hit a long sequence of zeros (padding)
-                            if addr > last_addr + 0x100 {
-                                disassembly.push_str("; [padding detected - stopping disassembly]\n");
-                                break;
-                            }
-                            
-                            // Filter out obvious junk/padding patterns
-                            let mnemonic = insn.mnemonic().unwrap_or("");
-                            let operands = insn.op_str().unwrap_or("");
-                            
-                            // Skip invalid instructions
-                            if mnemonic.is_empty() || mnemonic == "invalid" {
-                                continue;
-                            }
-                            
-                            // DATA PATTERN DETECTION: Detect when we're disassembling data, not code
-                            // Data bytes often disassemble to: add, or, xor, adc, sbb with byte operands
-                            let is_data_pattern = matches!(mnemonic, "add" | "or" | "xor" | "adc" | "sbb" | "and") 
-                                && (operands.contains("byte ptr") || operands.contains("al,"));
-                            
-                            if is_data_pattern {
-                                data_pattern_count += 1;
-                                // If we see 20+ data patterns in a row, we're in data, not code
-                                if data_pattern_count >= 20 {
-                                    disassembly.push_str(&format!("; [Stopped: {} data-like instructions detected - this is DATA, not CODE]\n", data_pattern_count));
-                                    break;
-                                }
-                            } else {
-                                data_pattern_count = 0; // Reset on real instruction
-                            }
-                            
-                            // NOP SEQUENCE DETECTION: Stop if we hit too many consecutive NOPs
-                            // This indicates we've moved from code into data/padding
-                            if mnemonic == "nop" {
-                                consecutive_nops += 1;
-                                total_nops += 1; // Track total NOPs for final statistics
-                                
-                                // 🔧 FIX: Stop on long NOP sequence - indicates padding/data, not code
-                                if consecutive_nops >= MAX_CONSECUTIVE_NOPS {
-                                    disassembly.push_str(&format!("; [Stopped: {} consecutive NOPs detected - reached end of code section]\n", consecutive_nops));
-                                    break;
-                                }
-                            } else {
-                                consecutive_nops = 0; // Reset counter on non-NOP instruction
-                            }
-                            
-                            // UTF-8 SAFETY: Sanitize operands to prevent crashes in decompiler
-                            // Binary data can contain invalid UTF-8, null bytes, or BOM characters
-                            let operands_safe = operands
-                                .replace('\0', "")  // Remove null bytes
-                                .replace('\u{feff}', "")  // Remove BOM
-                                .chars()
-                                .filter(|c| !c.is_control() || c.is_whitespace())  // Keep only printable chars + whitespace
-                                .collect::<String>();
-                            
-                            // 🔧 FIX: Don't add duplicate entry point marker (we already added it at start)
-                            
-                            disassembly.push_str(&format!("{:08X}  {:<8} {}\n", 
-                                addr, mnemonic, operands_safe));
-                            last_addr = addr;
-                            section_insn_count += 1;
-                            total_instructions += 1;
-                        }
-                        
-                        disassembly.push_str(&format!("; Section instructions: {}\n", section_insn_count));
-                    }
-                    Err(_) => {
-                        disassembly.push_str("; Failed to disassemble section\n");
-                    }
-                }
-                disassembly.push_str("\n");
-            }
-            
-            // PERFORMANCE FIX: Stop processing sections if we hit limit
-            if total_instructions >= MAX_INSTRUCTIONS {
-                disassembly.push_str("; [Remaining sections skipped for performance]\n");
-                break;
-            }
-        }
-    }
-    
-    if disassembly.is_empty() {
-        disassembly.push_str("; No executable sections found\n");
-    } else {
-        disassembly.push_str(&format!("; Total instructions disassembled: {}\n", total_instructions));
-        
-        // Calculate NOP percentage and warn if suspiciously high
-        if total_instructions > 0 {
-            let nop_percentage = (total_nops as f64 / total_instructions as f64) * 100.0;
-            disassembly.push_str(&format!("; NOP instructions: {} ({:.1}%)\n", total_nops, nop_percentage));
-            
-            // Warn if >50% NOPs - this indicates data being disassembled as code
-            if nop_percentage > 50.0 && total_instructions > 100 {
-                disassembly.push_str(";\n");
-                disassembly.push_str("; ╔═══════════════════════════════════════════════════════════════════╗\n");
-                disassembly.push_str("; ║                         ⚠️  WARNING  ⚠️                            ║\n");
-                disassembly.push_str("; ╠═══════════════════════════════════════════════════════════════════╣\n");
-                disassembly.push_str(&format!("; ║ This disassembly contains {:.1}% NOP instructions!              ║\n", nop_percentage));
-                disassembly.push_str("; ║                                                                   ║\n");
-                disassembly.push_str("; ║ This strongly indicates the disassembler is processing DATA       ║\n");
-                disassembly.push_str("; ║ sections, padding, or resources as CODE.                          ║\n");
-                disassembly.push_str("; ║                                                                   ║\n");
-                disassembly.push_str("; ║ ❌ DO NOT attempt to reassemble this code - it will fail!         ║\n");
-                disassembly.push_str("; ║                                                                   ║\n");
-                disassembly.push_str("; ║ ✅ RECOMMENDED SOLUTION:                                          ║\n");
-                disassembly.push_str("; ║    Use C or Rust decompilation instead of assembly output.       ║\n");
-                disassembly.push_str("; ║    Decompiled code is compilable and produces working binaries.  ║\n");
-                disassembly.push_str("; ╚═══════════════════════════════════════════════════════════════════╝\n");
-            }
-        }
-    }
-    
-    Ok(disassembly)
+fn disassemble_exe(path: &PathBuf) -> Result<String, String> {
+    decompile_exe(path).map(|analysis| analysis.listing())
 }
 
 fn load_file_content(path: &PathBuf) -> Result<String, Box<dyn std::error::Error>> {
@@ -802,7 +532,7 @@ fn should_use_project_folder(_exe_path: &PathBuf, _current_path: &PathBuf) -> bo
 fn save_complete_decompilation(
     exe_path: &PathBuf,
     current_path: &PathBuf,
-    asm: &str,
+    analysis: &decompiler::Analysis,
 ) -> Result<PathBuf, Box<dyn std::error::Error>> {
     let use_project_folder = should_use_project_folder(exe_path, current_path);
     
@@ -820,23 +550,22 @@ fn save_complete_decompilation(
     
     // Save full assembly
     let asm_path = save_dir.join(format!("{}_full.asm", exe_name));
-    fs::write(&asm_path, asm)?;
+    fs::write(&asm_path, analysis.listing())?;
     
-    // Save all decompiled formats
-    let pseudo = decompiler::translate_to_pseudo_with_pe(asm, Some(&exe_path.to_string_lossy()));
+    // Save all decompiled formats: the analysis passes run once and the three
+    // backends render in parallel from the shared session
+    let (pseudo, c_code, rust_code) = analysis.session().render_all();
     let pseudo_path = save_dir.join(format!("{}_decompiled.pseudo", exe_name));
     fs::write(&pseudo_path, pseudo)?;
     
-    let c_code = decompiler::translate_to_c_with_pe(asm, Some(&exe_path.to_string_lossy()));
     let c_path = save_dir.join(format!("{}_decompiled.c", exe_name));
     fs::write(&c_path, c_code)?;
     
-    let rust_code = decompiler::translate_to_rust_with_pe(asm, Some(&exe_path.to_string_lossy()));
     let rust_path = save_dir.join(format!("{}_decompiled.rs", exe_name));
     fs::write(&rust_path, rust_code)?;
     
     // Save PE info summary
-    let pe_info = extract_pe_info(exe_path);
+    let pe_info = extract_pe_info(exe_path, analysis.image.as_deref());
     let pe_info_path = save_dir.join(format!("{}_pe_info.txt", exe_name));
     fs::write(&pe_info_path, pe_info)?;
     
@@ -869,57 +598,65 @@ fn save_complete_decompilation(
     Ok(save_dir)
 }
 
-fn extract_pe_info(exe_path: &PathBuf) -> String {
+fn extract_pe_info(exe_path: &PathBuf, image: Option<&pe_image::LoadedImage>) -> String {
     let mut info = String::new();
     
     info.push_str("╔════════════════════════════════════════════════════════════════╗\n");
     info.push_str("║                    PE FILE INFORMATION                         ║\n");
     info.push_str("╚════════════════════════════════════════════════════════════════╝\n\n");
     
-    if let Ok(buffer) = fs::read(exe_path) {
-        if let Ok(pe) = pe::PE::parse(&buffer) {
-            info.push_str(&format!("File: {}\n", exe_path.display()));
-            info.push_str(&format!("Size: {} bytes\n\n", buffer.len()));
-            
-            info.push_str("═══ HEADERS ═══\n");
-            info.push_str(&format!("Image Base: 0x{:x}\n", pe.image_base));
-            info.push_str(&format!("Entry Point: 0x{:x}\n", pe.entry));
-            info.push_str(&format!("Subsystem: {:?}\n", pe.header.optional_header.unwrap().windows_fields.subsystem));
-            info.push_str(&format!("Machine: {:?}\n\n", pe.header.coff_header.machine));
-            
-            info.push_str("═══ SECTIONS ═══\n");
-            for section in &pe.sections {
-                let name = String::from_utf8_lossy(&section.name);
-                info.push_str(&format!("  {} - VA: 0x{:x}, Size: 0x{:x}, Characteristics: 0x{:x}\n",
-                    name.trim_end_matches('\0'),
-                    section.virtual_address,
-                    section.virtual_size,
-                    section.characteristics
-                ));
+    // Reuse the caller's mapping when it has one
+    let opened;
+    let image = match image {
+        Some(image) => image,
+        None => match pe_image::LoadedImage::open(exe_path) {
+            Ok(loaded) => {
+                opened = loaded;
+                &*opened
             }
-            info.push_str("\n");
-            
-            info.push_str("═══ IMPORTS ═══\n");
-            for import in &pe.imports {
-                info.push_str(&format!("  {} ({})\n", import.name, import.dll));
+            Err(e) => {
+                info.push_str(&format!("Error: {}\n", e.lines().next().unwrap_or("Failed to read file")));
+                return info;
             }
-            info.push_str("\n");
-            
-            info.push_str("═══ EXPORTS ═══\n");
-            if pe.exports.is_empty() {
-                info.push_str("  (No exports)\n");
-            } else {
-                for export in &pe.exports {
-                    if let Some(name) = export.name {
-                        info.push_str(&format!("  {} @ 0x{:x}\n", name, export.rva));
-                    }
-                }
+        },
+    };
+    let pe = image.pe();
+    
+    info.push_str(&format!("File: {}\n", exe_path.display()));
+    info.push_str(&format!("Size: {} bytes\n\n", image.bytes().len()));
+    
+    info.push_str("═══ HEADERS ═══\n");
+    info.push_str(&format!("Image Base: 0x{:x}\n", pe.image_base));
+    info.push_str(&format!("Entry Point: 0x{:x}\n", pe.entry));
+    info.push_str(&format!("Subsystem: {:?}\n", pe.header.optional_header.unwrap().windows_fields.subsystem));
+    info.push_str(&format!("Machine: {:?}\n\n", pe.header.coff_header.machine));
+    
+    info.push_str("═══ SECTIONS ═══\n");
+    for section in &pe.sections {
+        info.push_str(&format!("  {} - VA: 0x{:x}, Size: 0x{:x}, Characteristics: 0x{:x}\n",
+            pe_image::section_name(section),
+            section.virtual_address,
+            section.virtual_size,
+            section.characteristics
+        ));
+    }
+    info.push_str("\n");
+    
+    info.push_str("═══ IMPORTS ═══\n");
+    for import in &pe.imports {
+        info.push_str(&format!("  {} ({})\n", import.name, import.dll));
+    }
+    info.push_str("\n");
+    
+    info.push_str("═══ EXPORTS ═══\n");
+    if pe.exports.is_empty() {
+        info.push_str("  (No exports)\n");
+    } else {
+        for export in &pe.exports {
+            if let Some(name) = export.name {
+                info.push_str(&format!("  {} @ 0x{:x}\n", name, export.rva));
             }
-        } else {
-            info.push_str("Error: Failed to parse PE file\n");
         }
-    } else {
-        info.push_str("Error: Failed to read file\n");
     }
     
     info
@@ -980,19 +717,21 @@ fn main() -> Result<(), Box<dyn std::error::Error>> {
                 // Decompile executable
                 println!("🔍 Decompiling: {}", file_path.display());
                 
-                match disassemble_exe(&file_path) {
-                    Ok(asm) => {
+                match decompile_exe(&file_path) {
+                    Ok(analysis) => {
                         let output_path = format!("{}.asm", file_path.display());
-                        fs::write(&output_path, &asm)?;
+                        fs::write(&output_path, analysis.listing())?;
                         println!("✅ Assembly saved to: {}", output_path);
                         
-                        // Also generate C and Rust
-                        let c_code = decompiler::translate_to_c(&asm);
+                        // Also generate C and Rust, from one run of the analysis passes
+                        let session = analysis.session();
+                        let c_code = session.render_c();
                         let c_path = format!("{}.c", file_path.display());
                         fs::write(&c_path, &c_code)?;
                         println!("✅ C code saved to: {}", c_path);
                         
-                        let rust_code = decompiler::translate_to_rust(&asm);
+                        let rust_code = session.render_rust();
+                        session.persist();
                         let rust_path = format!("{}.rs", file_path.display());
                         fs::write(&rust_path, &rust_code)?;
                         println!("✅ Rust code saved to: {}", rust_path);
@@ -1628,8 +1367,8 @@ fn main() -> Result<(), Box<dyn std::error::Error>> {
                                 let output_mode = &options[*selected];
                                 
                                 // SAFETY: Properly handle disassembly errors instead of crashing
-                                let asm = match disassemble_exe(file_path) {
-                                    Ok(assembly) => assembly,
+                                let analysis = match decompile_exe(file_path) {
+                                    Ok(analysis) => analysis,
                                     Err(error_msg) => {
                                         // Show error in editor so user can see what went wrong
                                         let error_content = format!(
@@ -1652,15 +1391,13 @@ fn main() -> Result<(), Box<dyn std::error::Error>> {
                                     }
                                 };
                                 
-                                let pe_path_str = file_path.to_string_lossy().to_string();
-                                
                                 if output_mode == "Single File" {
                                     // Single file mode - open in editor with full PE analysis
                                     let content = match *language_idx {
-                                        0 => asm.clone(),
-                                        1 => decompiler::translate_to_pseudo_with_pe(&asm, Some(&pe_path_str)),
-                                        2 => decompiler::translate_to_c_with_pe(&asm, Some(&pe_path_str)),
-                                        3 => decompiler::translate_to_rust_with_pe(&asm, Some(&pe_path_str)),
+                                        0 => analysis.listing(),
+                                        1 => analysis.to_pseudo(),
+                                        2 => analysis.to_c(),
+                                        3 => analysis.to_rust(),
                                         _ => "Unknown option".to_string(),
                                     };
                                     
@@ -1677,7 +1414,7 @@ fn main() -> Result<(), Box<dyn std::error::Error>> {
                                     mode = Mode::Edit { textarea, file_path: output_file_path, language: language.to_string() };
                                 } else {
                                     // Multi-file mode - save to project folder and navigate
-                                    if let Ok(project_dir) = save_complete_decompilation(file_path, &current_path, &asm) {
+                                    if let Ok(project_dir) = save_complete_decompilation(file_path, &current_path, &analysis) {
                                         // Successfully saved, now navigate to the project folder
                                         current_path = project_dir;
                                         files = get_files(&current_path);
@@ -1685,7 +1422,7 @@ fn main() -> Result<(), Box<dyn std::error::Error>> {
                                         mode = Mode::List;
                                     } else {
                                         // Fallback to multi-file edit mode
-                                        let files = decompiler::generate_multi_file_output(&asm, language, output_mode);
+                                        let files = decompiler::generate_multi_file_output(&analysis.listing(), language, output_mode);
                                         if !files.is_empty() {
                                             let textarea = TextArea::new(files[0].1.lines().map(|s| s.to_string()).collect());
                                             mode = Mode::MultiFileEdit {
@@ -1,28 +1,41 @@
 // Rust FFI bindings for native C disassembler
 // High-performance PE analysis with RIP-relative address handling
-// NOTE: This module is optional - if C compilation fails, FFI calls will return None
+// NOTE: This module is optional - build.rs sets `cfg(native_disassembler)` only
+// when the C library actually built; without it, FFI calls return None
 
-use std::ffi::{CStr, CString};
+#[cfg(native_disassembler)]
+use std::ffi::CStr;
+#[cfg(native_disassembler)]
 use std::os::raw::c_char;
+#[cfg(native_disassembler)]
+use std::ptr::NonNull;
+use std::borrow::Cow;
+use std::io::{BufRead, Write};
 
 // C structure for RIP-relative references
 #[repr(C)]
 #[derive(Clone, Copy)]
 pub struct RipRef {
+    /// VA of the referencing instruction
     pub address: u64,
+    /// Signed disp32
     pub offset: i64,
+    /// VA the reference resolves to (next instruction + disp32)
+    pub target: u64,
     pub is_data: bool,
 }
 
 // Conditional compilation: Only link C code if it was successfully built
-#[cfg(target_os = "windows")]
-#[link(name = "disassembler")]
+// (build.rs emits the link directives for the static library)
+#[cfg(native_disassembler)]
 extern "C" {
     // Buffer management
     fn rip_buffer_init(capacity: usize) -> *mut std::ffi::c_void;
     #[allow(dead_code)]
     fn rip_buffer_write(handle: *mut std::ffi::c_void, text: *const c_char) -> bool;
     fn rip_buffer_get(handle: *mut std::ffi::c_void) -> *const c_char;
+    fn rip_buffer_reset(handle: *mut std::ffi::c_void);
+    fn rip_buffer_length(handle: *mut std::ffi::c_void) -> usize;
     fn rip_buffer_free(handle: *mut std::ffi::c_void);
     
     // PE parsing and validation
@@ -33,18 +46,32 @@ extern "C" {
         out_is_64bit: *mut bool,
     ) -> bool;
     
-    // RIP reference extraction
-    fn rip_extract_references(
+    // Instruction length decoding
+    fn rip_instruction_length(code: *const u8, size: usize) -> usize;
+    
+    // RIP reference extraction, resumable through `cursor`
+    fn rip_extract_references_chunk(
+        code: *const u8,
+        code_size: usize,
+        base_va: u64,
+        cursor: *mut usize,
+        refs: *mut RipRef,
+        max_refs: usize,
+    ) -> usize;
+    fn rip_scan_references_chunk(
         code: *const u8,
         code_size: usize,
         base_va: u64,
+        cursor: *mut usize,
         refs: *mut RipRef,
         max_refs: usize,
     ) -> usize;
+    fn rip_scan_path() -> *const c_char;
     
     // RIP reference fixing
-    fn rip_fix_references(
+    fn rip_fix_references_len(
         asm_code: *const c_char,
+        code_len: usize,
         refs: *const RipRef,
         ref_count: usize,
         output_buffer: *mut std::ffi::c_void,
@@ -57,17 +84,19 @@ extern "C" {
     fn rip_get_version() -> *const c_char;
 }
 
-// Non-Windows or fallback implementations (stubs)
-#[cfg(not(target_os = "windows"))]
+// Fallback implementations (stubs) when the C library is not available
+#[cfg(not(native_disassembler))]
 mod native_stubs {
     use crate::native_disassembler::RipRef;
-    use std::ffi::CStr;
-    use std::os::raw::c_char;
     
     pub unsafe fn parse_pe_header_impl(_buffer: &[u8]) -> Option<(u32, bool)> {
         None // Fallback: not available
     }
     
+    pub unsafe fn instruction_length_impl(_code: &[u8]) -> Option<usize> {
+        None // Fallback: not available
+    }
+    
     pub unsafe fn extract_rip_references_impl(
         _code: &[u8],
         _base_va: u64,
@@ -75,8 +104,8 @@ mod native_stubs {
         Vec::new() // Fallback: return empty
     }
     
-    pub unsafe fn fix_rip_references_impl(_asm_code: &str, _refs: &[RipRef]) -> Option<String> {
-        None // Fallback: not available
+    pub fn scan_path_impl() -> String {
+        "none".to_string()
     }
     
     pub unsafe fn validate_section_impl(_code: &[u8]) -> bool {
@@ -95,7 +124,7 @@ pub fn parse_pe_header(buffer: &[u8]) -> Option<(u32, bool)> {
         return None; // Too small to be valid PE
     }
     
-    #[cfg(target_os = "windows")]
+    #[cfg(native_disassembler)]
     {
         let mut entry_point = 0u32;
         let mut is_64bit = false;
@@ -119,108 +148,268 @@ pub fn parse_pe_header(buffer: &[u8]) -> Option<(u32, bool)> {
         }
     }
     
-    #[cfg(not(target_os = "windows"))]
+    #[cfg(not(native_disassembler))]
     unsafe {
         native_stubs::parse_pe_header_impl(buffer)
     }
 }
 
-/// Extract RIP-relative references from code section with automatic buffer expansion
-pub fn extract_rip_references(
-    code: &[u8],
-    base_va: u64,
-) -> Vec<RipRef> {
-    #[cfg(target_os = "windows")]
+/// Length of the x86-64 instruction at the start of `code`, decoded natively
+/// without Capstone; `None` for invalid or truncated bytes
+pub fn instruction_length(code: &[u8]) -> Option<usize> {
+    #[cfg(native_disassembler)]
     {
-        // Dynamic sizing based on code size - estimate ~1 RIP ref per 50 bytes
-        let estimated_refs = (code.len() / 50).max(100).min(10000);
-        let mut refs = vec![RipRef {
-            address: 0,
-            offset: 0,
-            is_data: false,
-        }; estimated_refs];
-        
+        let length = unsafe { rip_instruction_length(code.as_ptr(), code.len()) };
+        (length > 0).then_some(length)
+    }
+    
+    #[cfg(not(native_disassembler))]
+    unsafe {
+        native_stubs::instruction_length_impl(code)
+    }
+}
+
+/// Signature shared by the chunked C extractors
+#[cfg(native_disassembler)]
+type RipExtractor = unsafe extern "C" fn(*const u8, usize, u64, *mut usize, *mut RipRef, usize) -> usize;
+
+/// References requested from C per call; `refs` grows between calls
+#[cfg(native_disassembler)]
+const REF_CHUNK: usize = 4096;
+
+/// Run one of the C extractors over `code`, appending to `refs`
+#[cfg(native_disassembler)]
+fn run_extractor(extractor: RipExtractor, code: &[u8], base_va: u64, refs: &mut Vec<RipRef>) {
+    let mut cursor = 0;
+    while cursor < code.len() {
+        refs.reserve(REF_CHUNK);
+        let spare = refs.capacity() - refs.len();
+        let before = cursor;
         let count = unsafe {
-            rip_extract_references(
+            extractor(
                 code.as_ptr(),
                 code.len(),
                 base_va,
-                refs.as_mut_ptr(),
-                refs.len(),
+                &mut cursor,
+                refs.as_mut_ptr().add(refs.len()),
+                spare,
             )
         };
+        // The C side initialised `count` entries of the spare capacity
+        unsafe { refs.set_len(refs.len() + count) };
         
-        refs.truncate(count);
-        refs
+        if count == 0 && cursor == before {
+            break;
+        }
+    }
+}
+
+/// Extract RIP-relative references from a code section
+pub fn extract_rip_references(
+    code: &[u8],
+    base_va: u64,
+) -> Vec<RipRef> {
+    let mut refs = Vec::new();
+    extract_rip_references_into(code, base_va, &mut refs);
+    refs
+}
+
+/// `extract_rip_references`, appending to a caller-owned Vec so one
+/// allocation can be reused across sections
+pub fn extract_rip_references_into(code: &[u8], base_va: u64, refs: &mut Vec<RipRef>) {
+    #[cfg(native_disassembler)]
+    {
+        run_extractor(rip_extract_references_chunk, code, base_va, refs)
+    }
+    
+    #[cfg(not(native_disassembler))]
+    unsafe {
+        refs.extend(native_stubs::extract_rip_references_impl(code, base_va))
+    }
+}
+
+/// Like `extract_rip_references`, but only decodes near SIMD-found
+/// candidate bytes. Much faster on large sections; after skipping a
+/// candidate-free stretch the sweep has to resynchronise, so a reference
+/// right behind data-in-code can very rarely be missed.
+pub fn scan_rip_references(
+    code: &[u8],
+    base_va: u64,
+) -> Vec<RipRef> {
+    let mut refs = Vec::new();
+    scan_rip_references_into(code, base_va, &mut refs);
+    refs
+}
+
+/// `scan_rip_references`, appending to a caller-owned Vec
+pub fn scan_rip_references_into(code: &[u8], base_va: u64, refs: &mut Vec<RipRef>) {
+    #[cfg(native_disassembler)]
+    {
+        run_extractor(rip_scan_references_chunk, code, base_va, refs)
     }
     
-    #[cfg(not(target_os = "windows"))]
+    #[cfg(not(native_disassembler))]
+    unsafe {
+        refs.extend(native_stubs::extract_rip_references_impl(code, base_va))
+    }
+}
+
+/// Candidate scan picked for this CPU: "avx2", "sse2" or "scalar"
+pub fn scan_path() -> String {
+    #[cfg(native_disassembler)]
     unsafe {
-        native_stubs::extract_rip_references_impl(code, base_va)
+        let path_ptr = rip_scan_path();
+        if path_ptr.is_null() {
+            return "unknown".to_string();
+        }
+        CStr::from_ptr(path_ptr).to_string_lossy().into_owned()
+    }
+    
+    #[cfg(not(native_disassembler))]
+    {
+        native_stubs::scan_path_impl()
+    }
+}
+
+/// Output buffer owned by the C library. It grows as needed and keeps its
+/// allocation between calls, so one buffer can serve a whole batch of
+/// `fix_rip_references_into` calls.
+pub struct RipBuffer {
+    #[cfg(native_disassembler)]
+    handle: NonNull<std::ffi::c_void>,
+}
+
+impl RipBuffer {
+    /// `None` when the C library is unavailable or the allocation fails
+    pub fn with_capacity(capacity: usize) -> Option<Self> {
+        #[cfg(native_disassembler)]
+        {
+            NonNull::new(unsafe { rip_buffer_init(capacity) }).map(|handle| RipBuffer { handle })
+        }
+        
+        #[cfg(not(native_disassembler))]
+        {
+            let _ = capacity;
+            None
+        }
+    }
+}
+
+#[cfg(native_disassembler)]
+impl Drop for RipBuffer {
+    fn drop(&mut self) {
+        unsafe { rip_buffer_free(self.handle.as_ptr()) };
     }
 }
 
-/// Fix RIP-relative references in assembly code with dynamic buffer sizing
+/// Listing bytes relabelled per call by `fix_rip_references_stream`
+const STREAM_CHUNK: usize = 1024 * 1024;
+
+/// The C side binary-searches the refs by address; the extractors already
+/// return them sorted, anything else is sorted on a copy. Callers sort once
+/// per listing, not per chunk
+fn sorted_refs(refs: &[RipRef]) -> Cow<'_, [RipRef]> {
+    if refs.windows(2).all(|pair| pair[0].address <= pair[1].address) {
+        Cow::Borrowed(refs)
+    } else {
+        let mut sorted = refs.to_vec();
+        sorted.sort_by_key(|rip_ref| rip_ref.address);
+        Cow::Owned(sorted)
+    }
+}
+
+/// Fix RIP-relative references in assembly code. Each `[rip +/- 0x..]`
+/// becomes `[data_0x<target>]`, with the target taken from the ref whose
+/// address matches the line's leading address (`[data_0x<|disp|>]` when the
+/// line has none).
 pub fn fix_rip_references(asm_code: &str, refs: &[RipRef]) -> Option<String> {
     if asm_code.is_empty() {
         return Some(String::new());
     }
     
-    #[cfg(target_os = "windows")]
-    {
-        // Dynamic buffer size based on input (2x input size, min 1MB, max 16MB)
-        let buffer_size = (asm_code.len() * 2).max(1024 * 1024).min(16 * 1024 * 1024);
-        
-        let asm_c = CString::new(asm_code).ok()?;
-        
-        let buffer = unsafe { rip_buffer_init(buffer_size) };
-        if buffer.is_null() {
-            return None;
+    // Labels are barely longer than the operands they replace
+    let mut buffer = RipBuffer::with_capacity(asm_code.len() + asm_code.len() / 8)?;
+    fix_rip_references_into(&mut buffer, asm_code, refs).map(str::to_string)
+}
+
+/// `fix_rip_references` into a reusable buffer; the result borrows it until
+/// the next call
+pub fn fix_rip_references_into<'a>(
+    buffer: &'a mut RipBuffer,
+    asm_code: &str,
+    refs: &[RipRef],
+) -> Option<&'a str> {
+    relabel_into(buffer, asm_code.as_bytes(), &sorted_refs(refs)).and_then(|bytes| std::str::from_utf8(bytes).ok())
+}
+
+/// Relabel a listing of any size from `input` to `output`, one
+/// `STREAM_CHUNK` of whole lines at a time through a single buffer
+pub fn fix_rip_references_stream(
+    input: &mut impl BufRead,
+    output: &mut impl Write,
+    refs: &[RipRef],
+) -> Result<(), String> {
+    let refs = sorted_refs(refs);
+    let mut buffer = RipBuffer::with_capacity(STREAM_CHUNK + STREAM_CHUNK / 8)
+        .ok_or_else(|| "Native disassembler not available".to_string())?;
+    let mut lines = Vec::with_capacity(STREAM_CHUNK);
+    
+    loop {
+        lines.clear();
+        while lines.len() < STREAM_CHUNK {
+            let read = input.read_until(b'\n', &mut lines)
+                .map_err(|e| format!("Failed to read listing: {}", e))?;
+            if read == 0 {
+                break;
+            }
         }
-        
-        let result = unsafe {
-            rip_fix_references(
-                asm_c.as_ptr(),
-                refs.as_ptr(),
-                refs.len(),
-                buffer,
-            )
-        };
-        
-        if !result {
-            unsafe { rip_buffer_free(buffer) };
-            return None;
+        if lines.is_empty() {
+            return Ok(());
         }
         
-        let result_ptr = unsafe { rip_buffer_get(buffer) };
-        if result_ptr.is_null() {
-            unsafe { rip_buffer_free(buffer) };
+        let fixed = relabel_into(&mut buffer, &lines, &refs)
+            .ok_or_else(|| "Failed to relabel RIP references".to_string())?;
+        output.write_all(fixed)
+            .map_err(|e| format!("Failed to write listing: {}", e))?;
+    }
+}
+
+/// Run the single-pass C relabeller over `text` into `buffer`; `refs` must
+/// already be sorted by address (see `sorted_refs`)
+fn relabel_into<'a>(buffer: &'a mut RipBuffer, text: &[u8], refs: &[RipRef]) -> Option<&'a [u8]> {
+    #[cfg(native_disassembler)]
+    {
+        let handle = buffer.handle.as_ptr();
+        
+        let ok = unsafe {
+            rip_buffer_reset(handle);
+            rip_fix_references_len(text.as_ptr() as *const c_char, text.len(), refs.as_ptr(), refs.len(), handle)
+        };
+        if !ok {
             return None;
         }
         
-        let result_str = unsafe { CStr::from_ptr(result_ptr) }
-            .to_string_lossy()
-            .to_string();
-        
-        unsafe { rip_buffer_free(buffer) };
-        
-        Some(result_str)
+        Some(unsafe {
+            std::slice::from_raw_parts(rip_buffer_get(handle) as *const u8, rip_buffer_length(handle))
+        })
     }
     
-    #[cfg(not(target_os = "windows"))]
-    unsafe {
-        native_stubs::fix_rip_references_impl(asm_code, refs)
+    // A RipBuffer only exists when the C library is linked
+    #[cfg(not(native_disassembler))]
+    {
+        let _ = (buffer, text, refs);
+        None
     }
 }
 
 /// Validate if a code section is likely executable code
 pub fn validate_section(code: &[u8]) -> bool {
-    #[cfg(target_os = "windows")]
+    #[cfg(native_disassembler)]
     unsafe {
         rip_validate_section(code.as_ptr(), code.len())
     }
     
-    #[cfg(not(target_os = "windows"))]
+    #[cfg(not(native_disassembler))]
     unsafe {
         native_stubs::validate_section_impl(code)
     }
@@ -228,7 +417,7 @@ pub fn validate_section(code: &[u8]) -> bool {
 
 /// Get the native module version
 pub fn get_version() -> String {
-    #[cfg(target_os = "windows")]
+    #[cfg(native_disassembler)]
     unsafe {
         let version_ptr = rip_get_version();
         if version_ptr.is_null() {
@@ -240,7 +429,7 @@ pub fn get_version() -> String {
         }
     }
     
-    #[cfg(not(target_os = "windows"))]
+    #[cfg(not(native_disassembler))]
     {
         native_stubs::get_version_impl()
     }
@@ -256,4 +445,175 @@ mod tests {
         assert!(!version.is_empty());
         println!("Native module version: {}", version);
     }
+    
+    // Parity with the Rust paths (goblin, Capstone, the relocator), only
+    // built when the C library is linked
+    #[cfg(native_disassembler)]
+    mod parity {
+        use super::*;
+        use crate::assembly_relocator;
+        use crate::pe_builder::PEBuilder;
+        use crate::pe_image;
+        use capstone::prelude::*;
+        
+        /// Intel-syntax x86-64 Capstone; built here because `pe_disasm`
+        /// belongs to the binary, not the library this module is part of
+        fn capstone_x86_64() -> Capstone {
+            Capstone::new()
+                .x86()
+                .mode(capstone::arch::x86::ArchMode::Mode64)
+                .syntax(capstone::arch::x86::ArchSyntax::Intel)
+                .build()
+                .unwrap()
+        }
+        
+        /// Signed displacement of a Capstone `[rip +/- 0x..]` operand
+        fn rip_displacement(op_str: &str) -> Option<i64> {
+            let rest = op_str[op_str.find("[rip")? + 4..].trim_start();
+            let negative = rest.starts_with('-');
+            let hex = rest[1..].trim_start().strip_prefix("0x")?;
+            let digits: String = hex.chars().take_while(|c| c.is_ascii_hexdigit()).collect();
+            let value = i64::from_str_radix(&digits, 16).ok()?;
+            Some(if negative { -value } else { value })
+        }
+        
+        #[test]
+        fn test_pe_header_matches_goblin() {
+            for is_64bit in [true, false] {
+                let mut builder = PEBuilder::new(is_64bit);
+                builder.add_code(vec![0x90, 0xC3]);
+                let path = std::env::temp_dir().join(format!("cataclysm-native-{}-{}.exe", std::process::id(), is_64bit));
+                builder.build(&path).unwrap();
+                let bytes = std::fs::read(&path).unwrap();
+                let _ = std::fs::remove_file(&path);
+                
+                let pe = pe_image::parse_pe(&bytes).unwrap();
+                assert_eq!(parse_pe_header(&bytes), Some((pe.entry as u32, pe.is_64)));
+            }
+        }
+        
+        /// Forms the old pattern matcher missed: non-W REX, 0F maps, VEX and
+        /// EVEX, legacy prefixes and immediates after the displacement
+        const SAMPLE_CODE: &[u8] = &[
+            0x48, 0x8B, 0x05, 0x10, 0x00, 0x00, 0x00,             // mov rax, qword ptr [rip + 0x10]
+            0x48, 0x8D, 0x0D, 0xF0, 0xFF, 0xFF, 0xFF,             // lea rcx, [rip - 0x10]
+            0x8B, 0x15, 0x00, 0x01, 0x00, 0x00,                   // mov edx, dword ptr [rip + 0x100]
+            0x44, 0x8B, 0x05, 0x20, 0x00, 0x00, 0x00,             // mov r8d, dword ptr [rip + 0x20]
+            0xC7, 0x05, 0x08, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, // mov dword ptr [rip + 8], 1
+            0x66, 0x83, 0x3D, 0x04, 0x00, 0x00, 0x00, 0x07,       // cmp word ptr [rip + 4], 7
+            0x0F, 0xB6, 0x05, 0x40, 0x00, 0x00, 0x00,             // movzx eax, byte ptr [rip + 0x40]
+            0xF3, 0x0F, 0x10, 0x05, 0x30, 0x00, 0x00, 0x00,       // movss xmm0, dword ptr [rip + 0x30]
+            0xC5, 0xFC, 0x28, 0x05, 0x60, 0x00, 0x00, 0x00,       // vmovaps ymm0, ymmword ptr [rip + 0x60]
+            0x62, 0xF1, 0x7C, 0x48, 0x28, 0x05, 0x80, 0x00, 0x00, 0x00, // vmovaps zmm0, zmmword ptr [rip + 0x80]
+            0x66, 0x0F, 0x3A, 0x0F, 0x05, 0x10, 0x00, 0x00, 0x00, 0x04, // palignr xmm0, xmmword ptr [rip + 0x10], 4
+            0x48, 0xB8, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, // movabs rax, 0x1122334455667788
+            0xFF, 0x15, 0x00, 0x10, 0x00, 0x00,                   // call qword ptr [rip + 0x1000]
+            0xFF, 0x25, 0x00, 0x20, 0x00, 0x00,                   // jmp qword ptr [rip + 0x2000]
+            0x31, 0xC0,                                           // xor eax, eax
+            0xC3,                                                 // ret
+        ];
+        
+        #[test]
+        fn test_instruction_lengths_match_capstone() {
+            let cs = capstone_x86_64();
+            let insns = cs.disasm_all(SAMPLE_CODE, 0).unwrap();
+            assert!(insns.len() > 0);
+            for insn in insns.iter() {
+                let start = insn.address() as usize;
+                assert_eq!(instruction_length(&SAMPLE_CODE[start..]), Some(insn.len()), "at {:#x}", start);
+            }
+        }
+        
+        #[test]
+        fn test_rip_references_match_capstone() {
+            let base_va = 0x140001000;
+            let cs = capstone_x86_64();
+            let insns = cs.disasm_all(SAMPLE_CODE, base_va).unwrap();
+            let expected: Vec<(u64, i64, u64)> = insns
+                .iter()
+                .filter_map(|insn| {
+                    let disp = rip_displacement(insn.op_str()?)?;
+                    Some((insn.address(), disp, (insn.address() + insn.len() as u64).wrapping_add(disp as u64)))
+                })
+                .collect();
+            let native: Vec<(u64, i64, u64)> = extract_rip_references(SAMPLE_CODE, base_va)
+                .iter()
+                .map(|rip_ref| (rip_ref.address, rip_ref.offset, rip_ref.target))
+                .collect();
+            assert_eq!(native.len(), 13);
+            assert_eq!(native, expected);
+        }
+        
+        #[test]
+        fn test_candidate_scan_matches_sweep() {
+            // Padding long enough that the scan skips ahead and resyncs
+            let mut code = vec![0xCC; 200];
+            code.extend_from_slice(SAMPLE_CODE);
+            code.extend(std::iter::repeat(0x90).take(301));
+            code.extend_from_slice(SAMPLE_CODE);
+            code.extend_from_slice(&SAMPLE_CODE[..20]);
+            
+            let key = |refs: Vec<RipRef>| -> Vec<(u64, u64, bool)> {
+                refs.iter().map(|r| (r.address, r.target, r.is_data)).collect()
+            };
+            let swept = key(extract_rip_references(&code, 0x1000));
+            assert_eq!(swept.len(), 29);
+            assert_eq!(key(scan_rip_references(&code, 0x1000)), swept);
+            assert!(["avx2", "sse2", "scalar"].contains(&scan_path().as_str()));
+        }
+        
+        #[test]
+        fn test_large_inputs_span_chunks_and_grow_buffers() {
+            // More references than one chunk of the C extractor returns
+            let code = SAMPLE_CODE.repeat(400);
+            let refs = extract_rip_references(&code, 0);
+            assert_eq!(refs.len(), 13 * 400);
+            assert!(refs.len() > REF_CHUNK);
+            assert!(refs.windows(2).all(|pair| pair[0].address < pair[1].address));
+            
+            // A one-byte starting buffer grows instead of truncating, and
+            // stays usable for the next call
+            let listing = "lea rcx, [rip + 0x10]\nret\n".repeat(5000);
+            let mut buffer = RipBuffer::with_capacity(1).unwrap();
+            let fixed = fix_rip_references_into(&mut buffer, &listing, &[]).unwrap();
+            assert_eq!(fixed, "lea rcx, [data_0x10]\nret\n".repeat(5000));
+            assert_eq!(fix_rip_references_into(&mut buffer, "ret\n", &[]), Some("ret\n"));
+        }
+        
+        #[test]
+        fn test_labels_resolve_through_refs() {
+            let refs = extract_rip_references(SAMPLE_CODE, 0x1000);
+            let listing = "0x1000: mov rax, qword ptr [rip + 0x10]\n\
+                           0x1007: lea rcx, [rip - 0x10]\n\
+                           mov edx, dword ptr [rip + 0x100]\n\
+                           0x1007: lea rcx, [rip]";
+            assert_eq!(
+                fix_rip_references(listing, &refs).unwrap(),
+                "0x1000: mov rax, qword ptr [data_0x1017]\n\
+                 0x1007: lea rcx, [data_0xffe]\n\
+                 mov edx, dword ptr [data_0x100]\n\
+                 0x1007: lea rcx, [rip]"
+            );
+            
+            // Streaming in chunks matches relabelling the whole listing
+            let big = format!("{}\n", listing).repeat(40_000);
+            let mut streamed = Vec::new();
+            fix_rip_references_stream(&mut big.as_bytes(), &mut streamed, &refs).unwrap();
+            assert!(big.len() > STREAM_CHUNK);
+            assert_eq!(String::from_utf8(streamed).unwrap(), fix_rip_references(&big, &refs).unwrap());
+        }
+        
+        #[test]
+        fn test_fixed_labels_match_relocator_offsets() {
+            let listing = "mov rax, qword ptr [rip + 0x2f4a]\nlea rcx, [rip - 0x10]\nxor eax, eax\nret\n";
+            let fixed = fix_rip_references(listing, &[]).unwrap();
+            assert_eq!(fixed.lines().count(), listing.lines().count());
+            for (line, fixed_line) in listing.lines().zip(fixed.lines()) {
+                match assembly_relocator::extract_rip_offset(line) {
+                    Some(offset) => assert!(fixed_line.ends_with(&format!("[data_0x{:x}]", offset.unsigned_abs())), "{}", fixed_line),
+                    None => assert_eq!(fixed_line, line),
+                }
+            }
+        }
+    }
 }
\ No newline at end of file
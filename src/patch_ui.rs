@@ -59,8 +59,8 @@ impl PatchSession {
             match self.rva_to_file_offset(address as u32, preserved) {
                 Some(file_offset) => {
                     let end_offset = file_offset + new_bytes.len();
-                    if end_offset <= preserved.original_pe.len() {
-                        let bytes = preserved.original_pe[file_offset..end_offset].to_vec();
+                    if end_offset <= preserved.original_pe().len() {
+                        let bytes = preserved.original_pe()[file_offset..end_offset].to_vec();
                         println!("      [DEBUG] Read {} bytes from file offset 0x{:x}", bytes.len(), file_offset);
                         bytes
                     } else {
@@ -342,7 +342,7 @@ impl PatchUI {
         println!("   [DEBUG] Output path: {}", output_path.display());
         
         // Step 1: Clone the original PE data
-        let mut patched_pe = preserved.original_pe.clone();
+        let mut patched_pe = preserved.original_pe().to_vec();
         println!("   [DEBUG] Cloned original PE ({} bytes)", patched_pe.len());
         
         // Step 2: Apply byte-level patches
@@ -52,6 +52,18 @@ impl PEBuilder {
         self.code = code;
     }
 
+    /// Read-only data, placed in .rdata after the import names
+    pub fn add_data(&mut self, data: Vec<u8>) {
+        self.data = data;
+    }
+
+    /// RVA the `add_data` bytes load at. Depends on the code size and the
+    /// imports, so ask once both are final.
+    pub fn data_rva(&self) -> u32 {
+        let rdata_rva = 0x1000 + self.align(self.code.len() as u32, 0x1000);
+        rdata_rva + self.align(self.import_names_size(), 16)
+    }
+
     pub fn add_import(&mut self, dll_name: String, function_name: String) {
         // Find or create DLL entry
         if let Some(dll) = self.imports.iter_mut().find(|d| d.name.eq_ignore_ascii_case(&dll_name)) {
@@ -85,7 +97,8 @@ impl PEBuilder {
         // ====================================================================
         // 2. PE SIGNATURE & COFF HEADER
         // ====================================================================
-        let num_sections = if self.imports.is_empty() { 1 } else { 3 }; // .text, .rdata, .idata
+        let has_rdata = !self.imports.is_empty() || !self.data.is_empty();
+        let num_sections = 1 + has_rdata as u16 + !self.imports.is_empty() as u16; // .text, .rdata, .idata
         self.write_pe_signature(&mut pe);
         self.write_coff_header(&mut pe, num_sections);
 
@@ -112,10 +125,12 @@ impl PEBuilder {
         };
 
         // Calculate image size
-        let image_size = if self.imports.is_empty() {
-            text_rva + self.align(self.code.len() as u32, section_alignment)
-        } else {
+        let image_size = if !self.imports.is_empty() {
             idata_rva + self.align(import_dir_size, section_alignment)
+        } else if has_rdata {
+            idata_rva
+        } else {
+            text_rva + self.align(self.code.len() as u32, section_alignment)
         };
 
         // Write data directories
@@ -137,8 +152,8 @@ impl PEBuilder {
             0x60000020, // CODE | EXECUTE | READ
         );
 
-        if !self.imports.is_empty() {
-            // .rdata section (for import names and DLL names)
+        if has_rdata {
+            // .rdata section (for import names, DLL names and data)
             let rdata_size = self.calculate_rdata_size();
             let rdata_file_offset = headers_size + self.align(self.code.len() as u32, file_alignment);
             self.write_section_header(
@@ -150,9 +165,12 @@ impl PEBuilder {
                 rdata_file_offset,
                 0x40000040, // INITIALIZED_DATA | READ
             );
+        }
 
+        if !self.imports.is_empty() {
             // .idata section (for import tables)
-            let idata_file_offset = rdata_file_offset + self.align(rdata_size, file_alignment);
+            let rdata_file_offset = headers_size + self.align(self.code.len() as u32, file_alignment);
+            let idata_file_offset = rdata_file_offset + self.align(self.calculate_rdata_size(), file_alignment);
             self.write_section_header(
                 &mut pe,
                 b".idata\0\0",
@@ -180,9 +198,9 @@ impl PEBuilder {
         }
 
         // ====================================================================
-        // 7. .RDATA SECTION (IMPORT NAMES & DLL NAMES)
+        // 7. .RDATA SECTION (IMPORT NAMES, DLL NAMES & DATA)
         // ====================================================================
-        if !self.imports.is_empty() {
+        if has_rdata {
             let rdata_start = pe.len();
             let rdata_content = self.build_rdata_section(rdata_rva);
             pe.extend_from_slice(&rdata_content);
@@ -262,7 +280,7 @@ impl PEBuilder {
         pe.extend_from_slice(&(self.code.len() as u32).to_le_bytes()); // SizeOfCode
         
         let init_data_size = if self.imports.is_empty() {
-            0u32
+            self.calculate_rdata_size()
         } else {
             self.calculate_rdata_size() + self.calculate_import_directory_size()
         };
@@ -352,6 +370,14 @@ impl PEBuilder {
     }
 
     fn calculate_rdata_size(&self) -> u32 {
+        if self.data.is_empty() {
+            self.import_names_size()
+        } else {
+            self.align(self.import_names_size(), 16) + self.data.len() as u32
+        }
+    }
+
+    fn import_names_size(&self) -> u32 {
         let mut size = 0u32;
         
         // DLL names
@@ -429,6 +455,14 @@ impl PEBuilder {
             }
         }
         
+        // Data, 16-byte aligned
+        if !self.data.is_empty() {
+            while rdata.len() % 16 != 0 {
+                rdata.push(0);
+            }
+            rdata.extend_from_slice(&self.data);
+        }
+        
         rdata
     }
 
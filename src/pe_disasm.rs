@@ -0,0 +1,621 @@
+// ============================================================================
+// PE DISASSEMBLY FRONT END
+// ============================================================================
+// Decodes the executable sections of a PE image straight into typed
+// `decompiler::Instruction` records. The analysis passes consume those records
+// directly; `render_listing` turns them back into the familiar `.asm` text only
+// when the listing has to be shown or saved.
+//
+// Decoding is recursive descent: starting from the entry point, the exports
+// and the x64 `.pdata` function starts, a worklist follows call/jmp/jcc
+// targets and only reachable bytes are ever decoded, so data and padding in
+// executable sections no longer need stop heuristics. Tracing only marks
+// where instructions begin; the marked instructions are decoded again,
+// window by window, as they are handed to the consumer.
+// ============================================================================
+
+use capstone::prelude::*;
+use goblin::pe::{self, PE};
+use rayon::prelude::*;
+use std::ops::Range;
+
+use crate::decompiler::Instruction;
+use crate::ir::{FlowClass, Mnemonic};
+use crate::pe_image;
+
+// Instructions fetched per Capstone call while following a run; bounds the
+// decoder's working set independently of section size
+const RUN_BATCH: usize = 64;
+
+// Large sections are cut at known function starts into segments of at least
+// this size, which are then traced on the rayon pool
+const MIN_SEGMENT_SIZE: usize = 256 * 1024;
+
+// Bytes of traced code decoded per job when the instructions are emitted;
+// a batch of these per rayon thread is the most ever held at once
+const EMIT_WINDOW: usize = 64 * 1024;
+const EMIT_WINDOWS_PER_THREAD: usize = 4;
+
+/// Typed result of disassembling a PE image.
+///
+/// `notes` are the listing comments (section headers, counts, ...) keyed by
+/// the index of the instruction they precede, so the text listing can be
+/// reproduced without storing it.
+#[derive(Debug, Clone, Default)]
+pub struct Disassembly {
+    pub instructions: Vec<Instruction>,
+    pub notes: Vec<(usize, String)>,
+    pub total_nops: usize,
+}
+
+/// Receives the disassembler's output in address order, section by section,
+/// without an intermediate text listing. Instructions arrive in batches of
+/// windows while later code is still being decoded. The disassembler itself
+/// keeps two bits per byte of executable code plus the batch being decoded,
+/// so a sink that does not collect (`Disassembly` does) runs in bounded
+/// memory however many instructions the image holds.
+pub trait InstructionSink {
+    fn instruction(&mut self, instr: Instruction);
+    fn note(&mut self, text: String);
+}
+
+impl InstructionSink for Disassembly {
+    fn instruction(&mut self, instr: Instruction) {
+        if instr.mnemonic == Mnemonic::NOP {
+            self.total_nops += 1;
+        }
+        self.instructions.push(instr);
+    }
+
+    fn note(&mut self, text: String) {
+        self.notes.push((self.instructions.len(), text));
+    }
+}
+
+/// Build a Capstone handle matching the image's bitness.
+pub fn build_capstone(is_64bit: bool) -> Result<Capstone, String> {
+    let arch_mode = if is_64bit {
+        capstone::arch::x86::ArchMode::Mode64
+    } else {
+        capstone::arch::x86::ArchMode::Mode32
+    };
+
+    Capstone::new()
+        .x86()
+        .mode(arch_mode)
+        .syntax(capstone::arch::x86::ArchSyntax::Intel)
+        .detail(true)
+        .build()
+        .map_err(|e| format!("Failed to initialize disassembler: {}", e))
+}
+
+/// Disassemble every executable section of `pe` into typed instructions.
+pub fn disassemble_pe(buffer: &[u8], pe: &PE) -> Result<Disassembly, String> {
+    let mut result = Disassembly::default();
+    stream_pe(buffer, pe, &mut result)?;
+    Ok(result)
+}
+
+/// Trace the reachable code of every executable section of `pe`, pushing
+/// instructions and listing notes into `sink` in address order.
+///
+/// Sections, and large sections cut at known function starts, are traced as
+/// independent segments on the rayon pool with one Capstone handle per worker.
+/// Tracing runs in rounds: branch targets that leave a segment are handed to
+/// the owning segment for the next round, until no new targets remain. Any
+/// segment can gain instructions in a later round, so tracing records only
+/// which bytes start an instruction. The traced instructions are then decoded
+/// again in `EMIT_WINDOW`s, a batch of windows at a time on the rayon pool,
+/// and each batch is pushed to `sink` before the next one is decoded.
+pub fn stream_pe(buffer: &[u8], pe: &PE, sink: &mut impl InstructionSink) -> Result<(), String> {
+    let code_starts = known_code_starts(pe);
+    let plans = plan_sections(buffer, pe, &code_starts);
+
+    let mut traces: Vec<SegmentTrace> = plans
+        .iter()
+        .flat_map(|plan| plan.segments.iter().map(|range| {
+            SegmentTrace::new(plan.va + range.start as u64, &plan.code[range.clone()])
+        }))
+        .collect();
+
+    // Segments sorted by address, for routing branch targets to their owner
+    let mut by_address: Vec<usize> = (0..traces.len()).collect();
+    by_address.sort_unstable_by_key(|&i| traces[i].va);
+
+    let is_64 = pe.is_64;
+    let mut pending = code_starts;
+    while !pending.is_empty() {
+        for addr in pending.drain(..) {
+            let slot = by_address.partition_point(|&i| traces[i].va <= addr);
+            if let Some(&owner) = slot.checked_sub(1).and_then(|slot| by_address.get(slot)) {
+                if traces[owner].contains(addr) {
+                    traces[owner].roots.push(addr);
+                }
+            }
+        }
+
+        let escaped: Vec<Vec<u64>> = traces
+            .par_iter_mut()
+            .map_init(
+                || build_capstone(is_64),
+                |cs, trace| match cs {
+                    Ok(cs) => Ok(trace.run(cs)),
+                    Err(e) => Err(e.clone()),
+                },
+            )
+            .collect::<Result<_, String>>()?;
+        pending = escaped.into_iter().flatten().collect();
+    }
+
+    let mut traces = traces.iter();
+    let entry_point = pe.entry as u64;
+    let batch_len = rayon::current_num_threads() * EMIT_WINDOWS_PER_THREAD;
+    for plan in &plans {
+        for note in &plan.notes {
+            sink.note(note.clone());
+        }
+        if plan.segments.is_empty() {
+            continue;
+        }
+
+        let mut section_insn_count = 0;
+        for trace in traces.by_ref().take(plan.segments.len()) {
+            let windows: Vec<Range<usize>> = (0..trace.code.len())
+                .step_by(EMIT_WINDOW)
+                .map(|start| start..(start + EMIT_WINDOW).min(trace.code.len()))
+                .collect();
+            for batch in windows.chunks(batch_len) {
+                let decoded: Vec<Vec<Instruction>> = batch
+                    .par_iter()
+                    .map_init(
+                        || build_capstone(is_64),
+                        |cs, window| match cs {
+                            Ok(cs) => Ok(trace.decode(cs, window.clone())),
+                            Err(e) => Err(e.clone()),
+                        },
+                    )
+                    .collect::<Result<_, String>>()?;
+                for instr in decoded.into_iter().flatten() {
+                    if instr.address == entry_point {
+                        sink.note(String::new());
+                        sink.note("; === ENTRY POINT ===".to_string());
+                    }
+                    sink.instruction(instr);
+                    section_insn_count += 1;
+                }
+            }
+        }
+
+        if section_insn_count == 0 {
+            sink.note("; No code reachable from the entry point, exports or .pdata".to_string());
+        }
+        sink.note(format!("; Section instructions: {}", section_insn_count));
+        sink.note(String::new());
+    }
+
+    Ok(())
+}
+
+/// One executable section as decided by the sequential pre-pass: the notes
+/// that precede it in the listing and the segments to trace.
+struct SectionPlan<'a> {
+    notes: Vec<String>,
+    code: &'a [u8],
+    va: u64,
+    segments: Vec<Range<usize>>,
+}
+
+fn plan_sections<'a>(buffer: &'a [u8], pe: &PE, code_starts: &[u64]) -> Vec<SectionPlan<'a>> {
+    let mut plans = Vec::new();
+    let entry_point = pe.entry as u64;
+
+    for section in &pe.sections {
+        if section.characteristics & pe::section_table::IMAGE_SCN_MEM_EXECUTE == 0 {
+            continue;
+        }
+
+        let name = pe_image::section_name(section);
+        let start = section.pointer_to_raw_data as usize;
+        let virtual_size = section.virtual_size as usize;
+        let raw_size = section.size_of_raw_data as usize;
+
+        let section_va = section.virtual_address as u64;
+        let section_end_va = section_va + raw_size.max(virtual_size) as u64;
+        let entry_in_section = entry_point >= section_va && entry_point < section_end_va;
+
+        // Rust executables often have virtual_size < raw_size due to alignment,
+        // so only trust virtual_size when it is reasonably large
+        let size = if virtual_size > 0 && virtual_size < raw_size && virtual_size > 0x100 {
+            virtual_size
+        } else {
+            raw_size
+        };
+
+        if start + size <= buffer.len() && size > 0 {
+            let code = &buffer[start..start + size];
+            plans.push(SectionPlan {
+                notes: vec![format!("; Section: {} (VA: 0x{:X}, Size: 0x{:X}, Raw: 0x{:X}{})",
+                    name,
+                    section_va,
+                    size,
+                    raw_size,
+                    if entry_in_section { ", ENTRY POINT HERE" } else { "" })],
+                code,
+                va: section_va,
+                segments: split_segments(code.len(), section_va, code_starts),
+            });
+        }
+    }
+
+    plans
+}
+
+/// Addresses where an instruction is known to begin: the entry point, export
+/// RVAs and the x64 `.pdata` function starts. Sorted and deduplicated.
+fn known_code_starts(pe: &PE) -> Vec<u64> {
+    let mut starts = vec![pe.entry as u64];
+    starts.extend(pe.exports.iter().map(|export| export.rva as u64));
+    starts.extend(pe_image::FunctionIndex::from_pe(pe).ranges().iter().map(|r| r.start));
+    starts.sort_unstable();
+    starts.dedup();
+    starts
+}
+
+/// Cut `len` bytes starting at `va` at known code starts, keeping every
+/// segment at least `MIN_SEGMENT_SIZE` long.
+fn split_segments(len: usize, va: u64, code_starts: &[u64]) -> Vec<Range<usize>> {
+    let end_va = va + len as u64;
+    let first = code_starts.partition_point(|&addr| addr <= va);
+    let mut segments = Vec::new();
+    let mut segment_start = 0;
+
+    for &addr in code_starts[first..].iter().take_while(|&&addr| addr < end_va) {
+        let offset = (addr - va) as usize;
+        if offset - segment_start >= MIN_SEGMENT_SIZE && len - offset >= MIN_SEGMENT_SIZE {
+            segments.push(segment_start..offset);
+            segment_start = offset;
+        }
+    }
+    segments.push(segment_start..len);
+    segments
+}
+
+/// How an instruction affects the trace
+#[derive(Debug, Clone, Copy, PartialEq)]
+enum Flow {
+    /// Falls through to the next instruction
+    Next,
+    /// call / jcc / loop: falls through and may also reach its target
+    Branch,
+    /// jmp: only reaches its target
+    Jump,
+    /// ret, hlt, ud2, int3: nothing follows
+    Stop,
+}
+
+fn classify_flow(mnemonic: Mnemonic) -> Flow {
+    match mnemonic.info().flow {
+        FlowClass::Jump => Flow::Jump,
+        FlowClass::Return | FlowClass::Stop => Flow::Stop,
+        FlowClass::Call | FlowClass::CondJump => Flow::Branch,
+        FlowClass::Sequential => Flow::Next,
+    }
+}
+
+/// Target of a direct branch (`call 0x401000`); `None` for register or
+/// memory operands.
+fn direct_target(operands: &str) -> Option<u64> {
+    let operands = operands.trim();
+    match operands.strip_prefix("0x") {
+        Some(hex) => u64::from_str_radix(hex, 16).ok(),
+        None => operands.parse().ok(),
+    }
+}
+
+/// Recursive-descent state for one contiguous range of an executable section.
+struct SegmentTrace<'a> {
+    va: u64,
+    code: &'a [u8],
+    /// One bit per byte already decoded as part of some instruction
+    covered: Vec<u64>,
+    /// One bit per byte where a traced instruction begins
+    starts: Vec<u64>,
+    /// Addresses queued for the next round
+    roots: Vec<u64>,
+}
+
+impl<'a> SegmentTrace<'a> {
+    fn new(va: u64, code: &'a [u8]) -> Self {
+        SegmentTrace {
+            va,
+            code,
+            covered: vec![0; code.len().div_ceil(64)],
+            starts: vec![0; code.len().div_ceil(64)],
+            roots: Vec::new(),
+        }
+    }
+
+    fn contains(&self, addr: u64) -> bool {
+        addr >= self.va && addr < self.va + self.code.len() as u64
+    }
+
+    fn is_covered(&self, offset: usize) -> bool {
+        self.covered[offset / 64] & (1 << (offset % 64)) != 0
+    }
+
+    fn cover(&mut self, offset: usize, len: usize) {
+        for byte in offset..(offset + len).min(self.code.len()) {
+            self.covered[byte / 64] |= 1 << (byte % 64);
+        }
+        self.starts[offset / 64] |= 1 << (offset % 64);
+    }
+
+    fn is_start(&self, offset: usize) -> bool {
+        self.starts[offset / 64] & (1 << (offset % 64)) != 0
+    }
+
+    /// First traced instruction start at or after `offset`
+    fn next_start(&self, offset: usize) -> Option<usize> {
+        let mut word = offset / 64;
+        let mut bits = *self.starts.get(word)? & (!0u64 << (offset % 64));
+        while bits == 0 {
+            word += 1;
+            bits = *self.starts.get(word)?;
+        }
+        Some(word * 64 + bits.trailing_zeros() as usize)
+    }
+
+    /// Follow control flow from the queued roots. Returns branch targets that
+    /// lie outside this segment.
+    fn run(&mut self, cs: &Capstone) -> Vec<u64> {
+        let mut worklist = std::mem::take(&mut self.roots);
+        let mut escaped = Vec::new();
+
+        while let Some(start) = worklist.pop() {
+            if !self.contains(start) {
+                escaped.push(start);
+                continue;
+            }
+
+            let mut pc = start;
+            'run: loop {
+                let offset = (pc - self.va) as usize;
+                if offset >= self.code.len() || self.is_covered(offset) {
+                    break;
+                }
+
+                let insns = match cs.disasm_count(&self.code[offset..], pc, RUN_BATCH) {
+                    Ok(insns) if !insns.is_empty() => insns,
+                    _ => break, // undecodable bytes end the run
+                };
+
+                for insn in insns.iter() {
+                    let addr = insn.address();
+                    let offset = (addr - self.va) as usize;
+                    if self.is_covered(offset) {
+                        break 'run; // joined code decoded earlier
+                    }
+                    self.cover(offset, insn.len());
+
+                    let flow = classify_flow(Mnemonic::intern(insn.mnemonic().unwrap_or("")));
+                    if matches!(flow, Flow::Branch | Flow::Jump) {
+                        if let Some(target) = direct_target(insn.op_str().unwrap_or("")) {
+                            worklist.push(target);
+                        }
+                    }
+
+                    pc = addr + insn.len() as u64;
+
+                    if matches!(flow, Flow::Jump | Flow::Stop) {
+                        break 'run;
+                    }
+                }
+
+                if insns.len() < RUN_BATCH {
+                    break; // Capstone stopped early: invalid bytes or end of segment
+                }
+            }
+        }
+
+        escaped
+    }
+
+    /// Decode the traced instructions that begin in `window` (offsets into
+    /// the segment), in address order. Runs of adjacent instructions are
+    /// decoded a batch at a time; a run ends where tracing stopped (after a
+    /// jump, before data) or where another traced instruction overlaps it.
+    fn decode(&self, cs: &Capstone, window: Range<usize>) -> Vec<Instruction> {
+        let mut instructions = Vec::new();
+        let mut cursor = window.start;
+
+        while let Some(start) = self.next_start(cursor).filter(|&start| start < window.end) {
+            cursor = start + 1;
+            let Ok(insns) = cs.disasm_count(&self.code[start..], self.va + start as u64, RUN_BATCH) else {
+                continue;
+            };
+
+            for insn in insns.iter() {
+                let offset = (insn.address() - self.va) as usize;
+                if offset >= window.end || !self.is_start(offset) {
+                    break;
+                }
+                let operands = sanitize_operands(insn.op_str().unwrap_or(""));
+                instructions.push(Instruction::new(insn.address(), insn.mnemonic().unwrap_or(""), &operands));
+                cursor = offset + 1;
+                if self.next_start(cursor) != Some(offset + insn.len()) {
+                    break;
+                }
+            }
+        }
+
+        instructions
+    }
+}
+
+/// Binary data can contain invalid UTF-8, null bytes, or BOM characters;
+/// keep only printable characters and whitespace.
+fn sanitize_operands(operands: &str) -> String {
+    operands
+        .chars()
+        .filter(|&c| c != '\u{feff}' && (!c.is_control() || c.is_whitespace()))
+        .collect()
+}
+
+/// Render a disassembly as the text listing shown in the editor and written
+/// to `<name>_full.asm`.
+pub fn render_listing(disasm: &Disassembly) -> String {
+    let mut listing = String::with_capacity(disasm.instructions.len() * 40);
+    let mut notes = disasm.notes.iter().peekable();
+
+    for (i, instr) in disasm.instructions.iter().enumerate() {
+        while let Some((_, text)) = notes.next_if(|(at, _)| *at <= i) {
+            listing.push_str(text);
+            listing.push('\n');
+        }
+        listing.push_str(&format!("{:08X}  {:<8} {}\n", instr.address, instr.mnemonic, instr.operands));
+    }
+    for (_, text) in notes {
+        listing.push_str(text);
+        listing.push('\n');
+    }
+
+    if listing.is_empty() {
+        listing.push_str("; No executable sections found\n");
+        return listing;
+    }
+
+    let total_instructions = disasm.instructions.len();
+    listing.push_str(&format!("; Total instructions disassembled: {}\n", total_instructions));
+
+    if total_instructions > 0 {
+        let nop_percentage = (disasm.total_nops as f64 / total_instructions as f64) * 100.0;
+        listing.push_str(&format!("; NOP instructions: {} ({:.1}%)\n", disasm.total_nops, nop_percentage));
+
+        // >50% NOPs indicates data being disassembled as code
+        if nop_percentage > 50.0 && total_instructions > 100 {
+            listing.push_str(";\n");
+            listing.push_str("; ╔═══════════════════════════════════════════════════════════════════╗\n");
+            listing.push_str("; ║                         ⚠️  WARNING  ⚠️                            ║\n");
+            listing.push_str("; ╠═══════════════════════════════════════════════════════════════════╣\n");
+            listing.push_str(&format!("; ║ This disassembly contains {:.1}% NOP instructions!              ║\n", nop_percentage));
+            listing.push_str("; ║                                                                   ║\n");
+            listing.push_str("; ║ This strongly indicates the disassembler is processing DATA       ║\n");
+            listing.push_str("; ║ sections, padding, or resources as CODE.                          ║\n");
+            listing.push_str("; ║                                                                   ║\n");
+            listing.push_str("; ║ ❌ DO NOT attempt to reassemble this code - it will fail!         ║\n");
+            listing.push_str("; ║                                                                   ║\n");
+            listing.push_str("; ║ ✅ RECOMMENDED SOLUTION:                                          ║\n");
+            listing.push_str("; ║    Use C or Rust decompilation instead of assembly output.       ║\n");
+            listing.push_str("; ║    Decompiled code is compilable and produces working binaries.  ║\n");
+            listing.push_str("; ╚═══════════════════════════════════════════════════════════════════╝\n");
+        }
+    }
+
+    listing
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_render_listing_interleaves_notes() {
+        let disasm = Disassembly {
+            instructions: vec![
+                Instruction::new(0x401000, "push", "rbp"),
+                Instruction::new(0x401001, "ret", ""),
+            ],
+            notes: vec![(0, "; Section: .text".to_string()), (2, "; Section instructions: 2".to_string())],
+            total_nops: 0,
+        };
+
+        let listing = render_listing(&disasm);
+        let lines: Vec<&str> = listing.lines().collect();
+        assert_eq!(lines[0], "; Section: .text");
+        assert_eq!(lines[1], "00401000  push     rbp");
+        assert_eq!(lines[3], "; Section instructions: 2");
+        assert_eq!(lines[4], "; Total instructions disassembled: 2");
+    }
+
+    #[test]
+    fn test_flow_classification() {
+        assert_eq!(classify_flow(Mnemonic::JNE), Flow::Branch);
+        assert_eq!(classify_flow(Mnemonic::CALL), Flow::Branch);
+        assert_eq!(classify_flow(Mnemonic::intern("loopne")), Flow::Branch);
+        assert_eq!(classify_flow(Mnemonic::JMP), Flow::Jump);
+        assert_eq!(classify_flow(Mnemonic::RET), Flow::Stop);
+        assert_eq!(classify_flow(Mnemonic::intern("mov")), Flow::Next);
+        assert_eq!(direct_target("0x140001a30"), Some(0x140001a30));
+        assert_eq!(direct_target("qword ptr [rip + 0x2000]"), None);
+    }
+
+    #[test]
+    fn test_trace_follows_control_flow() {
+        let code = [
+            0xe8, 0xfb, 0x0f, 0x00, 0x00, // 1000: call 0x2000 (another segment)
+            0xeb, 0x02,                   // 1005: jmp 0x1009
+            0xff, 0xff,                   // 1007: data
+            0x74, 0xf5,                   // 1009: je 0x1000 (already traced)
+            0xc3,                         // 100b: ret
+        ];
+        let callee = [0xc3];              // 2000: ret
+        let cs = build_capstone(true).unwrap();
+
+        let mut trace = SegmentTrace::new(0x1000, &code);
+        trace.roots.push(0x1000);
+        let escaped = trace.run(&cs);
+        assert_eq!(escaped, vec![0x2000]);
+        let addresses: Vec<u64> = trace.decode(&cs, 0..code.len()).iter().map(|instr| instr.address).collect();
+        assert_eq!(addresses, vec![0x1000, 0x1005, 0x1009, 0x100b]);
+        assert!(!trace.is_covered(7) && !trace.is_covered(8));
+
+        // The escaped call target is traced by the segment that owns it
+        let mut other = SegmentTrace::new(0x2000, &callee);
+        assert!(!trace.contains(0x2000) && other.contains(0x2000));
+        other.roots.extend(escaped);
+        assert!(other.run(&cs).is_empty());
+        assert_eq!(other.decode(&cs, 0..1).len(), 1);
+
+        // Re-queuing traced code decodes nothing new
+        trace.roots.push(0x1009);
+        assert!(trace.run(&cs).is_empty());
+        assert_eq!(trace.decode(&cs, 0..code.len()).len(), 4);
+    }
+
+    #[test]
+    fn test_decode_replays_trace_by_window() {
+        let code = [
+            0x55,                         // 1000: push rbp
+            0xb8, 0x2a, 0x00, 0x00, 0x00, // 1001: mov eax, 0x2a
+            0xeb, 0x02,                   // 1006: jmp 0x100a
+            0xff, 0xff,                   // 1008: data
+            0x5d,                         // 100a: pop rbp
+            0xc3,                         // 100b: ret
+        ];
+        let cs = build_capstone(true).unwrap();
+        let mut trace = SegmentTrace::new(0x1000, &code);
+        trace.roots.push(0x1000);
+        assert!(trace.run(&cs).is_empty());
+
+        let addresses = |instructions: Vec<Instruction>| instructions.iter().map(|instr| instr.address).collect::<Vec<_>>();
+        let whole = addresses(trace.decode(&cs, 0..code.len()));
+        assert_eq!(whole, vec![0x1000, 0x1001, 0x1006, 0x100a, 0x100b]);
+        // Windows may cut through an instruction; it belongs to the window it starts in
+        for cut in 1..code.len() {
+            let mut split = addresses(trace.decode(&cs, 0..cut));
+            split.extend(addresses(trace.decode(&cs, cut..code.len())));
+            assert_eq!(split, whole, "cut at {}", cut);
+        }
+    }
+
+    #[test]
+    fn test_split_segments_at_known_starts() {
+        let va = 0x1000;
+        let len = 3 * MIN_SEGMENT_SIZE;
+        // Too close to the start, a usable cut, and too close to the end
+        let starts = [va + 0x10, va + MIN_SEGMENT_SIZE as u64 + 0x40, va + len as u64 - 0x20];
+        let segments = split_segments(len, va, &starts);
+        assert_eq!(segments, vec![0..MIN_SEGMENT_SIZE + 0x40, MIN_SEGMENT_SIZE + 0x40..len]);
+        assert_eq!(split_segments(0x100, va, &starts), vec![0..0x100]);
+    }
+}
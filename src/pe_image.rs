@@ -0,0 +1,253 @@
+// ============================================================================
+// LOADED PE IMAGE  (shared, memory-mapped)
+// ============================================================================
+// One handle per input binary: the file is memory-mapped once, parsed with
+// goblin once, and every consumer (disassembler, decompiler PE info, PE info
+// report, reassembler, relocator) borrows section slices straight out of the
+// mapping instead of reading and copying the file again.
+// ============================================================================
+
+use goblin::pe::section_table::SectionTable;
+use goblin::pe::PE;
+use memmap2::Mmap;
+use std::fmt;
+use std::fs::File;
+use std::ops::Range;
+use std::path::{Path, PathBuf};
+use std::sync::Arc;
+
+pub struct LoadedImage {
+    // `pe` borrows from `map`; it is declared first so it is dropped first.
+    pe: PE<'static>,
+    map: Mmap,
+    path: PathBuf,
+}
+
+impl LoadedImage {
+    /// Map and parse the PE at `path`. The returned handle is cheap to clone
+    /// and can be shared across threads.
+    pub fn open(path: &Path) -> Result<Arc<LoadedImage>, String> {
+        let file = File::open(path)
+            .map_err(|e| format!("Failed to read file: {}", e))?;
+        let len = file.metadata()
+            .map_err(|e| format!("Failed to read file metadata: {}", e))?
+            .len();
+
+        // Mapping a zero-length file fails on some platforms; report it the
+        // same way as any other undersized file
+        if len < 2 {
+            return Err(too_small_error());
+        }
+
+        // SAFETY: the mapping is read-only and we never hand out mutable
+        // access; truncating the file underneath us is outside what the tool
+        // supports (the same as `fs::read` racing a writer).
+        let map = unsafe { Mmap::map(&file) }
+            .map_err(|e| format!("Failed to map file: {}", e))?;
+
+        // SAFETY: the mapped bytes live at a stable address for as long as
+        // `map` does, and `pe` is dropped before `map` (field order above).
+        // The 'static lifetime never escapes: `pe()` re-borrows it for the
+        // lifetime of `&self`.
+        let bytes: &'static [u8] = unsafe { std::slice::from_raw_parts(map.as_ptr(), map.len()) };
+        let pe = parse_pe(bytes)?;
+
+        Ok(Arc::new(LoadedImage {
+            pe,
+            map,
+            path: path.to_path_buf(),
+        }))
+    }
+
+    pub fn pe(&self) -> &PE<'_> {
+        &self.pe
+    }
+
+    /// The whole file as mapped
+    pub fn bytes(&self) -> &[u8] {
+        &self.map
+    }
+
+    pub fn path(&self) -> &Path {
+        &self.path
+    }
+
+    /// File range holding a section's raw data, clamped to the file size
+    pub fn section_range(&self, section: &SectionTable) -> Range<usize> {
+        let start = (section.pointer_to_raw_data as usize).min(self.map.len());
+        let end = start.saturating_add(section.size_of_raw_data as usize).min(self.map.len());
+        start..end
+    }
+
+    /// Raw bytes of a section, borrowed from the mapping
+    pub fn section_data(&self, section: &SectionTable) -> &[u8] {
+        &self.map[self.section_range(section)]
+    }
+
+    /// File range of `size` bytes starting at `rva`, if it lies inside a
+    /// section's raw data
+    pub fn rva_range(&self, rva: usize, size: usize) -> Option<Range<usize>> {
+        let section = self.section_at(rva)?;
+        let file_offset = section.pointer_to_raw_data as usize + (rva - section.virtual_address as usize);
+        let end = file_offset.checked_add(size)?;
+        (end <= self.map.len()).then_some(file_offset..end)
+    }
+
+    /// Raw bytes for `rvas`, cut short at the end of the raw data of the
+    /// section holding `rvas.start`
+    pub fn rva_bytes(&self, rvas: Range<usize>) -> Option<&[u8]> {
+        let section = self.section_at(rvas.start)?;
+        let raw_end = section.virtual_address as usize + section.size_of_raw_data as usize;
+        let size = rvas.end.min(raw_end).checked_sub(rvas.start)?;
+        self.rva_range(rvas.start, size).map(|range| &self.map[range])
+    }
+
+    fn section_at(&self, rva: usize) -> Option<&SectionTable> {
+        self.pe.sections.iter().find(|s| {
+            let start = s.virtual_address as usize;
+            let end = start + s.virtual_size.max(s.size_of_raw_data) as usize;
+            rva >= start && rva < end
+        })
+    }
+}
+
+impl fmt::Debug for LoadedImage {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.debug_struct("LoadedImage")
+            .field("path", &self.path)
+            .field("size", &self.map.len())
+            .field("sections", &self.pe.sections.len())
+            .finish()
+    }
+}
+
+pub fn section_name(section: &SectionTable) -> String {
+    String::from_utf8_lossy(&section.name).trim_end_matches('\0').to_string()
+}
+
+fn too_small_error() -> String {
+    "File is too small to be a valid PE executable.\n\n\
+    This file does not appear to be a Windows executable (.exe/.dll).\n\
+    Please select a valid PE file.".to_string()
+}
+
+/// Validate the DOS header and parse the PE structure, returning the same
+/// user-facing error messages the TUI has always shown.
+pub fn parse_pe(buffer: &[u8]) -> Result<PE<'_>, String> {
+    if buffer.len() < 2 {
+        return Err(too_small_error());
+    }
+
+    // Check for MZ signature (DOS header magic number)
+    if buffer[0] != 0x4D || buffer[1] != 0x5A {  // "MZ" in ASCII
+        let actual_sig = format!("0x{:02x}{:02x}", buffer[1], buffer[0]);
+        return Err(format!(
+            "Invalid PE file format (DOS signature mismatch).\n\n\
+            Expected: 0x5a4d (\"MZ\" - valid Windows executable)\n\
+            Found:    {} (not a PE file)\n\n\
+            This file is NOT a Windows executable (.exe/.dll).\n\n\
+            Possible causes:\n\
+            • The file is corrupted or incomplete\n\
+            • The file is a different format (ELF, Mach-O, script, etc.)\n\
+            • The file was not compiled successfully\n\
+            • You selected the wrong file\n\n\
+            Please ensure you're selecting a valid Windows PE executable.",
+            actual_sig
+        ));
+    }
+
+    PE::parse(buffer)
+        .map_err(|e| format!(
+            "Failed to parse PE file structure: {}\n\n\
+            The file has a valid DOS header but the PE structure is malformed.\n\n\
+            Possible causes:\n\
+            • The executable is corrupted\n\
+            • The file is packed/encrypted (use a unpacker first)\n\
+            • The PE headers are damaged\n\
+            • The file is not a standard Windows executable\n\n\
+            Try:\n\
+            • Recompiling the program\n\
+            • Using a different executable\n\
+            • Unpacking if it's a packed executable",
+            e
+        ))
+}
+
+// ============================================================================
+// EXCEPTION DIRECTORY FUNCTION INDEX  (x64 .pdata)
+// ============================================================================
+
+/// Sorted, non-overlapping `[begin, end)` ranges of the `RUNTIME_FUNCTION`
+/// entries in an x64 image's exception directory. Ranges are RVAs, the same
+/// address space `pe_disasm` reports instructions in. Empty for x86 images and
+/// images without `.pdata`.
+#[derive(Debug, Clone, Default)]
+pub struct FunctionIndex {
+    ranges: Vec<Range<u64>>,
+}
+
+impl FunctionIndex {
+    pub fn from_pe(pe: &PE) -> Self {
+        let ranges = match &pe.exception_data {
+            Some(exception_data) if pe.is_64 => exception_data
+                .functions()
+                .filter_map(Result::ok)
+                .map(|f| f.begin_address as u64..f.end_address as u64)
+                .collect(),
+            _ => Vec::new(),
+        };
+        Self::from_ranges(ranges)
+    }
+
+    /// Normalise raw entries: drop empty ones, sort, and keep the first of
+    /// any overlapping pair (the table is sorted by spec, but malformed or
+    /// packed images are not).
+    pub fn from_ranges(mut ranges: Vec<Range<u64>>) -> Self {
+        ranges.retain(|r| r.start < r.end);
+        ranges.sort_unstable_by_key(|r| r.start);
+        ranges.dedup_by(|next, prev| next.start < prev.end);
+        FunctionIndex { ranges }
+    }
+
+    pub fn ranges(&self) -> &[Range<u64>] {
+        &self.ranges
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.ranges.is_empty()
+    }
+
+    /// Function starts inside `span`, found in O(log n)
+    pub fn starts_in(&self, span: Range<u64>) -> impl Iterator<Item = u64> + '_ {
+        let first = self.ranges.partition_point(|r| r.start < span.start);
+        self.ranges[first..]
+            .iter()
+            .map(|r| r.start)
+            .take_while(move |&start| start < span.end)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_parse_pe_rejects_non_mz() {
+        assert!(parse_pe(b"\x7fELF").unwrap_err().contains("DOS signature mismatch"));
+        assert!(parse_pe(b"M").unwrap_err().contains("too small"));
+    }
+
+    #[test]
+    fn test_open_missing_file() {
+        let err = LoadedImage::open(Path::new("does/not/exist.exe")).unwrap_err();
+        assert!(err.starts_with("Failed to read file"));
+    }
+
+    #[test]
+    fn test_function_index_normalises_and_looks_up() {
+        let index = FunctionIndex::from_ranges(vec![0x3000..0x3080, 0x1000..0x1040, 0x1020..0x1060, 0x2000..0x2000]);
+        assert_eq!(index.ranges(), &[0x1000..0x1040, 0x3000..0x3080]);
+        assert_eq!(index.starts_in(0x1000..0x3000).collect::<Vec<_>>(), vec![0x1000]);
+        assert_eq!(index.starts_in(0x1001..0x4000).collect::<Vec<_>>(), vec![0x3000]);
+    }
+}
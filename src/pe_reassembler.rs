@@ -8,14 +8,18 @@
 //
 // ============================================================================
 
-use goblin::pe::PE;
 use std::fs;
+use std::ops::Range;
 use std::path::Path;
+use std::sync::Arc;
 use crate::pe_fixer;
+use crate::pe_image::{self, LoadedImage};
 
+/// Everything the reassembler needs from the original executable. Section and
+/// directory contents are file ranges into the shared mapping, not copies.
 #[derive(Debug, Clone)]
 pub struct PreservedPEData {
-    pub original_pe: Vec<u8>,
+    pub image: Arc<LoadedImage>,
     #[allow(dead_code)]
     pub image_base: u64,
     pub entry_point: u32,
@@ -23,11 +27,29 @@ pub struct PreservedPEData {
     #[allow(dead_code)]
     pub imports: Vec<ImportDescriptor>,
     #[allow(dead_code)]
-    pub exports: Option<Vec<u8>>,
+    pub exports: Option<Range<usize>>,
     #[allow(dead_code)]
-    pub resources: Option<Vec<u8>>,
+    pub resources: Option<Range<usize>>,
     #[allow(dead_code)]
-    pub relocations: Option<Vec<u8>>,
+    pub relocations: Option<Range<usize>>,
+}
+
+impl PreservedPEData {
+    /// The original executable bytes, borrowed from the mapping
+    pub fn original_pe(&self) -> &[u8] {
+        self.image.bytes()
+    }
+
+    #[allow(dead_code)]
+    pub fn section_data(&self, section: &PreservedSection) -> &[u8] {
+        &self.original_pe()[section.raw_range.clone()]
+    }
+
+    /// Bytes of a preserved data directory (`exports`, `resources`, `relocations`)
+    #[allow(dead_code)]
+    pub fn directory_data(&self, range: &Option<Range<usize>>) -> Option<&[u8]> {
+        range.as_ref().map(|r| &self.original_pe()[r.clone()])
+    }
 }
 
 #[derive(Debug, Clone)]
@@ -35,7 +57,8 @@ pub struct PreservedSection {
     pub name: String,
     pub virtual_address: u32,
     pub virtual_size: u32,
-    pub raw_data: Vec<u8>,
+    /// File range of the section's raw data inside `PreservedPEData::image`
+    pub raw_range: Range<usize>,
     pub characteristics: u32,
 }
 
@@ -67,16 +90,13 @@ pub struct ReassemblyOptions {
 pub fn extract_pe_structure(exe_path: &Path) -> Result<PreservedPEData, String> {
     println!("📦 [DEBUG] Extracting PE structure from: {}", exe_path.display());
     
-    // Read the original executable
-    let buffer = fs::read(exe_path)
-        .map_err(|e| format!("Failed to read executable: {}", e))?;
+    // Map and parse the original executable
+    let image = LoadedImage::open(exe_path)?;
+    let buffer = image.bytes();
+    let pe = image.pe();
     
     println!("   [DEBUG] File size: {} bytes", buffer.len());
     
-    // Parse the PE
-    let pe = PE::parse(&buffer)
-        .map_err(|e| format!("Failed to parse PE: {}", e))?;
-    
     println!("   [DEBUG] Image base: 0x{:x}", pe.image_base);
     println!("   [DEBUG] Entry point: 0x{:x}", pe.entry);
     println!("   [DEBUG] Sections: {}", pe.sections.len());
@@ -85,40 +105,33 @@ pub fn extract_pe_structure(exe_path: &Path) -> Result<PreservedPEData, String>
     // Extract all sections
     let mut sections = Vec::new();
     for section in &pe.sections {
-        let name = String::from_utf8_lossy(&section.name)
-            .trim_end_matches('\0')
-            .to_string();
+        let name = pe_image::section_name(section);
         
-        let raw_data = if section.size_of_raw_data > 0 {
-            let start = section.pointer_to_raw_data as usize;
-            let size = section.size_of_raw_data as usize;
-            
-            if start + size <= buffer.len() {
-                buffer[start..start + size].to_vec()
-            } else {
-                Vec::new()
-            }
+        let start = section.pointer_to_raw_data as usize;
+        let size = section.size_of_raw_data as usize;
+        let raw_range = if size > 0 && start + size <= buffer.len() {
+            start..start + size
         } else {
-            Vec::new()
+            0..0
         };
         
         println!("   [DEBUG] • {} (RVA: 0x{:x}, VSize: {}, RawSize: {}, Characteristics: 0x{:x})", 
-                 name, section.virtual_address, section.virtual_size, raw_data.len(), section.characteristics);
+                 name, section.virtual_address, section.virtual_size, raw_range.len(), section.characteristics);
         
         sections.push(PreservedSection {
             name,
             virtual_address: section.virtual_address,
             virtual_size: section.virtual_size,
-            raw_data,
+            raw_range,
             characteristics: section.characteristics,
         });
     }
     
     // Extract imports
     let mut imports = Vec::new();
-    if let Some(import_data) = pe.import_data {
+    if let Some(import_data) = &pe.import_data {
         println!("   [DEBUG] Extracting imports...");
-        for import in import_data.import_data {
+        for import in &import_data.import_data {
             let dll_name = import.name.to_string();
             let functions = Vec::new();
             
@@ -137,7 +150,7 @@ pub fn extract_pe_structure(exe_path: &Path) -> Result<PreservedPEData, String>
     }
     
     // Extract exports (if present)
-    let exports = if let Some(_export_data) = pe.export_data {
+    let exports = if let Some(_export_data) = &pe.export_data {
         // Find the export directory in the data directories
         let export_table_opt = pe.header.optional_header.as_ref()
             .and_then(|oh| oh.data_directories.get_export_table().as_ref());
@@ -156,9 +169,9 @@ pub fn extract_pe_structure(exe_path: &Path) -> Result<PreservedPEData, String>
                 let file_offset = section.pointer_to_raw_data as usize + offset_in_section;
                 
                 if file_offset + export_size <= buffer.len() {
-                    let export_bytes = buffer[file_offset..file_offset + export_size].to_vec();
-                    println!("   [DEBUG] ✅ Exports extracted: {} bytes", export_bytes.len());
-                    Some(export_bytes)
+                    let export_range = file_offset..file_offset + export_size;
+                    println!("   [DEBUG] ✅ Exports located: {} bytes", export_range.len());
+                    Some(export_range)
                 } else {
                     println!("   [DEBUG] ⚠️  Export data out of bounds");
                     None
@@ -195,9 +208,9 @@ pub fn extract_pe_structure(exe_path: &Path) -> Result<PreservedPEData, String>
                 let file_offset = section.pointer_to_raw_data as usize + offset_in_section;
                 
                 if file_offset + resource_size <= buffer.len() {
-                    let resource_bytes = buffer[file_offset..file_offset + resource_size].to_vec();
-                    println!("   [DEBUG] ✅ Resources extracted: {} bytes", resource_bytes.len());
-                    Some(resource_bytes)
+                    let resource_range = file_offset..file_offset + resource_size;
+                    println!("   [DEBUG] ✅ Resources located: {} bytes", resource_range.len());
+                    Some(resource_range)
                 } else {
                     println!("   [DEBUG] ⚠️  Resource data out of bounds");
                     None
@@ -234,9 +247,9 @@ pub fn extract_pe_structure(exe_path: &Path) -> Result<PreservedPEData, String>
                 let file_offset = section.pointer_to_raw_data as usize + offset_in_section;
                 
                 if file_offset + reloc_size <= buffer.len() {
-                    let reloc_bytes = buffer[file_offset..file_offset + reloc_size].to_vec();
-                    println!("   [DEBUG] ✅ Relocations extracted: {} bytes (ASLR support)", reloc_bytes.len());
-                    Some(reloc_bytes)
+                    let reloc_range = file_offset..file_offset + reloc_size;
+                    println!("   [DEBUG] ✅ Relocations located: {} bytes (ASLR support)", reloc_range.len());
+                    Some(reloc_range)
                 } else {
                     println!("   [DEBUG] ⚠️  Relocation data out of bounds");
                     None
@@ -257,7 +270,6 @@ pub fn extract_pe_structure(exe_path: &Path) -> Result<PreservedPEData, String>
     println!("   [DEBUG] ✅ PE structure extraction complete!");
     
     Ok(PreservedPEData {
-        original_pe: buffer.clone(),
         image_base: pe.image_base as u64,
         entry_point: pe.entry as u32,
         sections,
@@ -265,6 +277,7 @@ pub fn extract_pe_structure(exe_path: &Path) -> Result<PreservedPEData, String>
         exports,
         resources,
         relocations,
+        image,
     })
 }
 
@@ -277,10 +290,9 @@ pub fn reassemble_with_preserved_data(
 ) -> Result<(), String> {
     // CRITICAL: Validate and fix code before reassembly
     println!("🔍 [PE_REASSEMBLER] Validating assembled code...");
-    let pe = PE::parse(&preserved.original_pe)
-        .map_err(|e| format!("Failed to parse PE: {}", e))?;
+    let pe = preserved.image.pe();
     
-    let validation = pe_fixer::validate_assembled_code(&new_code, &pe, 0);
+    let validation = pe_fixer::validate_assembled_code(&new_code, pe, 0);
     
     if !validation.is_valid {
         println!("⚠️  [PE_REASSEMBLER] Validation found critical issues!");
@@ -288,7 +300,7 @@ pub fn reassemble_with_preserved_data(
         
         // Try to auto-fix
         println!("🔧 [PE_REASSEMBLER] Attempting automatic fixes...");
-        let fixes = pe_fixer::auto_fix_code(&mut new_code, &pe, &validation);
+        let fixes = pe_fixer::auto_fix_code(&mut new_code, pe, &validation);
         
         if !fixes.is_empty() {
             println!("✅ [PE_REASSEMBLER] Applied {} fixes", fixes.len());
@@ -297,7 +309,7 @@ pub fn reassemble_with_preserved_data(
             }
             
             // Re-validate after fixes
-            let revalidation = pe_fixer::validate_assembled_code(&new_code, &pe, 0);
+            let revalidation = pe_fixer::validate_assembled_code(&new_code, pe, 0);
             if !revalidation.is_valid {
                 return Err(format!(
                     "Code validation failed even after automatic fixes:\n{}",
@@ -341,12 +353,12 @@ fn reassemble_with_options(
     allow_expansion: bool,
 ) -> Result<(), String> {
     println!("🔨 [DEBUG] Reassembling PE with new code...");
-    println!("   [DEBUG] Original PE size: {} bytes", preserved.original_pe.len());
+    println!("   [DEBUG] Original PE size: {} bytes", preserved.original_pe().len());
     println!("   [DEBUG] New code size: {} bytes", new_code.len());
     println!("   [DEBUG] Allow expansion: {}", allow_expansion);
     
     // Strategy: Clone the original PE and replace only the .text section
-    let mut new_pe = preserved.original_pe.clone();
+    let mut new_pe = preserved.original_pe().to_vec();
     
     // Find the .text section in the original PE
     let text_section = preserved.sections.iter()
@@ -356,13 +368,12 @@ fn reassemble_with_options(
     println!("   [DEBUG] Original .text section:");
     println!("      [DEBUG] RVA: 0x{:x}", text_section.virtual_address);
     println!("      [DEBUG] Virtual Size: {} bytes", text_section.virtual_size);
-    println!("      [DEBUG] Raw Data Size: {} bytes", text_section.raw_data.len());
+    println!("      [DEBUG] Raw Data Size: {} bytes", text_section.raw_range.len());
     println!("      [DEBUG] Characteristics: 0x{:x}", text_section.characteristics);
     
     // Calculate where the .text section is in the file
     // We need to find the file offset from the section headers
-    let pe = PE::parse(&preserved.original_pe)
-        .map_err(|e| format!("Failed to re-parse PE: {}", e))?;
+    let pe = preserved.image.pe();
     
     let text_section_header = pe.sections.iter()
         .find(|s| {
@@ -536,8 +547,7 @@ fn expand_section_and_reassemble(
     println!("   [DEBUG] 📏 New section size (aligned): {} bytes", new_size);
     
     // Parse PE to get section headers
-    let pe = PE::parse(&preserved.original_pe)
-        .map_err(|e| format!("Failed to parse PE: {}", e))?;
+    let pe = preserved.image.pe();
     
     // Find .text section index
     let text_section_idx = pe.sections.iter()
@@ -555,7 +565,7 @@ fn expand_section_and_reassemble(
     // 3. Copy everything after .text section (shifted by expansion amount)
     
     let expansion_size = new_size - old_size;
-    let mut new_pe = Vec::with_capacity(preserved.original_pe.len() + expansion_size);
+    let mut new_pe = Vec::with_capacity(preserved.original_pe().len() + expansion_size);
     
     println!("   [DEBUG] Expansion size: {} bytes", expansion_size);
     println!("   [DEBUG] New PE capacity: {} bytes", new_pe.capacity());
@@ -570,7 +580,7 @@ fn expand_section_and_reassemble(
     println!("   [DEBUG] First section offset: 0x{:x}", first_section_offset);
     
     // Copy headers
-    new_pe.extend_from_slice(&preserved.original_pe[..first_section_offset]);
+    new_pe.extend_from_slice(&preserved.original_pe()[..first_section_offset]);
     
     // Now copy sections, expanding .text
     for (idx, section) in pe.sections.iter().enumerate() {
@@ -588,10 +598,10 @@ fn expand_section_and_reassemble(
             new_pe.extend(vec![0x90; padding]); // NOP padding
         } else {
             // Copy other sections as-is
-            if section_size > 0 && section_offset + section_size <= preserved.original_pe.len() {
+            if section_size > 0 && section_offset + section_size <= preserved.original_pe().len() {
                 println!("   [DEBUG] Copying section {} at offset 0x{:x} ({} bytes)", 
                          idx, section_offset, section_size);
-                new_pe.extend_from_slice(&preserved.original_pe[section_offset..section_offset + section_size]);
+                new_pe.extend_from_slice(&preserved.original_pe()[section_offset..section_offset + section_size]);
             }
         }
     }
@@ -603,16 +613,16 @@ fn expand_section_and_reassemble(
     // PE structure: DOS header (64 bytes) + DOS stub + PE signature (4 bytes) + COFF header (20 bytes) + Optional header + Section headers
     let _dos_header_size = 64;
     let pe_signature_offset = u32::from_le_bytes([
-        preserved.original_pe[0x3C],
-        preserved.original_pe[0x3D],
-        preserved.original_pe[0x3E],
-        preserved.original_pe[0x3F],
+        preserved.original_pe()[0x3C],
+        preserved.original_pe()[0x3D],
+        preserved.original_pe()[0x3E],
+        preserved.original_pe()[0x3F],
     ]) as usize;
     
     let coff_header_offset = pe_signature_offset + 4; // After "PE\0\0"
     let optional_header_size = u16::from_le_bytes([
-        preserved.original_pe[coff_header_offset + 16],
-        preserved.original_pe[coff_header_offset + 17],
+        preserved.original_pe()[coff_header_offset + 16],
+        preserved.original_pe()[coff_header_offset + 17],
     ]) as usize;
     
     let section_headers_offset = coff_header_offset + 20 + optional_header_size;
@@ -498,24 +498,9 @@ fn create_sample_context() -> ScriptContext {
     
     ScriptContext {
         instructions: vec![
-            Instruction {
-                address: 0x401000,
-                mnemonic: "push".to_string(),
-                operands: "ebp".to_string(),
-                raw_line: "push ebp".to_string(),
-            },
-            Instruction {
-                address: 0x401001,
-                mnemonic: "mov".to_string(),
-                operands: "ebp, esp".to_string(),
-                raw_line: "mov ebp, esp".to_string(),
-            },
-            Instruction {
-                address: 0x401003,
-                mnemonic: "xor".to_string(),
-                operands: "eax, eax".to_string(),
-                raw_line: "xor eax, eax".to_string(),
-            },
+            Instruction::new(0x401000, "push", "ebp").with_raw_line("push ebp"),
+            Instruction::new(0x401001, "mov", "ebp, esp").with_raw_line("mov ebp, esp"),
+            Instruction::new(0x401003, "xor", "eax, eax").with_raw_line("xor eax, eax"),
         ],
         functions: vec![
             Function {
@@ -106,13 +106,8 @@ pub struct ScriptContext {
     pub metadata: HashMap<String, String>,
 }
 
-#[derive(Debug, Clone, Serialize, Deserialize)]
-pub struct Instruction {
-    pub address: u64,
-    pub mnemonic: String,
-    pub operands: String,
-    pub raw_line: String,
-}
+/// Scripts see the same instruction records the decompiler works on
+pub use crate::ir::Instruction;
 
 #[derive(Debug, Clone, Serialize, Deserialize)]
 pub struct Function {
@@ -618,7 +613,7 @@ Instruction Object:
   • address: int
   • mnemonic: str
   • operands: str
-  • raw_line: str
+  • raw_line: str (source line for listings parsed from text, "" otherwise)
 
 Function Object:
   • name: str